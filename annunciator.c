@@ -0,0 +1,314 @@
+#include "annunciator.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "ram_hot.h"
+
+// LEDs e buzzer em até duas slices de PWM, mais a sequência do divisor da
+// buzzer (frequência da sirene)
+#define ANNUN_MAX_SLICES 2
+#define ANNUN_MAX_STREAMS (ANNUN_MAX_SLICES + 1)
+#define ANNUN_PACER_TICKS_PER_MS 1000 // Marcador conta a 1 MHz
+
+// Uma sequência: canal de dados (tabela -> registrador, um passo por DREQ
+// do marcador) e canal de controle (reescreve o endereço de leitura do canal
+// de dados com 'start', reiniciando o ciclo).
+typedef struct {
+    uint data_ch;
+    uint ctrl_ch;
+    dma_channel_config data_cfg;
+    volatile uint32_t *dst;
+    const uint32_t *start; // Lido pelo canal de controle
+} annun_stream_t;
+
+// Padrão já convertido: 'total' passos por sequência, as sequências uma
+// depois da outra em 'buf'. 'pattern' só é escrito depois da conversão, então
+// uma interrupção nunca encontra uma tabela pela metade.
+typedef struct {
+    const annun_pattern_t *volatile pattern;
+    uint32_t *buf;
+    uint16_t total;
+    uint16_t step_ms;
+} annun_prepared_t;
+
+static annun_stream_t streams[ANNUN_MAX_STREAMS];
+static annun_prepared_t prepared[ANNUN_MAX_PATTERNS];
+static uint32_t prepared_count; // Entradas reservadas (algumas ainda em conversão)
+static uint32_t pool[ANNUN_POOL_STEPS * ANNUN_MAX_STREAMS];
+static uint32_t pool_used;
+static uint stream_count;      // Slices de saída + 1 (divisor da buzzer)
+static uint32_t dma_mask;      // Todos os canais (dados e controle)
+static uint8_t out_stream[ANNUN_OUT_COUNT];
+static uint8_t out_shift[ANNUN_OUT_COUNT]; // 0 = canal A, 16 = canal B do registrador CC
+static uint32_t buzzer_div;    // Divisor do tom fixo (formato 8.4)
+static uint32_t clk_hz;
+
+static const annun_prepared_t *volatile layers[ANNUN_LAYER_COUNT]; // Alterado também em interrupções
+static const annun_prepared_t *playing;
+static int playing_layer = -1;
+
+static uint32_t annun_gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Passo da sequência: maior divisor comum de todos os tempos do padrão,
+// reduzido até caber no marcador (e mais fino quando há varredura).
+static uint32_t annun_step_ms(const annun_pattern_t *p) {
+    uint32_t g = p->period_ms;
+    for (uint32_t o = 0; o < ANNUN_OUT_COUNT; o++) {
+        g = annun_gcd(g, p->out[o].on_ms);
+        g = annun_gcd(g, p->out[o].off_ms);
+        g = annun_gcd(g, p->out[o].phase_ms);
+    }
+    uint32_t max = p->sweep_hi_hz ? ANNUN_SWEEP_STEP_MS : ANNUN_MAX_STEP_MS;
+    uint32_t k = 1;
+    while (g / k > max || g % k) k++;
+    return g / k;
+}
+
+// Passos da sequência completa (0 se não cabe). Padrões finitos terminam com
+// um passo apagado.
+static uint32_t annun_step_count(const annun_pattern_t *p, uint32_t step_ms) {
+    uint32_t per_cycle = p->period_ms / step_ms;
+    uint32_t total = p->repeat ? per_cycle * p->repeat + 1 : per_cycle;
+    return total <= ANNUN_MAX_STEPS ? total : 0;
+}
+
+static uint32_t annun_wave_level(const annun_wave_t *w, uint32_t t) {
+    if (!w->on_ms) return 0;
+    if (!w->off_ms) return w->level;
+    uint32_t cycle = w->on_ms + w->off_ms;
+    uint32_t local = (t + cycle - w->phase_ms % cycle) % cycle;
+    return local < w->on_ms ? w->level : 0;
+}
+
+static uint32_t annun_div_for(uint32_t hz) {
+    uint32_t div = (uint32_t)(((uint64_t)clk_hz * 16) / ((uint64_t)hz * (ANNUN_LEVEL_MAX + 1)));
+    if (div < 16) div = 16;       // Divisor mínimo 1.0
+    if (div > 0xFFF) div = 0xFFF; // Máximo 255 + 15/16
+    return div;
+}
+
+// Frequência da sirene em t: sobe de lo a hi na primeira metade do ciclo e
+// volta na segunda
+static uint32_t annun_sweep_div(const annun_pattern_t *p, uint32_t t) {
+    uint32_t half = p->period_ms / 2;
+    uint32_t pos = t < half ? t : p->period_ms - t;
+    int32_t hz = p->sweep_lo_hz + ((int32_t)p->sweep_hi_hz - p->sweep_lo_hz) * (int32_t)pos / (int32_t)half;
+    return annun_div_for((uint32_t)hz);
+}
+
+// Gera os níveis de cada passo; a sequência s ocupa buf[s * total ...]
+static void annun_compile(const annun_pattern_t *p, uint32_t step_ms, uint32_t total, uint32_t *buf) {
+    uint32_t div_stream = stream_count - 1;
+    for (uint32_t i = 0; i < total; i++) {
+        uint32_t t = (i * step_ms) % p->period_ms;
+        bool last = p->repeat && i == total - 1;
+        for (uint32_t s = 0; s < div_stream; s++) buf[s * total + i] = 0;
+        if (!last) {
+            for (uint32_t o = 0; o < ANNUN_OUT_COUNT; o++)
+                buf[out_stream[o] * total + i] |= annun_wave_level(&p->out[o], t) << out_shift[o];
+        }
+        buf[div_stream * total + i] = (p->sweep_hi_hz && !last) ? annun_sweep_div(p, t) : buzzer_div;
+    }
+}
+
+static const annun_prepared_t *RAM_HOT_FUNC(annun_find)(const annun_pattern_t *p) {
+    for (uint32_t i = 0; i < prepared_count; i++)
+        if (prepared[i].pattern == p) return &prepared[i];
+    return NULL;
+}
+
+// Converte o padrão na primeira vez; depois só o encontra. A reserva de
+// espaço é feita com as interrupções mascaradas e a conversão fora delas.
+static const annun_prepared_t *annun_prepare_entry(const annun_pattern_t *p) {
+    const annun_prepared_t *found = annun_find(p);
+    if (found) return found;
+    if (!p->period_ms || (p->sweep_hi_hz && p->period_ms < 2)) return NULL;
+    uint32_t step_ms = annun_step_ms(p);
+    uint32_t total = annun_step_count(p, step_ms);
+    if (!total) return NULL;
+
+    uint32_t words = total * stream_count;
+    annun_prepared_t *e = NULL;
+    uint32_t irq = save_and_disable_interrupts();
+    if (prepared_count < ANNUN_MAX_PATTERNS && pool_used + words <= ANNUN_POOL_STEPS * ANNUN_MAX_STREAMS) {
+        e = &prepared[prepared_count++];
+        e->buf = &pool[pool_used];
+        pool_used += words;
+    }
+    restore_interrupts(irq);
+    if (!e) return NULL;
+
+    e->total = (uint16_t)total;
+    e->step_ms = (uint16_t)step_ms;
+    annun_compile(p, step_ms, total, e->buf);
+    irq = save_and_disable_interrupts();
+    e->pattern = p; // Publica a entrada
+    restore_interrupts(irq);
+    return e;
+}
+
+// Para todos os canais e apaga as saídas
+static void RAM_HOT_FUNC(annun_halt)(void) {
+    uint irq_ch = streams[0].data_ch;
+    dma_channel_set_irq1_enabled(irq_ch, false);
+    dma_hw->abort = dma_mask;
+    while (dma_hw->abort & dma_mask) tight_loop_contents();
+    dma_hw->ints1 = 1u << irq_ch; // O abort pode marcar uma interrupção espúria
+
+    for (uint32_t s = 0; s + 1 < stream_count; s++) *streams[s].dst = 0;
+    *streams[stream_count - 1].dst = buzzer_div;
+}
+
+// Só programa os canais: a tabela já foi gerada por annun_prepare_entry
+static void RAM_HOT_FUNC(annun_start)(const annun_prepared_t *e) {
+    const annun_pattern_t *p = e->pattern;
+    uint32_t total = e->total;
+    uint32_t start_mask = 0;
+    for (uint32_t s = 0; s < stream_count; s++) {
+        annun_stream_t *st = &streams[s];
+        st->start = &e->buf[s * total];
+        // Finito: sem encadeamento, a sequência acaba no passo apagado
+        channel_config_set_chain_to(&st->data_cfg, p->repeat ? st->data_ch : st->ctrl_ch);
+        dma_channel_set_config(st->data_ch, &st->data_cfg, false);
+        dma_channel_set_read_addr(st->data_ch, st->start, false);
+        dma_channel_set_trans_count(st->data_ch, total, false);
+        start_mask |= 1u << st->data_ch;
+    }
+    if (p->repeat) dma_channel_set_irq1_enabled(streams[0].data_ch, true);
+
+    uint32_t top = e->step_ms * ANNUN_PACER_TICKS_PER_MS - 1;
+    pwm_set_wrap(ANNUN_PACER_SLICE, top);
+    dma_start_channel_mask(start_mask);
+    pwm_set_counter(ANNUN_PACER_SLICE, top); // Primeiro passo já na próxima contagem
+}
+
+// Entrega as saídas à camada ativa de maior prioridade
+static void RAM_HOT_FUNC(annun_refresh)(void) {
+    int top = -1;
+    for (int l = ANNUN_LAYER_COUNT - 1; l >= 0; l--) {
+        if (layers[l]) {
+            top = l;
+            break;
+        }
+    }
+    const annun_prepared_t *p = top >= 0 ? layers[top] : NULL;
+    playing_layer = top;
+    if (p == playing) return;
+
+    annun_halt();
+    playing = p;
+    if (p) annun_start(p);
+}
+
+// Fim de um padrão finito: libera a camada
+static void RAM_HOT_FUNC(annun_dma_irq)(void) {
+    uint32_t bit = 1u << streams[0].data_ch;
+    if (!(dma_hw->ints1 & bit)) return;
+    dma_hw->ints1 = bit;
+    if (playing_layer >= 0) layers[playing_layer] = NULL;
+    annun_refresh();
+}
+
+static uint annun_stream_for_slice(uint slice) {
+    for (uint s = 0; s < stream_count; s++)
+        if (streams[s].dst == &pwm_hw->slice[slice].cc) return s;
+    hard_assert(stream_count < ANNUN_MAX_SLICES);
+    streams[stream_count].dst = &pwm_hw->slice[slice].cc;
+    return stream_count++;
+}
+
+void annun_init(const uint pins[ANNUN_OUT_COUNT], uint16_t buzzer_hz) {
+    clk_hz = clock_get_hz(clk_sys);
+    buzzer_div = annun_div_for(buzzer_hz);
+
+    stream_count = 0;
+    uint buzzer_slice = pwm_gpio_to_slice_num(pins[ANNUN_BUZZER]);
+    for (uint32_t o = 0; o < ANNUN_OUT_COUNT; o++) {
+        uint slice = pwm_gpio_to_slice_num(pins[o]);
+        hard_assert(slice != ANNUN_PACER_SLICE);
+        out_stream[o] = annun_stream_for_slice(slice);
+        out_shift[o] = pwm_gpio_to_channel(pins[o]) == PWM_CHAN_B ? 16 : 0;
+
+        gpio_set_function(pins[o], GPIO_FUNC_PWM);
+        pwm_set_wrap(slice, ANNUN_LEVEL_MAX);
+        pwm_set_chan_level(slice, pwm_gpio_to_channel(pins[o]), 0);
+        // LEDs numa slice própria rodam sem divisor; a slice da buzzer
+        // define o tom (o LED que a compartilha só usa o ciclo de trabalho)
+        if (slice == buzzer_slice)
+            pwm_hw->slice[slice].div = buzzer_div;
+        else
+            pwm_set_clkdiv_int_frac(slice, 1, 0);
+        pwm_set_enabled(slice, true);
+    }
+    streams[stream_count++].dst = &pwm_hw->slice[buzzer_slice].div;
+
+    // Marcador: slice sem pinos contando a 1 MHz; cada volta libera um passo
+    pwm_set_clkdiv(ANNUN_PACER_SLICE, (float)clk_hz / (ANNUN_PACER_TICKS_PER_MS * 1000));
+    pwm_set_wrap(ANNUN_PACER_SLICE, ANNUN_MAX_STEP_MS * ANNUN_PACER_TICKS_PER_MS - 1);
+    pwm_set_enabled(ANNUN_PACER_SLICE, true);
+
+    dma_mask = 0;
+    for (uint32_t s = 0; s < stream_count; s++) {
+        annun_stream_t *st = &streams[s];
+        st->data_ch = dma_claim_unused_channel(true);
+        st->ctrl_ch = dma_claim_unused_channel(true);
+        st->start = pool;
+
+        st->data_cfg = dma_channel_get_default_config(st->data_ch);
+        channel_config_set_transfer_data_size(&st->data_cfg, DMA_SIZE_32);
+        channel_config_set_read_increment(&st->data_cfg, true);
+        channel_config_set_write_increment(&st->data_cfg, false);
+        channel_config_set_dreq(&st->data_cfg, pwm_get_dreq(ANNUN_PACER_SLICE));
+        channel_config_set_chain_to(&st->data_cfg, st->ctrl_ch);
+        dma_channel_configure(st->data_ch, &st->data_cfg, st->dst, st->start, 0, false);
+
+        dma_channel_config cc = dma_channel_get_default_config(st->ctrl_ch);
+        channel_config_set_transfer_data_size(&cc, DMA_SIZE_32);
+        channel_config_set_read_increment(&cc, false);
+        channel_config_set_write_increment(&cc, false);
+        dma_channel_configure(st->ctrl_ch, &cc, &dma_hw->ch[st->data_ch].al3_read_addr_trig, &st->start, 1,
+                              false);
+
+        dma_mask |= (1u << st->data_ch) | (1u << st->ctrl_ch);
+    }
+
+    irq_add_shared_handler(DMA_IRQ_1, annun_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+bool annun_prepare(const annun_pattern_t *pattern) {
+    return annun_prepare_entry(pattern) != NULL;
+}
+
+bool annun_play(annun_layer_t layer, const annun_pattern_t *pattern) {
+    const annun_prepared_t *e = annun_prepare_entry(pattern);
+    if (!e) return false;
+
+    uint32_t irq = save_and_disable_interrupts();
+    layers[layer] = e;
+    annun_refresh();
+    restore_interrupts(irq);
+    return true;
+}
+
+void annun_stop(annun_layer_t layer) {
+    uint32_t irq = save_and_disable_interrupts();
+    layers[layer] = NULL;
+    annun_refresh();
+    restore_interrupts(irq);
+}
+
+bool annun_active(annun_layer_t layer) {
+    return layers[layer] != NULL;
+}
@@ -0,0 +1,150 @@
+#include "bus.h"
+#include "hardware/sync.h"
+#include <stddef.h>
+
+// Cabeçalho de cada posição do buffer, seguido dos dados da amostra
+typedef struct {
+    volatile uint32_t seq; // Número de ordem, ou BUS_SEQ_BUSY durante a escrita
+    uint32_t reserved;
+    uint64_t t_us;
+} bus_hdr_t;
+
+#define BUS_SEQ_BUSY 0xFFFFFFFFu
+
+#define BUS_SLOTS(name, type, depth)                                                      \
+    _Static_assert(((depth) & ((depth) - 1)) == 0, #name ": profundidade deve ser potência de 2"); \
+    static struct {                                                                       \
+        bus_hdr_t hdr;                                                                    \
+        type data;                                                                        \
+    } bus_slots_##name[depth];
+
+BUS_TOPICS(BUS_SLOTS)
+
+typedef struct {
+    uint8_t *slots;
+    uint16_t stride;
+    uint16_t mask;
+    const char *name;
+} bus_desc_t;
+
+#define BUS_DESC(name, type, depth) \
+    {(uint8_t *)bus_slots_##name, sizeof(bus_slots_##name[0]), (depth) - 1, #name},
+
+static const bus_desc_t bus_desc[BUS_TOPIC_COUNT] = {
+    BUS_TOPICS(BUS_DESC)
+};
+
+typedef struct {
+    volatile uint32_t head; // Número de ordem da próxima publicação
+    uint64_t window_t;      // Início da janela da taxa
+    uint32_t window_n;      // Publicações na janela
+    uint32_t rate_mhz;
+    bus_sub_t *subs;
+} bus_state_t;
+
+static bus_state_t bus_state[BUS_TOPIC_COUNT];
+
+static inline bus_hdr_t *bus_slot(const bus_desc_t *d, uint32_t seq) {
+    return (bus_hdr_t *)(d->slots + (seq & d->mask) * d->stride);
+}
+
+void *bus_claim(bus_topic_t topic) {
+    bus_hdr_t *h = bus_slot(&bus_desc[topic], bus_state[topic].head);
+    h->seq = BUS_SEQ_BUSY;
+    __dmb(); // Marca antes de sobrescrever os dados
+    return h + 1;
+}
+
+void bus_publish(bus_topic_t topic, uint64_t t_us) {
+    bus_state_t *s = &bus_state[topic];
+    uint32_t seq = s->head;
+    bus_hdr_t *h = bus_slot(&bus_desc[topic], seq);
+    h->t_us = t_us;
+    __dmb(); // Dados completos antes do número de ordem
+    h->seq = seq;
+    __dmb();
+    s->head = seq + 1;
+
+    s->window_n++;
+    uint64_t dt = t_us - s->window_t;
+    if (dt >= BUS_RATE_WINDOW_US) {
+        s->rate_mhz = (uint32_t)((uint64_t)s->window_n * 1000000000u / dt);
+        s->window_t = t_us;
+        s->window_n = 0;
+    }
+}
+
+void bus_subscribe(bus_sub_t *sub, bus_topic_t topic) {
+    uint32_t irq = save_and_disable_interrupts();
+    sub->topic = topic;
+    sub->next = bus_state[topic].head;
+    sub->read = 0;
+    sub->lost = 0;
+    sub->link = bus_state[topic].subs;
+    bus_state[topic].subs = sub;
+    restore_interrupts(irq);
+}
+
+const void *bus_peek(bus_sub_t *sub, uint64_t *t_us) {
+    const bus_desc_t *d = &bus_desc[sub->topic];
+    uint32_t depth = (uint32_t)d->mask + 1;
+    for (;;) {
+        uint32_t head = bus_state[sub->topic].head;
+        __dmb();
+        if (sub->next == head) return NULL;
+        if (head - sub->next > depth) {
+            // O produtor deu a volta: só as 'depth' mais recentes existem
+            sub->lost += head - sub->next - depth;
+            sub->next = head - depth;
+        }
+        const bus_hdr_t *h = bus_slot(d, sub->next);
+        if (h->seq == sub->next) {
+            __dmb();
+            if (t_us) *t_us = h->t_us;
+            return h + 1;
+        }
+        // Sendo sobrescrita agora: segue para a próxima
+        sub->lost++;
+        sub->next++;
+    }
+}
+
+bool bus_release(bus_sub_t *sub) {
+    const bus_hdr_t *h = bus_slot(&bus_desc[sub->topic], sub->next);
+    __dmb(); // Leituras dos dados antes da conferência
+    bool ok = h->seq == sub->next;
+    sub->next++;
+    if (ok)
+        sub->read++;
+    else
+        sub->lost++;
+    return ok;
+}
+
+const void *bus_latest(bus_sub_t *sub, uint64_t *t_us) {
+    uint32_t head = bus_state[sub->topic].head;
+    if (head == 0) return NULL;
+    sub->next = head - 1;
+    return bus_peek(sub, t_us);
+}
+
+void bus_get_stats(bus_topic_t topic, bus_stats_t *stats) {
+    const bus_state_t *s = &bus_state[topic];
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t head = s->head;
+    stats->published = head;
+    stats->rate_mhz = s->rate_mhz;
+    stats->subscribers = 0;
+    stats->lost = 0;
+    stats->max_lag = 0;
+    for (const bus_sub_t *sub = s->subs; sub; sub = sub->link) {
+        stats->subscribers++;
+        stats->lost += sub->lost;
+        if (head - sub->next > stats->max_lag) stats->max_lag = head - sub->next;
+    }
+    restore_interrupts(irq);
+}
+
+const char *bus_topic_name(bus_topic_t topic) {
+    return topic < BUS_TOPIC_COUNT ? bus_desc[topic].name : "?";
+}
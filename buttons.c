@@ -0,0 +1,173 @@
+#include "buttons.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "button_debounce.pio.h"
+#include "prof.h"
+#include "ram_hot.h"
+
+#define BUTTONS_PIO pio0
+#define BUTTONS_PIO_IRQ PIO0_IRQ_0
+
+typedef struct {
+    uint8_t gpio;
+    uint8_t sm;
+    volatile bool pressed;
+    bool long_fired;    // Pressão longa já informada: a soltura não gera clique
+    volatile uint8_t count; // Pressões do gesto em andamento
+    uint32_t t_first;   // Primeira pressão do gesto
+    uint32_t t_release; // Última soltura do gesto
+    uint32_t t_zero;    // time_us_32 em que o X da máquina valia 0
+    bool armed;         // Há um prazo pendente (longa ou fim do clique múltiplo)
+    uint32_t deadline;  // Prazo, contado da borda (time_us_32)
+    alarm_id_t alarm;   // Alarme do prazo
+} button_state_t;
+
+static button_state_t buttons[BUTTONS_MAX];
+static uint button_count;
+static buttons_config_t cfg;
+static button_callback_t on_event;
+
+static void RAM_HOT_FUNC(buttons_emit)(button_state_t *b, uint8_t gesture, uint32_t end) {
+    button_event_t ev = {
+        .gpio = b->gpio,
+        .gesture = gesture,
+        .t_us = b->t_first,
+        .duration_us = end - b->t_first,
+    };
+    b->count = 0;
+    if (on_event) on_event(&ev);
+}
+
+static void RAM_HOT_FUNC(buttons_cancel)(button_state_t *b) {
+    if (b->alarm > 0) cancel_alarm(b->alarm);
+    b->alarm = 0;
+    b->armed = false;
+}
+
+// Prazo vencido: ainda pressionado => pressão longa; solto => fim do gesto.
+// As durações terminam no prazo ou na soltura, não em quando isto roda.
+static void RAM_HOT_FUNC(buttons_expire)(button_state_t *b) {
+    b->armed = false;
+    if (b->pressed) {
+        if (!b->long_fired) {
+            b->long_fired = true;
+            buttons_emit(b, BUTTON_LONG, b->deadline);
+        }
+    } else if (b->count) {
+        buttons_emit(b, b->count, b->t_release);
+    }
+}
+
+static int64_t RAM_HOT_FUNC(buttons_timeout)(alarm_id_t id, void *user_data) {
+    button_state_t *b = user_data;
+    // Sem conferir o id: com fire_if_past o SDK pode chamar isto antes de
+    // add_alarm_in_us retornar. Um alarme já cancelado vê outro prazo.
+    (void)id;
+    if (!b->armed || (int32_t)(time_us_32() - b->deadline) < 0) return 0;
+    b->alarm = 0;
+    buttons_expire(b);
+    return 0;
+}
+
+static void RAM_HOT_FUNC(buttons_arm)(button_state_t *b, uint32_t deadline) {
+    b->deadline = deadline;
+    b->armed = true;
+}
+
+// Uma borda confirmada, no instante 'at' em que o pino mudou
+static void RAM_HOT_FUNC(buttons_edge)(button_state_t *b, bool pressed, uint32_t at) {
+    // Com a interrupção atrasada, um prazo pode ter vencido antes desta
+    // borda: o gesto anterior sai primeiro, como teria saído no prazo
+    if (b->armed && (int32_t)(at - b->deadline) >= 0) buttons_expire(b);
+    buttons_cancel(b);
+    b->pressed = pressed;
+    if (pressed) {
+        if (b->count == 0) b->t_first = at;
+        b->count++;
+        buttons_arm(b, at + cfg.long_ms * 1000u);
+        button_event_t ev = {.gpio = b->gpio, .gesture = BUTTON_PRESS, .t_us = at};
+        if (on_event) on_event(&ev);
+        return;
+    }
+
+    b->t_release = at;
+    if (b->long_fired) {
+        b->long_fired = false;
+        b->count = 0;
+    } else if (b->count >= BUTTON_TRIPLE) {
+        buttons_emit(b, BUTTON_TRIPLE, at); // Gesto máximo: não há o que esperar
+    } else {
+        buttons_arm(b, at + cfg.multi_gap_ms * 1000u);
+    }
+}
+
+// Instante da borda a partir da palavra da FIFO (button_debounce.pio): os
+// 31 bits de X dão o instante da confirmação módulo 2^31 us, resolvido como
+// o mais recente até 'now'; a borda veio uma janela antes.
+static uint32_t RAM_HOT_FUNC(buttons_edge_time)(const button_state_t *b, uint32_t word, uint32_t now) {
+    uint32_t confirmed = b->t_zero - (word >> 1);
+    confirmed = now - ((now - confirmed) & 0x7FFFFFFFu);
+    return confirmed - cfg.debounce_us;
+}
+
+static void RAM_HOT_FUNC(buttons_irq)(void) {
+    PROF_SCOPE(PROF_BUTTONS_IRQ);
+    uint32_t now = time_us_32();
+    for (uint i = 0; i < button_count; i++) {
+        button_state_t *b = &buttons[i];
+        if (pio_sm_is_rx_fifo_empty(BUTTONS_PIO, b->sm)) continue;
+        do {
+            uint32_t word = pio_sm_get(BUTTONS_PIO, b->sm);
+            buttons_edge(b, (word & 1u) == 0, buttons_edge_time(b, word, now));
+        } while (!pio_sm_is_rx_fifo_empty(BUTTONS_PIO, b->sm));
+        // O alarme só depois de todas as bordas na FIFO: um prazo já vencido
+        // dispara logo, e não antes de uma borda que chegou a tempo
+        if (b->armed) {
+            int32_t left = (int32_t)(b->deadline - now);
+            b->alarm = add_alarm_in_us(left > 0 ? (uint64_t)left : 0, buttons_timeout, b, true);
+        }
+    }
+}
+
+void buttons_init(const uint *pins, uint count, const buttons_config_t *config, button_callback_t callback) {
+    hard_assert(count <= BUTTONS_MAX);
+    cfg = *config;
+    on_event = callback;
+    button_count = count;
+
+    uint offset = pio_add_program(BUTTONS_PIO, &button_debounce_program);
+    // Divisor inteiro com clk_sys múltiplo de 5 MHz (125 MHz): o X da máquina
+    // anda junto com o timer, sem deriva entre os dois relógios
+    float div = (float)clock_get_hz(clk_sys) / (BUTTON_DEBOUNCE_CYCLES_PER_US * 1000000.0f);
+
+    for (uint i = 0; i < count; i++) {
+        button_state_t *b = &buttons[i];
+        b->gpio = pins[i];
+        b->sm = pio_claim_unused_sm(BUTTONS_PIO, true);
+
+        gpio_init(pins[i]);
+        gpio_set_dir(pins[i], GPIO_IN);
+        gpio_pull_up(pins[i]);
+        b->t_zero = button_debounce_program_init(BUTTONS_PIO, b->sm, offset, pins[i], div, cfg.debounce_us);
+        pio_set_irq0_source_enabled(BUTTONS_PIO, (enum pio_interrupt_source)(pis_sm0_rx_fifo_not_empty + b->sm),
+                                    true);
+    }
+
+    irq_add_shared_handler(BUTTONS_PIO_IRQ, buttons_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(BUTTONS_PIO_IRQ, true);
+}
+
+bool buttons_is_pressed(uint gpio) {
+    for (uint i = 0; i < button_count; i++)
+        if (buttons[i].gpio == gpio) return buttons[i].pressed;
+    return false;
+}
+
+bool buttons_gesture_pending(uint gpio) {
+    for (uint i = 0; i < button_count; i++)
+        if (buttons[i].gpio == gpio) return buttons[i].count != 0;
+    return false;
+}
@@ -0,0 +1,113 @@
+#include "emergency.h"
+#include "lora.h"
+#include "prof.h"
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/sync.h"
+#include "ram_hot.h"
+#include <string.h>
+
+#define EMERGENCY_PREFIX "EMERGENCIA "
+#define EMERGENCY_PREFIX_LEN (sizeof(EMERGENCY_PREFIX) - 1)
+
+static const uint32_t retry_ms[] = EMERGENCY_RETRY_MS;
+#define EMERGENCY_RETRIES (sizeof(retry_ms) / sizeof(retry_ms[0]))
+
+static uart_inst_t *radio;
+
+// Posição em dois buffers: o laço escreve no que não está publicado e troca
+// o índice; a interrupção só lê o publicado.
+static char fix[2][EMERGENCY_FIX_MAX + 1];
+static volatile uint8_t fix_pub = 0;
+
+static volatile bool active = false;
+static volatile bool report_pending = false;
+static uint32_t attempt;
+static volatile alarm_id_t retry_alarm = -1;
+static emergency_stats_t stats;
+
+void emergency_init(uart_inst_t *uart) {
+    radio = uart;
+}
+
+void emergency_set_fix(const char *text) {
+    uint8_t next = fix_pub ^ 1;
+    size_t n = strlen(text);
+    if (n > EMERGENCY_FIX_MAX) n = EMERGENCY_FIX_MAX;
+    // Sem o '\n' final da sentença: o quadro termina com o seu próprio
+    while (n && (text[n - 1] == '\n' || text[n - 1] == '\r')) n--;
+    memcpy(fix[next], text, n);
+    fix[next][n] = '\0';
+    fix_pub = next;
+}
+
+// Monta e envia o quadro da tentativa atual. Retorna o instante do primeiro byte.
+static uint32_t RAM_HOT_FUNC(emergency_send)(void) {
+    char frame[EMERGENCY_PREFIX_LEN + 3 + EMERGENCY_FIX_MAX + 1];
+    uint32_t n = EMERGENCY_PREFIX_LEN;
+    memcpy(frame, EMERGENCY_PREFIX, n);
+    frame[n++] = (char)('1' + attempt);
+    frame[n++] = ':';
+    frame[n++] = ' ';
+    const char *f = fix[fix_pub];
+    while (*f) frame[n++] = *f++;
+    frame[n++] = '\n';
+    stats.frames++;
+    return lora_send_urgent(radio, frame, n);
+}
+
+static int64_t RAM_HOT_FUNC(emergency_retry)(alarm_id_t id, void *user_data) {
+    (void)id; (void)user_data;
+    if (active) {
+        attempt++;
+        emergency_send();
+    }
+    if (!active || attempt >= EMERGENCY_RETRIES) {
+        retry_alarm = -1; // O id volta a ficar livre para outros alarmes
+        return 0;
+    }
+    // Positivo: relativo ao disparo anterior, sem acumular atraso
+    return (int64_t)(retry_ms[attempt] - retry_ms[attempt - 1]) * 1000;
+}
+
+void RAM_HOT_FUNC(emergency_trigger)(uint32_t press_us) {
+    uint32_t t0 = time_us_32();
+    uint32_t irq = save_and_disable_interrupts();
+    if (retry_alarm >= 0) cancel_alarm(retry_alarm);
+    active = true;
+    attempt = 0;
+    uint32_t t_first = emergency_send();
+    restore_interrupts(irq);
+
+    stats.triggers++;
+    stats.last_us = t_first - t0;
+    stats.press_us = t_first - press_us;
+    // O orçamento vale da pressão do botão: inclui o que veio antes do gatilho
+    if (stats.press_us > stats.max_us) stats.max_us = stats.press_us;
+    if (stats.press_us > EMERGENCY_BUDGET_US) stats.over_budget++;
+    PROF_RECORD_SINCE(PROF_EVENT_TO_ALARM, press_us);
+    report_pending = true;
+
+    retry_alarm = add_alarm_in_ms(retry_ms[0], emergency_retry, NULL, true);
+}
+
+void emergency_cancel(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    active = false;
+    if (retry_alarm >= 0) cancel_alarm(retry_alarm);
+    retry_alarm = -1;
+    restore_interrupts(irq);
+}
+
+bool emergency_is_active(void) {
+    return active;
+}
+
+bool emergency_poll_report(emergency_stats_t *out) {
+    if (!report_pending) return false;
+    uint32_t irq = save_and_disable_interrupts();
+    report_pending = false;
+    *out = stats;
+    restore_interrupts(irq);
+    return true;
+}
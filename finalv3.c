@@ -4,10 +4,30 @@
 #include "hardware/pwm.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
 #include "pico/time.h"
 #include "ssd1306.h"
-#include "fonte.h"
+#include "prof.h"
+#include "tlog.h"
+#include "track.h"
+#include "track_simplify.h"
+#include "geofence.h"
+#include "annunciator.h"
+#include "buttons.h"
+#include "heatmap.h"
+#include "fingerprint.h"
+#include "trace.h"
+#include "trace_flash.h"
+#include "lora.h"
+#include "emergency.h"
+#include "retain.h"
+#include "crc.h"
+#include "mirror.h"
+#include "bus.h"
+#include "ram_hot.h"
 #include <stdlib.h>
+#include <string.h>
 
 // Declaração da função de borda do display OLED (caso não esteja definida em ssd1306.h)
 void ssd1306_draw_border(ssd1306_t *dev, int thickness);
@@ -20,12 +40,17 @@ void ssd1306_draw_border(ssd1306_t *dev, int thickness);
 #define LED_VERMELHO 13   // LED vermelho: alerta vermelho após 45 s de inatividade
 #define JOYSTICK_X_ADC 1  // Canal ADC para o eixo X do joystick
 #define JOYSTICK_Y_ADC 0  // Canal ADC para o eixo Y do joystick
-#define BUTTON_A 5        // Botão A: reseta alertas e contadores
-#define BUTTON_B 6        // Botão B: ativa/desativa a emergência
+#define BUTTON_A 5        // Botão A: reseta alertas e contadores (pressão longa: minimapa)
+#define BUTTON_B 6        // Botão B: clique duplo ativa, triplo desativa a emergência
 #define I2C_SDA_PIN 14    // Pino SDA para comunicação I2C com o display
 #define I2C_SCL_PIN 15    // Pino SCL para comunicação I2C com o display
 #define SSD1306_ADDR 0x3C // Endereço I2C do display OLED
 #define BUZZER1_PIN 10    // Buzzer conectada no pino 10
+#define BUZZER_HZ 2500    // Tom da buzzer
+#define RADIO_UART uart0  // Rádio de emergência (mesmo formato do LoRa do projetoreal)
+#define RADIO_TX_PIN 0
+#define RADIO_RX_PIN 1
+#define RADIO_BAUD 9600
 
 // =====================
 // Parâmetros do Sistema
@@ -35,14 +60,50 @@ void ssd1306_draw_border(ssd1306_t *dev, int thickness);
 #define TIME_RED_ALERT 45 // Após 45 s de inatividade, ativa alerta vermelho (display + LED vermelho)
 #define TIME_BUZZER 60    // Após 60 s de inatividade, a buzzer toca intermitente
 #define TEXT_OFFSET 4     // Margem para posicionar o texto dentro do display
+#define MAP_X 32          // Minimapa de 64x64 pixels centralizado no display
+#define FP_MIN_CONFIDENCE 40 // Confiança mínima para a posição por RSSI substituir o joystick
+#define I2C_HZ (400 * 1000) // Fast mode: um quadro completo em ~25 ms
+#define WATCHDOG_MS 5000    // Maior que a volta mais longa do laço (2 s + gravação na flash)
+#define STATS_MS 60000      // Intervalo do registro das estatísticas (barramento e trajeto)
+#define TRACK_TOLERANCE 48  // Erro máximo do trajeto simplificado (unidades do joystick)
+#define TRACK_WINDOW 30     // Amostras descartáveis seguidas (1 min com o laço de 2 s)
 
 // =====================
-// Função Inline para PWM
+// Padrões de alerta (tocados por DMA, ver annunciator.h)
 // =====================
-static inline bool my_pwm_get_enabled(uint slice)
-{
-    return (pwm_hw->slice[slice].csr & (1u << 0)) != 0;
-}
+#define BEEP {500, 500, 0, 900}
+#define BLINK {500, 500, 0, ANNUN_LEVEL_MAX}
+
+// Zona restrita: LEDs verde e vermelho e buzzer intermitentes
+static const annun_pattern_t PATTERN_ZONE = {
+    .out = {[ANNUN_BUZZER] = BEEP, [ANNUN_LED_GREEN] = BLINK, [ANNUN_LED_RED] = BLINK},
+    .period_ms = 1000,
+};
+// Inatividade: LED azul pisca 10 vezes
+static const annun_pattern_t PATTERN_IDLE_BLUE = {
+    .out = {[ANNUN_LED_BLUE] = BLINK},
+    .period_ms = 1000,
+    .repeat = 10,
+};
+// Alerta vermelho: LED vermelho piscando
+static const annun_pattern_t PATTERN_RED_ALERT = {
+    .out = {[ANNUN_LED_RED] = BLINK},
+    .period_ms = 1000,
+};
+// Alerta vermelho com a buzzer intermitente
+static const annun_pattern_t PATTERN_RED_BUZZER = {
+    .out = {[ANNUN_BUZZER] = BEEP, [ANNUN_LED_RED] = BLINK},
+    .period_ms = 1000,
+};
+// Emergência: sirene de 1 a 3 kHz e LEDs vermelho/azul alternados
+static const annun_pattern_t PATTERN_EMERGENCY = {
+    .out = {[ANNUN_BUZZER] = {1000, 0, 0, 500},
+            [ANNUN_LED_BLUE] = {250, 250, 250, ANNUN_LEVEL_MAX},
+            [ANNUN_LED_RED] = {250, 250, 0, ANNUN_LEVEL_MAX}},
+    .period_ms = 1000,
+    .sweep_lo_hz = 1000,
+    .sweep_hi_hz = 3000,
+};
 
 // =====================
 // Variáveis Globais
@@ -51,91 +112,403 @@ volatile absolute_time_t last_move_time;        // Tempo do último movimento do
 volatile uint16_t last_x = 2048, last_y = 2048; // Valores anteriores do joystick
 volatile int stationary_count = 0;              // Contador de inatividade
 volatile bool red_alert_active = false;         // Indica se o alerta vermelho está ativo
-volatile bool buzzer_active = false;            // Indica se a buzzer está ativa
 
 ssd1306_t display;    // Estrutura para o display OLED
-uint slice_buzzer1;   // Slice do PWM para a buzzer
-bool beep_on = false; // Variável para alternar o estado do beep
+track_t track;        // Histórico de posições gravado na flash
+track_simplify_t track_simp; // Só os pontos necessários chegam ao histórico
+geofence_t fence;     // Zonas restritas (zonas.json)
+heatmap_t heat;       // Tempo de permanência por região do joystick
+heatmap_view_t heat_view;
+volatile bool map_view = false; // Display mostrando o minimapa
+#if FP_ENABLED
+fp_source_t fp_source;    // Varreduras Wi-Fi (fingerprint_cyw43.c)
+fp_estimate_t fp_pos;     // Última posição estimada por RSSI
+bool fp_pos_valid = false;
+#endif
 
 // Variáveis para a função emergência
-volatile int buttonB_count = 0;
 volatile bool emergency_active = false;
-absolute_time_t last_buttonB_time;
+volatile bool emergency_reported = false; // Trajeto já gravado para esta ativação
+uint8_t button_b_presses = 0;             // Pressões do gesto em andamento no Botão B
+bool button_b_triggered = false;          // A emergência foi ativada por esse gesto
+
+
+// Consumidores das posições publicadas no barramento (bus.h)
+bus_sub_t sub_log;       // Zonas, trajeto e mapa: todas as amostras
+bus_sub_t sub_loop;      // Alertas, display e emergência: a mais recente
+uint32_t last_sample_ms; // Instante da última amostra no mapa de permanência
+
+#if TRACE_ENABLED && TRACE_FLASH
+trace_flash_t trace_flash; // Entradas gravadas na flash em vez da USB (trace_flash.h)
+trace_sink_t trace_sink;
+#endif
+
+#if TRACE_REPLAY
+// Reprodução de uma gravação (trace_replay_data.c) no lugar do joystick
+trace_reader_t replay;
+bool replay_active = true;
+bool replay_started = false;
+uint16_t replay_x = 2048, replay_y = 2048;
+uint64_t replay_t_us;          // Instante gravado do último evento (estendido a 64 bits)
+uint32_t replay_last_t;        // Instante de 32 bits do último evento, como gravado
+int64_t replay_clock_offset;   // Depois da gravação: o relógio continua de onde ela parou
+#endif
+
+// =====================
+// Função: loop_time_us
+// =====================
+// Relógio da lógica do laço (barramento, trajeto, mapa de permanência): na
+// reprodução, o instante gravado da amostra em uso, para que os
+// consumidores recebam os mesmos instantes da gravação
+uint64_t loop_time_us(void)
+{
+#if TRACE_REPLAY
+    if (replay_active)
+        return replay_t_us;
+    return time_us_64() + replay_clock_offset;
+#else
+    return time_us_64();
+#endif
+}
 
 // =====================
 // Função: read_joystick
 // =====================
-void read_joystick(uint16_t *x, uint16_t *y)
+void RAM_HOT_FUNC(read_joystick)(uint16_t *x, uint16_t *y)
+{
+    PROF_SCOPE(PROF_READ_JOYSTICK);
+#if TRACE_REPLAY
+    if (replay_active)
+    {
+        *x = replay_x;
+        *y = replay_y;
+    }
+    else
+#endif
+    {
+        adc_select_input(JOYSTICK_X_ADC);
+        *x = adc_read();
+        adc_select_input(JOYSTICK_Y_ADC);
+        *y = adc_read();
+    }
+    TRACE_SAMPLE(TRACE_CH_JOYSTICK, *x, *y, 0);
+}
+
+// =====================
+// Função: sample_position
+// =====================
+// Produtor do tópico BUS_POSITION: o joystick, ou a posição por RSSI quando
+// há uma estimativa confiável
+void sample_position(void)
+{
+    uint16_t x, y;
+    read_joystick(&x, &y);
+    uint8_t source = BUS_SRC_JOYSTICK;
+#if FP_ENABLED
+    fp_estimate_t est;
+#if TRACE_REPLAY
+    if (!replay_active && fp_update(&fp_source, &fingerprint_db, &est)) // Varreduras não são gravadas
+#else
+    if (fp_update(&fp_source, &fingerprint_db, &est))
+#endif
+    {
+        fp_pos_valid = est.confidence >= FP_MIN_CONFIDENCE;
+        if (fp_pos_valid)
+        {
+            fp_pos = est;
+            TLOG(TLOG_FP_POS, est.x, est.y, est.confidence);
+        }
+    }
+    if (fp_pos_valid)
+    {
+        x = (uint16_t)(fp_pos.x < 0 ? 0 : fp_pos.x > 4095 ? 4095 : fp_pos.x);
+        y = (uint16_t)(fp_pos.y < 0 ? 0 : fp_pos.y > 4095 ? 4095 : fp_pos.y);
+        source = BUS_SRC_RSSI;
+    }
+#endif
+    bus_position_t *p = bus_claim(BUS_POSITION);
+    p->x = x;
+    p->y = y;
+    p->source = source;
+    bus_publish(BUS_POSITION, loop_time_us());
+}
+
+// =====================
+// Função: latest_position
+// =====================
+// Cópia da posição mais recente para um consumidor que só quer o estado atual
+bool latest_position(bus_sub_t *sub, uint16_t *x, uint16_t *y)
+{
+    const bus_position_t *p = bus_latest(sub, NULL);
+    if (!p)
+        return false;
+    uint16_t px = p->x, py = p->y;
+    if (!bus_release(sub))
+        return false; // Sobrescrita durante a cópia
+    *x = px;
+    *y = py;
+    return true;
+}
+
+// =====================
+// Função: update_geofence
+// =====================
+// Avalia a posição contra as zonas e registra as entradas/saídas
+void update_geofence(uint16_t x, uint16_t y)
+{
+    geofence_event_t events[GEOFENCE_MAX_EVENTS];
+    uint32_t n = geofence_update(&fence, x, y, events);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (events[i].type == GEOFENCE_ENTER)
+            TLOG(TLOG_ZONE_ENTER, events[i].zone, events[i].action);
+        else
+            TLOG(TLOG_ZONE_EXIT, events[i].zone, events[i].action);
+    }
+}
+
+// =====================
+// Função: track_flags
+// =====================
+// Estado dos alertas gravado junto com cada posição do trajeto
+uint8_t track_flags(void)
+{
+    uint8_t flags = 0;
+    if (geofence_action(&fence) >= GEOFENCE_ACTION_ALERT)
+        flags |= TRACK_FLAG_OUT_OF_RANGE;
+    if (red_alert_active)
+        flags |= TRACK_FLAG_RED_ALERT;
+    if (emergency_active)
+        flags |= TRACK_FLAG_EMERGENCY;
+    return flags;
+}
+
+// =====================
+// Função: log_positions
+// =====================
+// Consome todas as posições publicadas desde a última volta: zonas, trajeto
+// e mapa de permanência usam o instante de cada amostra
+void log_positions(void)
+{
+    const bus_position_t *p;
+    uint64_t t_us;
+    while ((p = bus_peek(&sub_log, &t_us)))
+    {
+        bus_position_t pos = *p;
+        if (!bus_release(&sub_log))
+            continue; // Sobrescrita durante a cópia
+        uint32_t t_ms = (uint32_t)(t_us / 1000);
+        update_geofence(pos.x, pos.y);
+        track_record_t kept[TRACK_SIMPLIFY_MAX_OUT];
+        uint32_t n = track_simplify_push(&track_simp, t_ms, pos.x, pos.y, track_flags(), kept);
+        for (uint32_t i = 0; i < n; i++)
+            track_append(&track, kept[i].t_ms, kept[i].x, kept[i].y, kept[i].flags);
+        heatmap_dwell(&heat, pos.x, pos.y, t_ms - last_sample_ms);
+        last_sample_ms = t_ms;
+    }
+}
+
+// =====================
+// Função: log_stats
+// =====================
+// Taxa de publicação e amostras perdidas por consumidores lentos, por tópico,
+// e a compressão do trajeto
+void log_stats(void)
+{
+    for (int t = 0; t < BUS_TOPIC_COUNT; t++)
+    {
+        bus_stats_t st;
+        bus_get_stats((bus_topic_t)t, &st);
+        if (st.published)
+            TLOG(TLOG_BUS_STATS, t, st.published, st.rate_mhz, st.lost);
+    }
+    TLOG(TLOG_TRACK_SIMPLIFY, track_simp.points_in, track_simp.points_out, track_simplify_ratio_x100(&track_simp));
+#if MIRROR_ENABLED
+    mirror_stats_t ms;
+    mirror_get_stats(&ms);
+    if (ms.frames)
+        TLOG(TLOG_MIRROR_STATS, ms.frames, ms.keys, ms.bytes);
+#endif
+}
+
+// =====================
+// Função: save_state
+// =====================
+// Grava o estado preservado entre reinicializações. O laço informa a posição
+// atual; os botões passam fix = NULL e mantêm a última posição gravada. O
+// registro é montado fora da máscara e só é gravado se mudou; se um botão
+// gravou no meio, é montado de novo sobre o que o botão gravou (retain.h).
+void save_state(const char *fix, uint16_t x, uint16_t y)
+{
+    retain_state_t prev, st;
+    uint32_t gen;
+    do
+    {
+        gen = retain_snapshot(&prev);
+        st = prev;
+        if (fix)
+        {
+            st.x = x;
+            st.y = y;
+            strncpy(st.fix, fix, sizeof(st.fix) - 1); // Completa com zeros: memcmp abaixo
+            st.fix[sizeof(st.fix) - 1] = '\0';
+            st.flags |= RETAIN_FLAG_FIX_VALID;
+        }
+        st.alert_level = red_alert_active ? 1 : 0;
+        st.idle = stationary_count;
+        if (emergency_active)
+            st.flags |= RETAIN_FLAG_EMERGENCY;
+        else
+            st.flags &= ~RETAIN_FLAG_EMERGENCY;
+        if (memcmp(&st, &prev, sizeof(st)) == 0)
+            return; // Nada mudou desde a última gravação
+    } while (!retain_save(&st, gen));
+}
+
+// =====================
+// Função: restore_state
+// =====================
+// Partida a quente: retoma alertas, posição e emergência de antes do reset
+void restore_state(const retain_state_t *st)
 {
-    adc_select_input(JOYSTICK_X_ADC);
-    *x = adc_read();
-    adc_select_input(JOYSTICK_Y_ADC);
-    *y = adc_read();
+    if (st->flags & RETAIN_FLAG_FIX_VALID)
+    {
+        last_x = st->x;
+        last_y = st->y;
+        emergency_set_fix(st->fix);
+    }
+    stationary_count = st->idle;
+    red_alert_active = st->alert_level != 0;
+    if (st->flags & RETAIN_FLAG_EMERGENCY)
+    {
+        // O quadro sai já, antes do resto da inicialização
+        emergency_active = true;
+        emergency_trigger(time_us_32());
+    }
 }
 
 // =====================
-// Função: gpio_callback
+// Função: button_callback
 // =====================
-// Trata as interrupções dos botões A e B
-void gpio_callback(uint gpio, uint32_t events)
+// Trata os gestos dos botões A e B (já sem ruído, ver buttons.h)
+void RAM_HOT_FUNC(button_callback)(const button_event_t *ev)
 {
-    if (gpio == BUTTON_A)
+    TRACE_SAMPLE(TRACE_CH_BUTTON, ev->gpio, ev->gesture, ev->duration_us);
+    if (ev->gesture == BUTTON_PRESS)
+    {
+        // A segunda pressão do Botão B dentro de BUTTONS_MULTI_GAP_MS já é um
+        // clique duplo: a emergência sai nela, sem esperar o fim do gesto.
+        // buttons.c entrega o gesto anterior antes de uma pressão fora do
+        // intervalo, então basta contar as pressões até o próximo gesto.
+        if (ev->gpio == BUTTON_B && ++button_b_presses == 2 && !emergency_active)
+        {
+            // O quadro sai pelo rádio daqui mesmo, sem esperar o laço
+            emergency_trigger(ev->t_us);
+            emergency_active = true;
+            emergency_reported = false;
+            button_b_triggered = true;
+            annun_play(ANNUN_LAYER_EMERGENCY, &PATTERN_EMERGENCY);
+            TLOG(TLOG_EMERGENCY_ON, last_x, last_y);
+            save_state(NULL, 0, 0);
+        }
+        return; // Os demais gestos só interessam completos
+    }
+
+    TLOG(TLOG_BUTTON, ev->gpio, ev->gesture, ev->duration_us / 1000);
+
+    if (ev->gpio == BUTTON_A && ev->gesture == BUTTON_LONG)
+    {
+        // Alterna entre o minimapa e a tela normal (desenhada no laço)
+        map_view = !map_view;
+    }
+    else if (ev->gpio == BUTTON_A)
     {
         // Reseta os alertas e contadores
         red_alert_active = false;
-        buzzer_active = false;
-        pwm_set_enabled(slice_buzzer1, false); // Desliga a buzzer
-        gpio_put(LED_VERMELHO, 0);
+        annun_stop(ANNUN_LAYER_INACTIVITY); // Desliga a buzzer e os LEDs de inatividade
         ssd1306_clear(&display);
         ssd1306_draw_border(&display, 1);
         ssd1306_show(&display);
         last_move_time = get_absolute_time();
         stationary_count = 0;
+        save_state(NULL, 0, 0);
     }
-    else if (gpio == BUTTON_B)
+    else if (ev->gpio == BUTTON_B)
     {
-        // Lógica para acionar/desativar a emergência
-        absolute_time_t now = get_absolute_time();
-        if (absolute_time_diff_us(last_buttonB_time, now) < 500000)
-        { // Intervalo < 500ms
-            buttonB_count++;
-        }
-        else
+        // Fim do gesto: o clique duplo já ativou a emergência na 2ª pressão.
+        // Um clique triplo só desativa uma emergência de um gesto anterior;
+        // o que acabou de ativá-la (passando pelo duplo) a mantém.
+        bool triggered = button_b_triggered;
+        button_b_presses = 0;
+        button_b_triggered = false;
+        if (emergency_active && !triggered && ev->gesture == BUTTON_TRIPLE)
         {
-            buttonB_count = 1;
+            emergency_active = false;
+            emergency_cancel();
+            annun_stop(ANNUN_LAYER_EMERGENCY);
+            TLOG(TLOG_EMERGENCY_OFF);
+            save_state(NULL, 0, 0);
         }
-        last_buttonB_time = now;
+    }
+}
 
-        // Se não estiver em emergência e ocorrer 2 pressões consecutivas, ativa a emergência
-        if (!emergency_active && buttonB_count == 2)
+#if TRACE_REPLAY
+// =====================
+// Função: replay_inputs
+// =====================
+// Entrega os eventos gravados até a próxima leitura do joystick: os gestos
+// vão para button_callback, a posição para read_joystick e o instante para
+// loop_time_us. No fim da gravação o joystick e os botões reais voltam a ser
+// lidos, e o relógio do laço continua a partir do último instante gravado.
+void replay_inputs(void)
+{
+    trace_event_t ev;
+    while (replay_active)
+    {
+        if (!trace_next(&replay, &ev))
         {
-            emergency_active = true;
-            printf("EMERGENCIA - X:%d Y:%d\n", last_x, last_y);
+            replay_active = false;
+            replay_clock_offset = (int64_t)(replay_t_us - time_us_64());
+            break;
         }
-        // Se a emergência estiver ativa e ocorrer 3 pressões consecutivas, desativa a emergência
-        else if (emergency_active && buttonB_count == 3)
+        replay_t_us += (uint32_t)(ev.t_us - replay_last_t);
+        replay_last_t = ev.t_us;
+        if (!replay_started)
         {
-            emergency_active = false;
-            buttonB_count = 0;
-            printf("Emergencia Desativada.\n");
+            // A primeira amostra não acumula permanência (como em host/trace_replay)
+            replay_started = true;
+            last_sample_ms = (uint32_t)(replay_t_us / 1000);
+        }
+        if (ev.ch == TRACE_CH_BUTTON)
+        {
+            button_event_t b = {
+                .gpio = (uint8_t)ev.v[0],
+                .gesture = (uint8_t)ev.v[1],
+                .t_us = time_us_32(), // Só mede a latência da emergência, que é do alvo
+                .duration_us = (uint32_t)ev.v[2],
+            };
+            button_callback(&b);
+        }
+        else if (ev.ch == TRACE_CH_JOYSTICK)
+        {
+            replay_x = (uint16_t)ev.v[0];
+            replay_y = (uint16_t)ev.v[1];
+            break;
         }
     }
 }
 
 // =====================
-// Função: blink_led
+// Função: live_button_callback
 // =====================
-// Pisca um LED (definido por led_pin) por um número de vezes com um intervalo definido (ms)
-void blink_led(uint led_pin, int times, int interval_ms)
+// Gestos dos botões reais: ignorados enquanto a gravação é reproduzida, para
+// não se misturarem aos gravados
+void RAM_HOT_FUNC(live_button_callback)(const button_event_t *ev)
 {
-    for (int i = 0; i < times; i++)
-    {
-        gpio_put(led_pin, 1);
-        sleep_ms(interval_ms);
-        gpio_put(led_pin, 0);
-        sleep_ms(interval_ms);
-    }
+    if (!replay_active)
+        button_callback(ev);
 }
+#endif
 
 // =====================
 // Função: display_alert
@@ -154,70 +527,186 @@ void display_alert(uint16_t x, uint16_t y)
     ssd1306_show(&display);
 }
 
+// =====================
+// Função: draw_minimap
+// =====================
+// Mapa de permanência com as zonas restritas e a posição atual
+void draw_minimap(uint16_t x, uint16_t y)
+{
+    memset(display.buffer, 0, sizeof(display.buffer));
+    heatmap_draw(&heat, &heat_view, &display, x, y);
+    ssd1306_show(&display);
+}
+
 // =====================
 // Função: main
 // =====================
 int main()
 {
     stdio_init_all();
-    printf("Inicializando...\n");
-
-    // ---------- Configuração dos LEDs ----------
-    gpio_init(LED_VERDE);
-    gpio_set_dir(LED_VERDE, GPIO_OUT);
-    gpio_put(LED_VERDE, 0);
-
-    gpio_init(LED_AZUL);
-    gpio_set_dir(LED_AZUL, GPIO_OUT);
-    gpio_put(LED_AZUL, 0);
-
-    gpio_init(LED_VERMELHO);
-    gpio_set_dir(LED_VERMELHO, GPIO_OUT);
-    gpio_put(LED_VERMELHO, 0);
-
-    // ---------- Configuração da BUZZER (pino BUZZER1 - 10) ----------
-    gpio_set_function(BUZZER1_PIN, GPIO_FUNC_PWM);
-    slice_buzzer1 = pwm_gpio_to_slice_num(BUZZER1_PIN);
-    pwm_set_wrap(slice_buzzer1, 1000);
-    pwm_set_clkdiv(slice_buzzer1, 50.0f);
-    pwm_set_chan_level(slice_buzzer1, PWM_CHAN_A, 900);
-    pwm_set_enabled(slice_buzzer1, false);
+    TLOG(TLOG_BOOT);
+
+    // A partida prioriza o que deixa o crachá operacional: emergência
+    // retomada, primeira amostra e primeiro quadro. O que não depende disso
+    // (zonas, mapa, trajeto na flash) vem depois.
+    retain_state_t saved;
+    uint32_t warm_resets = 0;
+    bool warm = retain_load(&saved, &warm_resets);
+#if TRACE_REPLAY
+    warm = false; // A reprodução sempre parte do mesmo estado
+#endif
+    TLOG(TLOG_CRC_SNIFFER, crc_init()); // Quadros do rádio, páginas do trajeto e estado (crc.h)
+
+    // ---------- Rádio de emergência ----------
+    uart_init(RADIO_UART, RADIO_BAUD);
+    gpio_set_function(RADIO_TX_PIN, GPIO_FUNC_UART);
+    gpio_set_function(RADIO_RX_PIN, GPIO_FUNC_UART);
+    lora_init(RADIO_UART);
+    emergency_init(RADIO_UART);
+    if (warm)
+    {
+        restore_state(&saved);
+        TLOG(TLOG_WARM_BOOT, warm_resets, saved.alert_level, emergency_active);
+    }
 
     // ---------- Inicialização do ADC para o joystick ----------
     adc_init();
     adc_gpio_init(27); // Eixo Y
     adc_gpio_init(26); // Eixo X
+    uint16_t first_x, first_y;
+    read_joystick(&first_x, &first_y);
+    uint32_t first_sample_us = time_us_32();
+    PROF_RECORD_SINCE(PROF_BOOT_SAMPLE, 0);
+    if (!warm)
+    {
+        // Sem estado anterior, a posição de partida é a referência de movimento
+        last_x = first_x;
+        last_y = first_y;
+    }
+
+    // ---------- LEDs e BUZZER (PWM alimentado por DMA) ----------
+    const uint annun_pins[ANNUN_OUT_COUNT] = {
+        [ANNUN_BUZZER] = BUZZER1_PIN,
+        [ANNUN_LED_GREEN] = LED_VERDE,
+        [ANNUN_LED_BLUE] = LED_AZUL,
+        [ANNUN_LED_RED] = LED_VERMELHO,
+    };
+    annun_init(annun_pins, BUZZER_HZ);
+    // Todos os padrões são convertidos aqui: nos botões, annun_play só liga o DMA
+    const annun_pattern_t *const patterns[] = {
+        &PATTERN_ZONE, &PATTERN_IDLE_BLUE, &PATTERN_RED_ALERT, &PATTERN_RED_BUZZER, &PATTERN_EMERGENCY,
+    };
+    for (uint32_t i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++)
+    {
+        bool prepared = annun_prepare(patterns[i]);
+        hard_assert(prepared);
+    }
+    if (emergency_active)
+        annun_play(ANNUN_LAYER_EMERGENCY, &PATTERN_EMERGENCY);
+
+    // ---------- Botões A e B (debounce em PIO) ----------
+    const uint button_pins[] = {BUTTON_A, BUTTON_B};
+    const buttons_config_t button_cfg = BUTTONS_CONFIG_DEFAULT;
+#if TRACE_REPLAY
+    buttons_init(button_pins, 2, &button_cfg, live_button_callback);
+#else
+    buttons_init(button_pins, 2, &button_cfg, button_callback);
+#endif
 
     // ---------- Inicialização do I2C e do Display OLED ----------
-    i2c_init(i2c1, 100 * 1000);
+    i2c_init(i2c1, I2C_HZ);
     gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA_PIN);
     gpio_pull_up(I2C_SCL_PIN);
+    // Configuração numa única transação; o buffer já começa zerado, então o
+    // primeiro quadro é a borda (sem o envio de uma tela vazia antes)
     ssd1306_init(&display, i2c1, SSD1306_ADDR, 128, 64);
-    ssd1306_clear(&display);
-    ssd1306_draw_border(&display, 1);
+    ssd1306_draw_border(&display, 1); // Um alerta retomado é redesenhado pelo laço
     ssd1306_show(&display);
+    uint32_t first_frame_us = time_us_32();
+    PROF_RECORD_SINCE(PROF_BOOT_FRAME, 0);
+    TLOG(TLOG_BOOT_TIMES, first_sample_us, first_frame_us);
+
+    // ---------- Zonas restritas ----------
+    geofence_init(&fence, &geofence_map);
+
+    // ---------- Mapa de permanência (grade 128x128, células de 32 unidades) ----------
+    heatmap_init(&heat, 0, 0, 5);
+    heatmap_view_init(&heat_view, &heat, MAP_X, 0, 1, &geofence_map);
+    last_sample_ms = (uint32_t)(loop_time_us() / 1000);
+
+#if FP_ENABLED
+    // ---------- Localização por RSSI (rádio Wi-Fi do Pico W) ----------
+    fp_cyw43_init(&fp_source);
+#endif
+
+    // ---------- Histórico de posições na flash ----------
+    track_mount(&track, track_flash_pico(), to_ms_since_boot(get_absolute_time()));
+    track_simplify_init(&track_simp, TRACK_TOLERANCE, TRACK_WINDOW);
+#if TRACE_ENABLED && TRACE_FLASH
+    trace_sink_flash(&trace_sink, &trace_flash, trace_flash_pico());
+#endif
 
-    // ---------- Configuração do Botão A ----------
-    gpio_init(BUTTON_A);
-    gpio_set_dir(BUTTON_A, GPIO_IN);
-    gpio_pull_up(BUTTON_A);
-    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
+    last_move_time = get_absolute_time();
 
-    // ---------- Configuração do Botão B (Emergência) ----------
-    gpio_init(BUTTON_B);
-    gpio_set_dir(BUTTON_B, GPIO_IN);
-    gpio_pull_up(BUTTON_B);
-    gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL, true);
+#if TRACE_REPLAY
+    trace_reader_init(&replay, trace_replay_data, trace_replay_size);
+#endif
 
-    last_move_time = get_absolute_time();
+    // ---------- Consumidores das posições ----------
+    bus_subscribe(&sub_log, BUS_POSITION);
+    bus_subscribe(&sub_loop, BUS_POSITION);
+    uint32_t last_stats_ms = (uint32_t)(loop_time_us() / 1000);
+
+    // Um travamento reinicia o crachá pelo caminho de partida a quente
+    watchdog_enable(WATCHDOG_MS, true);
 
     // ---------- Loop Principal ----------
     while (true)
     {
-        uint16_t x, y;
-        read_joystick(&x, &y);
+        PROF_SCOPE(PROF_MAIN_LOOP);
+        PROF_POLL();
+        watchdog_update();
+        tlog_drain(0); // Envia pela USB as mensagens registradas desde a última iteração
+        // Gravar ou apagar a flash mascara as interrupções (até centenas de
+        // ms num apagamento): com um gesto do Botão B em andamento, a pressão
+        // que ativa a emergência pode chegar a qualquer momento, então o
+        // trajeto e as entradas esperam no barramento e no buffer até ele
+        // terminar (no máximo BUTTONS_LONG_MS ou três intervalos)
+        bool flash_hold = buttons_gesture_pending(BUTTON_B);
+#if TRACE_ENABLED && TRACE_FLASH
+        if (!flash_hold)
+            trace_drain(&trace_sink, 0); // Entradas gravadas, página a página na flash
+#else
+        TRACE_DRAIN(); // Entradas gravadas (quadros lidos por tlog_decode.py --trace)
+#endif
+        MIRROR_DRAIN(); // Quadros novos do display (tools/mirror_view.py)
+
+#if TRACE_REPLAY
+        replay_inputs();
+#endif
+
+        // Uma leitura por volta, publicada no barramento; cada consumidor lê
+        // a sua cópia do tópico sem novas leituras do sensor
+        sample_position();
+        if (!flash_hold)
+            log_positions();
+
+        uint16_t x = last_x, y = last_y;
+        latest_position(&sub_loop, &x, &y);
+
+        uint32_t now_ms = (uint32_t)(loop_time_us() / 1000);
+        if (now_ms - last_stats_ms >= STATS_MS)
+        {
+            last_stats_ms = now_ms;
+            log_stats();
+        }
+
+        // Posição usada pelos quadros de emergência
+        char fix[24];
+        snprintf(fix, sizeof(fix), "X:%d Y:%d", x, y);
+        emergency_set_fix(fix);
 
         // Verifica se houve movimento significativo comparando com os valores anteriores
         if ((abs(x - last_x) > DEADZONE) || (abs(y - last_y) > DEADZONE))
@@ -225,15 +714,12 @@ int main()
             last_move_time = get_absolute_time();
             stationary_count = 0;
             red_alert_active = false; // Cancela o alerta vermelho se houver movimento
-            if (buzzer_active)
+            annun_stop(ANNUN_LAYER_INACTIVITY);
+            if (!map_view)
             {
-                buzzer_active = false;
-                pwm_set_enabled(slice_buzzer1, false);
+                ssd1306_draw_border(&display, 1);
+                ssd1306_show(&display);
             }
-            gpio_put(LED_AZUL, 0);
-            gpio_put(LED_VERMELHO, 0);
-            ssd1306_draw_border(&display, 1);
-            ssd1306_show(&display);
             last_x = x;
             last_y = y;
         }
@@ -241,95 +727,70 @@ int main()
         {
             stationary_count++;
         }
+        save_state(fix, x, y);
 
         // Se o modo emergência estiver ativo, envia a mensagem periodicamente
         if (emergency_active)
         {
-            printf("EMERGENCIA - GPS - X:%d Y:%d\n", x, y);
+            TLOG(TLOG_EMERGENCY_GPS, x, y);
+            emergency_stats_t em;
+            if (emergency_poll_report(&em))
+                TLOG(TLOG_EMERGENCY_LATENCY, em.last_us, em.press_us, em.max_us);
+            if (!emergency_reported)
+            {
+                emergency_reported = true;
+                // Garante o trajeto até a emergência na flash
+                track_record_t last;
+                if (track_simplify_flush(&track_simp, &last))
+                    track_append(&track, last.t_ms, last.x, last.y, last.flags);
+                track_flush(&track);
+#if TRACE_ENABLED && TRACE_FLASH
+                trace_seal(); // Fecha o bloco com o CRC para a leitura conferir
+                trace_drain(&trace_sink, 0);
+                trace_flash_flush(&trace_flash); // E as entradas que levaram a ela
+#endif
+            }
             sleep_ms(1000);
             continue;
         }
 
-        // 1. Checa se o joystick está fora do intervalo seguro [700, 3300]
-        if (x < 700 || x > 3300 || y < 700 || y > 3300)
+        // 1. Checa se o joystick está numa zona restrita (por padrão, fora do intervalo seguro [700, 3300])
+        if (geofence_action(&fence) >= GEOFENCE_ACTION_ALERT)
         {
-            gpio_put(LED_VERDE, !gpio_get(LED_VERDE));
-            gpio_put(LED_VERMELHO, !gpio_get(LED_VERMELHO));
-            if (!buzzer_active)
-            {
-                buzzer_active = true;
-                pwm_set_enabled(slice_buzzer1, true);
-                beep_on = true;
-            }
-            else
-            {
-                beep_on = !beep_on;
-                if (beep_on)
-                    pwm_set_chan_level(slice_buzzer1, PWM_CHAN_A, 900);
-                else
-                    pwm_set_chan_level(slice_buzzer1, PWM_CHAN_A, 0);
-            }
+            annun_play(ANNUN_LAYER_ZONE, &PATTERN_ZONE);
             sleep_ms(500);
             continue;
         }
-        else
-        {
-            gpio_put(LED_VERDE, 0);
-            if (!red_alert_active)
-            {
-                gpio_put(LED_VERMELHO, 0);
-            }
-            if (buzzer_active && stationary_count < TIME_BUZZER)
-            {
-                buzzer_active = false;
-                pwm_set_enabled(slice_buzzer1, false);
-            }
-        }
+        annun_stop(ANNUN_LAYER_ZONE);
 
         // Exibe os valores do joystick via serial
-        printf("GPS - X:%d Y:%d\n", x, y);
+        TLOG(TLOG_GPS_POS, x, y);
 
         // 3. Alertas de inatividade
         if (stationary_count == TIME_BLUE_LED)
         {
-            blink_led(LED_AZUL, 10, 500);
-            gpio_put(LED_AZUL, 0);
+            annun_play(ANNUN_LAYER_INACTIVITY, &PATTERN_IDLE_BLUE);
         }
 
-        
         if (stationary_count >= TIME_RED_ALERT)
         {
             red_alert_active = true;
-           
-            printf("ATENCAO - ");
-            display_alert(x, y);
-            gpio_put(LED_VERMELHO, !gpio_get(LED_VERMELHO));
-        }
 
-        if (stationary_count >= TIME_BUZZER)
-        {
-            if (!buzzer_active)
-            {
-                buzzer_active = true;
-                pwm_set_enabled(slice_buzzer1, true);
-                beep_on = true;
-            }
+            TLOG(TLOG_ATTENTION, x, y);
+            display_alert(x, y);
+            annun_play(ANNUN_LAYER_INACTIVITY,
+                       stationary_count >= TIME_BUZZER ? &PATTERN_RED_BUZZER : &PATTERN_RED_ALERT);
         }
 
         int delay_ms = 2000;
-        if (buzzer_active)
+        if (red_alert_active)
         {
-            beep_on = !beep_on;
-            if (beep_on)
-                pwm_set_chan_level(slice_buzzer1, PWM_CHAN_A, 900);
-            else
-                pwm_set_chan_level(slice_buzzer1, PWM_CHAN_A, 0);
             delay_ms = 500;
         }
 
-        if (red_alert_active && !buzzer_active)
+        if (map_view && !red_alert_active)
         {
-            delay_ms = 500;
+            draw_minimap(x, y);
         }
 
         sleep_ms(delay_ms);
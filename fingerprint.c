@@ -0,0 +1,146 @@
+#include "fingerprint.h"
+#include "prof.h"
+#include <string.h>
+
+typedef struct {
+    uint32_t d2;
+    uint16_t point;
+} fp_neighbour_t;
+
+static uint32_t fp_isqrt(uint32_t v) {
+    uint32_t r = 0, bit = 1u << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+static int fp_find_ap(const fp_db_t *db, const fp_ap_id_t *id) {
+    int lo = 0, hi = db->ap_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int c = memcmp(db->aps[mid].id, id->id, sizeof(id->id));
+        if (c == 0) return mid;
+        if (c < 0)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return -1;
+}
+
+// Compara os pontos do grupo 'g' com a consulta, mantendo os FP_K melhores
+// em ordem crescente. A soma é interrompida assim que passa do pior vizinho.
+static uint32_t fp_scan_group(const fp_db_t *db, const int8_t *q, uint32_t g, fp_neighbour_t *best,
+                              uint32_t *found) {
+    uint32_t first = db->group_start[g], last = db->group_start[g + 1];
+    uint32_t n = db->ap_count;
+    for (uint32_t p = first; p < last; p++) {
+        const int8_t *row = &db->rssi[p * n];
+        uint32_t limit = *found < FP_K ? UINT32_MAX : best[FP_K - 1].d2;
+        uint32_t d2 = 0;
+        for (uint32_t a = 0; a < n && d2 < limit; a++) {
+            int32_t diff = q[a] - row[a];
+            d2 += (uint32_t)(diff * diff);
+        }
+        if (d2 >= limit) continue;
+
+        uint32_t i = *found < FP_K ? (*found)++ : FP_K - 1;
+        while (i > 0 && best[i - 1].d2 > d2) {
+            best[i] = best[i - 1];
+            i--;
+        }
+        best[i].d2 = d2;
+        best[i].point = (uint16_t)p;
+    }
+    return last - first;
+}
+
+bool fp_locate(const fp_db_t *db, const fp_scan_t *scan, fp_estimate_t *out) {
+    PROF_SCOPE(PROF_FP_LOCATE);
+    int8_t q[FP_MAX_APS];
+    memset(q, FP_RSSI_FLOOR, sizeof(q));
+
+    uint32_t heard = 0;
+    for (uint32_t i = 0; i < scan->count; i++) {
+        int a = fp_find_ap(db, &scan->ap[i].id);
+        if (a < 0) continue;
+        int8_t r = scan->ap[i].rssi;
+        if (r < FP_RSSI_FLOOR) r = FP_RSSI_FLOOR;
+        if (r > FP_RSSI_CEIL) r = FP_RSSI_CEIL;
+        if (q[a] == FP_RSSI_FLOOR) heard++;
+        if (r > q[a]) q[a] = r;
+    }
+    out->heard = (uint8_t)heard;
+    out->compared = 0;
+    if (heard < FP_MIN_APS) return false;
+
+    // Índice grosso: grupos dos beacons mais fortes da varredura
+    uint8_t probe[FP_PROBE_GROUPS];
+    uint32_t probes = 0;
+    for (uint32_t a = 0; a < db->ap_count; a++) {
+        if (q[a] == FP_RSSI_FLOOR) continue;
+        uint32_t i = probes < FP_PROBE_GROUPS ? probes++ : FP_PROBE_GROUPS;
+        while (i > 0 && q[probe[i - 1]] < q[a]) {
+            if (i < FP_PROBE_GROUPS) probe[i] = probe[i - 1];
+            i--;
+        }
+        if (i < FP_PROBE_GROUPS) probe[i] = (uint8_t)a;
+    }
+
+    fp_neighbour_t best[FP_K];
+    uint32_t found = 0, compared = 0;
+    for (uint32_t i = 0; i < probes; i++) compared += fp_scan_group(db, q, probe[i], best, &found);
+    if (found < FP_K) {
+        // Grupos pequenos demais: completa com a base inteira
+        for (uint32_t g = 0; g < db->ap_count; g++) {
+            bool visited = false;
+            for (uint32_t i = 0; i < probes; i++) visited |= probe[i] == g;
+            if (!visited) compared += fp_scan_group(db, q, g, best, &found);
+        }
+    }
+    out->compared = (uint16_t)compared;
+    if (found == 0) return false;
+
+    // Média ponderada por 1 / d^2
+    uint64_t wsum = 0;
+    int64_t xs = 0, ys = 0;
+    uint32_t w[FP_K];
+    for (uint32_t i = 0; i < found; i++) {
+        w[i] = 0xFFFFFFFFu / (best[i].d2 + 1);
+        const int16_t *p = &db->pos[best[i].point * 2];
+        wsum += w[i];
+        xs += (int64_t)w[i] * p[0];
+        ys += (int64_t)w[i] * p[1];
+    }
+    out->x = (int32_t)(xs / (int64_t)wsum);
+    out->y = (int32_t)(ys / (int64_t)wsum);
+
+    // Confiança: erro RMS por beacon ouvido e dispersão dos vizinhos
+    uint64_t spread = 0;
+    for (uint32_t i = 0; i < found; i++) {
+        const int16_t *p = &db->pos[best[i].point * 2];
+        int64_t dx = p[0] - out->x, dy = p[1] - out->y;
+        uint64_t d2 = (uint64_t)(dx * dx + dy * dy);
+        spread += (uint64_t)w[i] * fp_isqrt(d2 > UINT32_MAX ? UINT32_MAX : (uint32_t)d2);
+    }
+    uint32_t rms = fp_isqrt(best[0].d2 / heard);
+    uint32_t dist = (uint32_t)(spread / wsum);
+    uint32_t c_rms = rms >= FP_RMS_BAD_DB ? 0 : 100 - rms * 100 / FP_RMS_BAD_DB;
+    uint32_t c_spread = dist >= FP_SPREAD_BAD ? 0 : 100 - dist * 100 / FP_SPREAD_BAD;
+    out->confidence = (uint8_t)(c_rms * c_spread / 100);
+    return true;
+}
+
+bool fp_update(const fp_source_t *src, const fp_db_t *db, fp_estimate_t *out) {
+    fp_scan_t scan;
+    if (!src->poll(src->ctx, &scan)) return false;
+    return fp_locate(db, &scan, out);
+}
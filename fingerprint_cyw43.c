@@ -0,0 +1,52 @@
+#include "fingerprint.h"
+#include "pico/cyw43_arch.h"
+#include <string.h>
+
+// Fonte de varreduras do rádio Wi-Fi do Pico W. Cada poll() sem varredura
+// em andamento dispara uma nova; os resultados chegam pelo callback do
+// driver (contexto de fundo do cyw43_arch) e são entregues quando o driver
+// termina a varredura.
+
+static fp_scan_t building;
+static bool scanning;
+
+static int fp_cyw43_result(void *env, const cyw43_ev_scan_result_t *result) {
+    (void)env;
+    if (!result) return 0;
+    // O mesmo AP aparece uma vez por canal/anúncio: fica o sinal mais forte
+    for (uint32_t i = 0; i < building.count; i++) {
+        if (memcmp(building.ap[i].id.id, result->bssid, 6) == 0) {
+            if (result->rssi > building.ap[i].rssi) building.ap[i].rssi = (int8_t)result->rssi;
+            return 0;
+        }
+    }
+    if (building.count < FP_SCAN_MAX) {
+        memcpy(building.ap[building.count].id.id, result->bssid, 6);
+        building.ap[building.count].rssi = (int8_t)result->rssi;
+        building.count++;
+    }
+    return 0;
+}
+
+static bool fp_cyw43_poll(void *ctx, fp_scan_t *scan) {
+    (void)ctx;
+    if (scanning) {
+        if (cyw43_wifi_scan_active(&cyw43_state)) return false;
+        scanning = false;
+        *scan = building;
+        return true;
+    }
+
+    building.count = 0;
+    cyw43_wifi_scan_options_t opts = {0};
+    scanning = cyw43_wifi_scan(&cyw43_state, &opts, NULL, fp_cyw43_result) == 0;
+    return false;
+}
+
+bool fp_cyw43_init(fp_source_t *src) {
+    if (cyw43_arch_init() != 0) return false;
+    cyw43_arch_enable_sta_mode();
+    src->poll = fp_cyw43_poll;
+    src->ctx = NULL;
+    return true;
+}
@@ -0,0 +1,46 @@
+// Gerado por tools/gen_fingerprints.py a partir de fingerprints.json. Não editar à mão.
+#include "fingerprint.h"
+
+static const fp_ap_id_t aps[] = {
+    {{0x02, 0x00, 0x00, 0x00, 0x00, 0x00}}, // 02:00:00:00:00:00
+    {{0x02, 0x00, 0x00, 0x00, 0x00, 0x01}}, // 02:00:00:00:00:01
+    {{0x02, 0x00, 0x00, 0x00, 0x00, 0x02}}, // 02:00:00:00:00:02
+    {{0x02, 0x00, 0x00, 0x00, 0x00, 0x03}}, // 02:00:00:00:00:03
+};
+
+static const int8_t rssi[] = {
+    -66, -72, -84, -66,
+    -61, -76, -85, -81,
+    -78, -80, -95, -78,
+    -78, -80, -80, -84,
+    -82, -84, -92, -82,
+    -76, -82, -88, -81,
+    -85, -93, -85, -91,
+    -83, -87, -92, -90,
+    -78, -64, -87, -64,
+    -88, -85, -89, -90,
+    -82, -88, -56, -83,
+    -78, -76, -70, -77,
+    -81, -84, -77, -88,
+    -82, -85, -73, -79,
+    -95, -88, -84, -86,
+    -93, -92, -86, -93,
+};
+
+static const int16_t pos[] = {
+    2560, 512, 2560, 1536, 3584, 1536, 1536, 2560, 2560, 2560, 3584, 2560, 512, 3584, 3584, 3584,
+    3584, 512, 2560, 3584, 512, 512, 1536, 512, 512, 1536, 1536, 1536, 512, 2560, 1536, 3584,
+};
+
+static const uint16_t group_start[] = {
+    0, 8, 10, 16, 16,
+};
+
+const fp_db_t fingerprint_db = {
+    .aps = aps,
+    .rssi = rssi,
+    .pos = pos,
+    .group_start = group_start,
+    .ap_count = 4,
+    .point_count = 16,
+};
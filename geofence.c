@@ -0,0 +1,120 @@
+#include "geofence.h"
+
+void geofence_init(geofence_t *g, const geofence_map_t *map) {
+    g->map = map;
+    g->active_count = 0;
+}
+
+// Teste de ponto no polígono (número de cruzamentos). Os produtos usam 64
+// bits: as coordenadas são int16 e as diferenças chegam a 17 bits.
+static bool geofence_inside(const geofence_map_t *m, const geofence_zone_t *z, int32_t x, int32_t y) {
+    if (x < z->min_x || x > z->max_x || y < z->min_y || y > z->max_y) return false;
+
+    const geofence_point_t *v = &m->vertices[z->first_vertex];
+    bool inside = false;
+    for (uint32_t i = 0, j = z->vertex_count - 1; i < z->vertex_count; j = i++) {
+        int32_t yi = v[i].y, yj = v[j].y;
+        if ((yi > y) != (yj > y)) {
+            // x < xi + (y - yi) * (xj - xi) / (yj - yi), sem divisão
+            int64_t lhs = (int64_t)(x - v[i].x) * (yj - yi);
+            int64_t rhs = (int64_t)(y - yi) * (v[j].x - v[i].x);
+            if ((yj > yi) ? (lhs < rhs) : (lhs > rhs)) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// true se o ponto está a menos de 'margin' de alguma aresta da zona
+static bool geofence_near_edge(const geofence_map_t *m, const geofence_zone_t *z, int32_t x, int32_t y,
+                               int32_t margin) {
+    if (x < z->min_x - margin || x > z->max_x + margin || y < z->min_y - margin || y > z->max_y + margin)
+        return false;
+
+    const geofence_point_t *v = &m->vertices[z->first_vertex];
+    int64_t margin2 = (int64_t)margin * margin;
+    for (uint32_t i = 0, j = z->vertex_count - 1; i < z->vertex_count; j = i++) {
+        int64_t ex = v[i].x - v[j].x, ey = v[i].y - v[j].y;
+        int64_t px = x - v[j].x, py = y - v[j].y;
+        int64_t len2 = ex * ex + ey * ey;
+        int64_t dot = px * ex + py * ey;
+        int64_t dx, dy;
+        if (len2 == 0 || dot <= 0) {
+            dx = px;
+            dy = py;
+        } else if (dot >= len2) {
+            dx = x - v[i].x;
+            dy = y - v[i].y;
+        } else {
+            // Distância à reta: |p x e|^2 / |e|^2. Em float, pois cross^2
+            // estoura 64 bits; só roda ao sair de uma zona ativa.
+            float cross = (float)(px * ey - py * ex);
+            if (cross * cross / (float)len2 < (float)margin2) return true;
+            continue;
+        }
+        if (dx * dx + dy * dy < margin2) return true;
+    }
+    return false;
+}
+
+static bool geofence_is_active(const geofence_t *g, uint16_t zone) {
+    for (uint32_t i = 0; i < g->active_count; i++) {
+        if (g->active[i] == zone) return true;
+    }
+    return false;
+}
+
+uint32_t geofence_update(geofence_t *g, int32_t x, int32_t y, geofence_event_t *events) {
+    const geofence_map_t *m = g->map;
+    uint32_t n = 0;
+
+    // 1. Zonas ativas: saem apenas fora do polígono e além da histerese
+    for (uint32_t i = 0; i < g->active_count;) {
+        uint16_t zone = g->active[i];
+        const geofence_zone_t *z = &m->zones[zone];
+        if (geofence_inside(m, z, x, y) || geofence_near_edge(m, z, x, y, m->hysteresis)) {
+            i++;
+            continue;
+        }
+        events[n].zone = zone;
+        events[n].type = GEOFENCE_EXIT;
+        events[n].action = z->action;
+        n++;
+        g->active[i] = g->active[--g->active_count];
+    }
+
+    // 2. Candidatas da célula: entram ao ficar dentro do polígono
+    int32_t cx = (x - m->x0) >> m->cell_shift;
+    int32_t cy = (y - m->y0) >> m->cell_shift;
+    if (x < m->x0 || y < m->y0 || cx >= m->grid_w || cy >= m->grid_h) return n; // Fora da grade
+
+    uint32_t cell = (uint32_t)cy * m->grid_w + (uint32_t)cx;
+    for (uint32_t k = m->cell_start[cell]; k < m->cell_start[cell + 1]; k++) {
+        uint16_t zone = m->cell_zones[k];
+        if (g->active_count >= GEOFENCE_MAX_ACTIVE) break;
+        if (geofence_is_active(g, zone)) continue;
+        const geofence_zone_t *z = &m->zones[zone];
+        if (!geofence_inside(m, z, x, y)) continue;
+        g->active[g->active_count++] = zone;
+        events[n].zone = zone;
+        events[n].type = GEOFENCE_ENTER;
+        events[n].action = z->action;
+        n++;
+    }
+    return n;
+}
+
+uint16_t geofence_top_zone(const geofence_t *g) {
+    uint16_t best = GEOFENCE_NO_ZONE;
+    for (uint32_t i = 0; i < g->active_count; i++) {
+        uint16_t zone = g->active[i];
+        if (best == GEOFENCE_NO_ZONE || g->map->zones[zone].priority > g->map->zones[best].priority)
+            best = zone;
+    }
+    return best;
+}
+
+geofence_action_t geofence_action(const geofence_t *g) {
+    uint16_t zone = geofence_top_zone(g);
+    if (zone == GEOFENCE_NO_ZONE) return GEOFENCE_ACTION_NONE;
+    return (geofence_action_t)g->map->zones[zone].action;
+}
@@ -0,0 +1,67 @@
+// Gerado por tools/gen_zonas.py a partir de zonas.json. Não editar à mão.
+#include "geofence.h"
+
+static const geofence_point_t vertices[] = {
+    {-1000, -1000}, {700, -1000}, {700, 5096}, {-1000, 5096}, // fora_esquerda
+    {3301, -1000}, {5096, -1000}, {5096, 5096}, {3301, 5096}, // fora_direita
+    {-1000, -1000}, {5096, -1000}, {5096, 700}, {-1000, 700}, // fora_inferior
+    {-1000, 3301}, {5096, 3301}, {5096, 5096}, {-1000, 5096}, // fora_superior
+};
+
+static const geofence_zone_t zones[] = {
+    {0, 4, 1, GEOFENCE_ACTION_ALERT, -1000, -1000, 700, 5096}, // 0: fora_esquerda
+    {4, 4, 1, GEOFENCE_ACTION_ALERT, 3301, -1000, 5096, 5096}, // 1: fora_direita
+    {8, 4, 1, GEOFENCE_ACTION_ALERT, -1000, -1000, 5096, 700}, // 2: fora_inferior
+    {12, 4, 1, GEOFENCE_ACTION_ALERT, -1000, 3301, 5096, 5096}, // 3: fora_superior
+};
+
+static const uint16_t cell_start[] = {
+    0, 2, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17, 19, 21,
+    23, 25, 27, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 40, 42, 44,
+    46, 48, 50, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 63, 65, 67,
+    69, 70, 71, 72, 72, 72, 72, 72, 72, 72, 72, 72, 72, 73, 74, 75,
+    76, 77, 78, 79, 79, 79, 79, 79, 79, 79, 79, 79, 79, 80, 81, 82,
+    83, 84, 85, 86, 86, 86, 86, 86, 86, 86, 86, 86, 86, 87, 88, 89,
+    90, 91, 92, 93, 93, 93, 93, 93, 93, 93, 93, 93, 93, 94, 95, 96,
+    97, 98, 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 101, 102, 103,
+    104, 105, 106, 107, 107, 107, 107, 107, 107, 107, 107, 107, 107, 108, 109, 110,
+    111, 112, 113, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 115, 116, 117,
+    118, 119, 120, 121, 121, 121, 121, 121, 121, 121, 121, 121, 121, 122, 123, 124,
+    125, 126, 127, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 129, 130, 131,
+    132, 134, 136, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147, 149, 151, 153,
+    155, 157, 159, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 172, 174, 176,
+    178, 180, 182, 184, 185, 186, 187, 188, 189, 190, 191, 192, 193, 195, 197, 199,
+    201, 203, 205, 207, 208, 209, 210, 211, 212, 213, 214, 215, 216, 218, 220, 222,
+    224,
+};
+
+static const uint16_t cell_zones[] = {
+    0, 2, 0, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1,
+    2, 1, 2, 1, 2, 1, 2, 0, 2, 0, 2, 0, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 1, 2, 1, 2, 0, 2,
+    0, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1,
+    2, 1, 2, 1, 2, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 1,
+    1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1,
+    1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0,
+    0, 0, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0,
+    1, 1, 1, 1, 0, 3, 0, 3, 0, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 1, 3, 1, 3, 1, 3, 1, 3, 0, 3, 0, 3, 0,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 1, 3, 1, 3,
+    1, 3, 0, 3, 0, 3, 0, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 1, 3, 1, 3, 1, 3, 1, 3, 0, 3, 0, 3, 0, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 1, 3, 1, 3, 1, 3,
+};
+
+const geofence_map_t geofence_map = {
+    .vertices = vertices,
+    .zones = zones,
+    .zone_count = 4,
+    .cell_start = cell_start,
+    .cell_zones = cell_zones,
+    .x0 = 0,
+    .y0 = 0,
+    .cell_shift = 8,
+    .grid_w = 16,
+    .grid_h = 16,
+    .hysteresis = 50,
+};
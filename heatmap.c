@@ -0,0 +1,168 @@
+#include "heatmap.h"
+#include "ram_hot.h"
+#include <string.h>
+
+// Limiares do pontilhado ordenado (Bayer 4x4)
+static const uint8_t RAM_HOT_DATA("heatmap") heatmap_bayer[4][4] = {
+    {0, 8, 2, 10},
+    {12, 4, 14, 6},
+    {3, 11, 1, 9},
+    {15, 7, 13, 5},
+};
+
+void heatmap_init(heatmap_t *h, int16_t x0, int16_t y0, uint8_t cell_shift) {
+    memset(h->cells, 0, sizeof(h->cells));
+    h->x0 = x0;
+    h->y0 = y0;
+    h->cell_shift = cell_shift;
+    h->peak = 0;
+    h->decay_row = 0;
+    h->decay_acc = 0;
+    h->dwell_acc = 0;
+}
+
+// v -= ceil(v / 8) em cada byte da palavra. O desconto nunca passa de v,
+// então não há empréstimo entre bytes; valores pequenos chegam a zero.
+static inline uint32_t heatmap_decay_word(uint32_t w) {
+    uint32_t low = w & 0x07070707u;
+    uint32_t round_up = (low | (low >> 1) | (low >> 2)) & 0x01010101u;
+    return w - (((w >> 3) & 0x1F1F1F1Fu) + round_up);
+}
+
+static void RAM_HOT_FUNC(heatmap_decay_row)(heatmap_t *h) {
+    uint32_t *w = (uint32_t *)h->cells[h->decay_row];
+    for (uint32_t i = 0; i < HEATMAP_COLS / 4; i++) w[i] = heatmap_decay_word(w[i]);
+
+    if (++h->decay_row == HEATMAP_ROWS) {
+        h->decay_row = 0;
+        h->peak = (uint8_t)heatmap_decay_word(h->peak);
+    }
+}
+
+void RAM_HOT_FUNC(heatmap_dwell)(heatmap_t *h, int32_t x, int32_t y, uint32_t dt_ms) {
+    if (dt_ms > HEATMAP_DECAY_PERIOD_MS) dt_ms = HEATMAP_DECAY_PERIOD_MS;
+
+    h->dwell_acc += dt_ms;
+    uint32_t add = h->dwell_acc / HEATMAP_MS_PER_COUNT;
+    h->dwell_acc %= HEATMAP_MS_PER_COUNT;
+    if (add && x >= h->x0 && y >= h->y0) {
+        uint32_t cx = (uint32_t)(x - h->x0) >> h->cell_shift;
+        uint32_t cy = (uint32_t)(y - h->y0) >> h->cell_shift;
+        if (cx < HEATMAP_COLS && cy < HEATMAP_ROWS) {
+            uint32_t v = h->cells[cy][cx] + add;
+            if (v > 255) v = 255; // Saturação
+            h->cells[cy][cx] = (uint8_t)v;
+            if (v > h->peak) h->peak = (uint8_t)v;
+        }
+    }
+
+    // Decaimento proporcional ao tempo, limitado por amostra; atrasos
+    // maiores que o limite são descartados em vez de acumulados
+    h->decay_acc += dt_ms * HEATMAP_ROWS;
+    uint32_t rows = h->decay_acc / HEATMAP_DECAY_PERIOD_MS;
+    if (rows > HEATMAP_DECAY_MAX_ROWS) {
+        rows = HEATMAP_DECAY_MAX_ROWS;
+        h->decay_acc = 0;
+    } else {
+        h->decay_acc -= rows * HEATMAP_DECAY_PERIOD_MS;
+    }
+    while (rows--) heatmap_decay_row(h);
+}
+
+// Coordenada de posição -> pixel do minimapa (pode cair fora da vista)
+static inline int32_t heatmap_to_px(int32_t v, int32_t origin, uint32_t shift) {
+    int32_t d = v - origin;
+    return d >= 0 ? d >> shift : -((-d + (1 << shift) - 1) >> shift);
+}
+
+static void RAM_HOT_FUNC(heatmap_outline_pixel)(heatmap_view_t *v, int32_t x, int32_t y) {
+    if (x < 0 || y < 0 || x >= v->w || y >= v->h) return;
+    v->outline[(y / 8) * v->w + x] |= (uint8_t)(1u << (y % 8));
+}
+
+// Bresenham entre dois pixels do minimapa
+static void RAM_HOT_FUNC(heatmap_outline_line)(heatmap_view_t *v, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    int32_t dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int32_t dy = y1 > y0 ? y0 - y1 : y1 - y0;
+    int32_t sx = x0 < x1 ? 1 : -1;
+    int32_t sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) {
+        heatmap_outline_pixel(v, x0, y0);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void heatmap_view_init(heatmap_view_t *v, const heatmap_t *h, uint8_t x, uint8_t y, uint8_t shift,
+                       const geofence_map_t *map) {
+    if (shift < 1) shift = 1;
+    v->x = x;
+    v->y = y & ~7u; // Alinhado às páginas de 8 linhas do SSD1306
+    v->shift = shift;
+    v->w = HEATMAP_COLS >> shift;
+    v->h = HEATMAP_ROWS >> shift;
+    if (v->x + v->w > SSD1306_WIDTH) v->w = SSD1306_WIDTH - v->x;
+    if (v->y + v->h > SSD1306_HEIGHT) v->h = SSD1306_HEIGHT - v->y;
+    memset(v->outline, 0, sizeof(v->outline));
+    if (!map) return;
+
+    uint32_t s = h->cell_shift + shift;
+    for (uint32_t z = 0; z < map->zone_count; z++) {
+        const geofence_zone_t *zone = &map->zones[z];
+        const geofence_point_t *p = &map->vertices[zone->first_vertex];
+        for (uint32_t i = 0, j = zone->vertex_count - 1; i < zone->vertex_count; j = i++) {
+            heatmap_outline_line(v, heatmap_to_px(p[j].x, h->x0, s), heatmap_to_px(p[j].y, h->y0, s),
+                                 heatmap_to_px(p[i].x, h->x0, s), heatmap_to_px(p[i].y, h->y0, s));
+        }
+    }
+}
+
+void RAM_HOT_FUNC(heatmap_draw)(const heatmap_t *h, const heatmap_view_t *v, ssd1306_t *dev, int32_t cur_x, int32_t cur_y) {
+    // Pixel aceso se media / peak > (b + 0.5) / 16, sem divisões:
+    // 32 * soma > (2b + 1) * peak * células_por_pixel
+    uint32_t n = 1u << v->shift;
+    uint32_t thr[16];
+    for (uint32_t b = 0; b < 16; b++) thr[b] = h->peak ? (2 * b + 1) * h->peak * n * n : UINT32_MAX;
+
+    for (uint32_t page = 0; page < v->h / 8u; page++) {
+        uint8_t *out = &dev->buffer[(v->y / 8 + page) * dev->width + v->x];
+        const uint8_t *outline = &v->outline[page * v->w];
+        for (uint32_t c = 0; c < v->w; c++) {
+            uint8_t byte = outline[c];
+            for (uint32_t bit = 0; bit < 8; bit++) {
+                uint32_t row = page * 8 + bit;
+                uint32_t sum = 0;
+                for (uint32_t dy = 0; dy < n; dy++) {
+                    const uint8_t *cell = &h->cells[row * n + dy][c * n];
+                    for (uint32_t dx = 0; dx < n; dx++) sum += cell[dx];
+                }
+                if (sum * 32 > thr[heatmap_bayer[row & 3][c & 3]]) byte |= (uint8_t)(1u << bit);
+            }
+            out[c] = byte;
+        }
+    }
+
+    // Cursor: cruz acesa com as diagonais apagadas para destacar do fundo
+    uint32_t s = h->cell_shift + v->shift;
+    int32_t px = heatmap_to_px(cur_x, h->x0, s);
+    int32_t py = heatmap_to_px(cur_y, h->y0, s);
+    if (px < 0 || py < 0 || px >= v->w || py >= v->h) return;
+    px += v->x;
+    py += v->y;
+    for (int32_t d = -1; d <= 1; d += 2) {
+        ssd1306_draw_pixel(dev, px + d, py - 1, 0);
+        ssd1306_draw_pixel(dev, px + d, py + 1, 0);
+        ssd1306_draw_pixel(dev, px + d, py, 1);
+        ssd1306_draw_pixel(dev, px, py + d, 1);
+    }
+    ssd1306_draw_pixel(dev, px, py, 1);
+}
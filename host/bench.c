@@ -0,0 +1,138 @@
+#include "bench.h"
+#include "pico_host.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_GIT_REV
+#define BENCH_GIT_REV "unknown"
+#endif
+
+#define BENCH_MAX_RESULTS 64
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    uint64_t iterations;
+    double ns_per_op;
+    double i2c_bytes_per_op;
+    double i2c_transactions_per_op;
+    double uart_tx_bytes_per_op;
+    double uart_rx_bytes_per_op;
+    double stdio_tx_bytes_per_op;
+    double allocs_per_op;
+} bench_result_t;
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static uint64_t min_time_ns = 200u * 1000u * 1000u; // 200 ms por caso
+static const char *current_unit = "op";
+static int check_count = 0, check_failures = 0;
+
+volatile uint32_t bench_sink;
+
+void bench_set_unit(const char *unit) {
+    current_unit = unit;
+}
+
+void bench_run(const char *name, void (*op)(void *ctx), void *ctx) {
+    if (result_count >= BENCH_MAX_RESULTS) {
+        fprintf(stderr, "bench: limite de casos atingido, ignorando %s\n", name);
+        return;
+    }
+
+    // Aquecimento e calibração: dobra as iterações até passar de 1/8 do tempo mínimo
+    uint64_t iterations = 1;
+    for (;;) {
+        uint64_t start = host_time_ns();
+        for (uint64_t i = 0; i < iterations; i++) op(ctx);
+        uint64_t elapsed = host_time_ns() - start;
+        if (elapsed >= min_time_ns / 8 || iterations >= (1ull << 40)) {
+            if (elapsed == 0) elapsed = 1;
+            iterations = iterations * min_time_ns / elapsed;
+            if (iterations == 0) iterations = 1;
+            break;
+        }
+        iterations *= 2;
+    }
+
+    host_stats_reset();
+    uint64_t start = host_time_ns();
+    for (uint64_t i = 0; i < iterations; i++) op(ctx);
+    uint64_t elapsed = host_time_ns() - start;
+    host_bus_stats_t stats = host_stats;
+
+    bench_result_t *r = &results[result_count++];
+    double n = (double)iterations;
+    r->name = name;
+    r->unit = current_unit;
+    r->iterations = iterations;
+    r->ns_per_op = (double)elapsed / n;
+    r->i2c_bytes_per_op = (double)stats.i2c_bytes / n;
+    r->i2c_transactions_per_op = (double)stats.i2c_transactions / n;
+    r->uart_tx_bytes_per_op = (double)stats.uart_tx_bytes / n;
+    r->uart_rx_bytes_per_op = (double)stats.uart_rx_bytes / n;
+    r->stdio_tx_bytes_per_op = (double)stats.stdio_tx_bytes / n;
+    r->allocs_per_op = (double)stats.allocs / n;
+
+    printf("%-36s %12.1f ns/%-8s %9.1f B i2c %7.1f tx i2c %8.1f B uart/usb %6.2f allocs\n",
+           name, r->ns_per_op, r->unit, r->i2c_bytes_per_op, r->i2c_transactions_per_op,
+           r->uart_tx_bytes_per_op + r->uart_rx_bytes_per_op + r->stdio_tx_bytes_per_op,
+           r->allocs_per_op);
+}
+
+const char *bench_check(const char *name, bool ok) {
+    check_count++;
+    if (!ok) {
+        check_failures++;
+        fprintf(stderr, "bench: verificacao %s FALHOU\n", name);
+    }
+    return ok ? "OK" : "FALHOU";
+}
+
+static void write_json(FILE *f) {
+    fprintf(f, "{\n  \"suite\": \"%s\",\n  \"git_rev\": \"%s\",\n  \"results\": [\n",
+            bench_suite_name, BENCH_GIT_REV);
+    for (int i = 0; i < result_count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(f,
+                "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %llu, "
+                "\"ns_per_op\": %.2f, \"i2c_bytes_per_op\": %.2f, "
+                "\"i2c_transactions_per_op\": %.2f, \"uart_tx_bytes_per_op\": %.2f, "
+                "\"uart_rx_bytes_per_op\": %.2f, \"stdio_tx_bytes_per_op\": %.2f, "
+                "\"allocs_per_op\": %.4f}%s\n",
+                r->name, r->unit, (unsigned long long)r->iterations, r->ns_per_op,
+                r->i2c_bytes_per_op, r->i2c_transactions_per_op, r->uart_tx_bytes_per_op,
+                r->uart_rx_bytes_per_op, r->stdio_tx_bytes_per_op, r->allocs_per_op, i + 1 < result_count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            min_time_ns = strtoull(argv[++i], NULL, 10) * 1000000ull;
+        } else {
+            fprintf(stderr, "uso: %s [--json arquivo.json] [--min-ms N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("suite %s (rev %s)\n", bench_suite_name, BENCH_GIT_REV);
+    bench_cases();
+
+    if (json_path) {
+        FILE *f = fopen(json_path, "w");
+        if (!f) {
+            perror(json_path);
+            return 1;
+        }
+        write_json(f);
+        fclose(f);
+    }
+    printf("%d verificacoes, %d falhas\n", check_count, check_failures);
+    return check_failures ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Executa 'op' repetidamente (calibrando o número de iterações até atingir o
+// tempo mínimo configurado) e registra ns/op, tráfego de barramento por
+// operação e alocações por operação.
+void bench_run(const char *name, void (*op)(void *ctx), void *ctx);
+
+// Define o rótulo da unidade contada por operação (ex.: "frame", "sentence").
+// Vale para os próximos bench_run até nova chamada.
+void bench_set_unit(const char *unit);
+
+// Registra o resultado de uma verificação de correção da suíte e devolve
+// "OK" ou "FALHOU" para a linha do relatório. Qualquer falha faz o
+// executável terminar com código 1 (ctest, CI).
+const char *bench_check(const char *name, bool ok);
+
+// Implementada por cada suíte (bench_finalv3.c, bench_projetoreal.c).
+extern const char *const bench_suite_name;
+void bench_cases(void);
+
+// Impede que o compilador elimine resultados não utilizados.
+extern volatile uint32_t bench_sink;
+
+#endif
@@ -0,0 +1,1413 @@
+#include "bench.h"
+#include "buttons.h"
+#include "ssd1306.h"
+#include "tlog.h"
+#include "pico/stdlib.h"
+#include "track.h"
+#include "track_simplify.h"
+#include "flash_sim.h"
+#include "geofence.h"
+#include "heatmap.h"
+#include "fingerprint.h"
+#include "trace.h"
+#include "trace_flash.h"
+#include "bus.h"
+#include "crc.h"
+#include "mirror.h"
+#include "pico_host.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Suíte do firmware de simulação (finalv3.c + ssd1306.c da raiz).
+
+// Declarada apenas em finalv3.c no firmware
+void ssd1306_draw_border(ssd1306_t *dev, int thickness);
+
+#define TEXT_OFFSET 4
+
+const char *const bench_suite_name = "finalv3";
+
+static ssd1306_t display;
+
+typedef struct {
+    uint16_t x, y;
+} joy_sample_t;
+
+// Posições típicas do joystick: centro, quinas e valores fora da área segura
+static const joy_sample_t samples[] = {
+    {2048, 2048}, {2100, 1990}, {650, 2048}, {3400, 3350}, {12, 4095}, {1024, 3072},
+};
+#define SAMPLE_COUNT (sizeof(samples) / sizeof(samples[0]))
+
+static void op_draw_string_alert(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_string(&display, TEXT_OFFSET, TEXT_OFFSET, "ATENCAO");
+}
+
+static void op_draw_string_coords(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_string(&display, TEXT_OFFSET, TEXT_OFFSET + 20, "X:2048 Y:2048");
+}
+
+static void op_draw_border(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_border(&display, 1);
+    bench_sink += display.buffer[0];
+}
+
+static void op_show(void *ctx) {
+    (void)ctx;
+    ssd1306_show(&display);
+}
+
+// Partida do display em finalv3.c: configuração e primeiro quadro
+static void op_boot_display(void *ctx) {
+    (void)ctx;
+    ssd1306_init(&display, i2c1, SSD1306_ADDRESS, SSD1306_WIDTH, SSD1306_HEIGHT);
+    ssd1306_draw_border(&display, 1);
+    ssd1306_show(&display);
+}
+
+// Mesma sequência de display_alert() em finalv3.c
+static void op_alert_screen(void *ctx) {
+    static unsigned i = 0;
+    (void)ctx;
+    const joy_sample_t *s = &samples[i++ % SAMPLE_COUNT];
+    char buffer[32];
+    sprintf(buffer, "X:%d Y:%d", s->x, s->y);
+
+    ssd1306_clear(&display);
+    ssd1306_draw_border(&display, 1);
+    ssd1306_draw_string(&display, TEXT_OFFSET, TEXT_OFFSET, "");
+    ssd1306_draw_string(&display, TEXT_OFFSET, TEXT_OFFSET, "ATENCAO");
+    ssd1306_draw_string(&display, TEXT_OFFSET, TEXT_OFFSET + 20, buffer);
+    ssd1306_show(&display);
+}
+
+// Quadro desenhado no laço principal quando o joystick se move
+static void op_movement_frame(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_border(&display, 1);
+    ssd1306_show(&display);
+}
+
+// Formatação da mensagem serial "GPS - X:%d Y:%d" do laço principal
+static void op_format_gps_message(void *ctx) {
+    static unsigned i = 0;
+    (void)ctx;
+    const joy_sample_t *s = &samples[i++ % SAMPLE_COUNT];
+    char line[48];
+    bench_sink += (uint32_t)snprintf(line, sizeof(line), "GPS - X:%d Y:%d\n", s->x, s->y);
+}
+
+// Caminho completo do printf: formatação + envio byte a byte pela stdio
+static void op_printf_gps_message(void *ctx) {
+    static unsigned i = 0;
+    (void)ctx;
+    const joy_sample_t *s = &samples[i++ % SAMPLE_COUNT];
+    char line[48];
+    int n = snprintf(line, sizeof(line), "GPS - X:%d Y:%d\n", s->x, s->y);
+    for (int c = 0; c < n; c++) putchar_raw(line[c]);
+}
+
+// Mesma mensagem pelo log tokenizado: registro no buffer + envio do quadro
+static void op_tlog_gps_message(void *ctx) {
+    static unsigned i = 0;
+    (void)ctx;
+    const joy_sample_t *s = &samples[i++ % SAMPLE_COUNT];
+    TLOG(TLOG_GPS_POS, s->x, s->y);
+    bench_sink += tlog_drain(0);
+}
+
+// Histórico de posições: um ponto por iteração do laço (1 s de intervalo)
+static track_t track;
+static uint32_t track_uptime_ms;
+
+static void op_track_append(void *ctx) {
+    static unsigned i = 0;
+    (void)ctx;
+    const joy_sample_t *s = &samples[i++ % SAMPLE_COUNT];
+    track_uptime_ms += 1000;
+    track_append(&track, track_uptime_ms, (int16_t)s->x, (int16_t)s->y, 0);
+}
+
+static void op_track_mount(void *ctx) {
+    (void)ctx;
+    track_mount(&track, flash_sim_device(), track_uptime_ms);
+}
+
+static bool track_count(const track_record_t *r, void *ctx) {
+    (void)r;
+    (*(uint32_t *)ctx)++;
+    return true;
+}
+
+static bool track_first_visit(const track_record_t *r, void *ctx) {
+    track_record_t *first = ctx;
+    if (first->t_ms == UINT32_MAX) *first = *r;
+    return true;
+}
+
+// Consulta do último minuto de trajeto
+static void op_track_query_minute(void *ctx) {
+    (void)ctx;
+    uint32_t n = 0;
+    uint32_t now = track_time(&track, track_uptime_ms);
+    track_query(&track, now - 60000, now, track_count, &n);
+    bench_sink += n;
+}
+
+// Verificação do log: pontos com x/y derivados do instante e uma cópia de
+// referência de tudo o que foi acrescentado (e não perdido num corte)
+#define TRACK_REF_MAX 80000
+#define TRACK_REF_PAGES (TRACK_REF_MAX / 4)
+
+static track_record_t track_ref[TRACK_REF_MAX];
+static uint32_t track_ref_count;
+static uint32_t track_ref_page[TRACK_REF_PAGES]; // Índice do primeiro ponto de cada página
+static uint32_t track_ref_pages;
+static uint32_t track_boot_ms; // Tempo desde a última "partida"
+
+static int16_t track_x_of(uint32_t t) {
+    return (int16_t)((t * 2654435761u) >> 21);
+}
+
+static int16_t track_y_of(uint32_t t) {
+    return (int16_t)((t * 40503u) >> 17);
+}
+
+static bool track_ref_append(track_t *t) {
+    track_boot_ms += 1000;
+    uint32_t now = track_time(t, track_boot_ms);
+    uint8_t flags = (uint8_t)(now / 1000 % 5 == 0 ? TRACK_FLAG_RED_ALERT : 0);
+    if (t->pending.header.count == 0) track_ref_page[track_ref_pages++] = track_ref_count;
+    track_ref[track_ref_count++] = (track_record_t){.t_ms = now, .x = track_x_of(now), .y = track_y_of(now), .flags = flags};
+    return track_append(t, track_boot_ms, track_x_of(now), track_y_of(now), flags);
+}
+
+// Queda de energia durante a gravação de uma página: a página pendente é
+// perdida (tira da referência)
+static void track_ref_drop_page(void) {
+    track_ref_count = track_ref_page[--track_ref_pages];
+}
+
+static void track_reboot(track_t *t) {
+    track_boot_ms = 0;
+    track_mount(t, flash_sim_device(), track_boot_ms);
+}
+
+// Primeiro índice da referência com t_ms >= t
+static uint32_t track_ref_lower(uint32_t t) {
+    uint32_t lo = 0, hi = track_ref_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (track_ref[mid].t_ms < t) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+typedef struct {
+    uint32_t next, end; // Próximo índice esperado da referência, fim do intervalo
+    bool ok;
+} track_cmp_t;
+
+static bool track_cmp_visit(const track_record_t *r, void *ctx) {
+    track_cmp_t *c = ctx;
+    const track_record_t *e = &track_ref[c->next];
+    if (c->next >= c->end || r->t_ms != e->t_ms || r->x != e->x || r->y != e->y || r->flags != e->flags) {
+        c->ok = false;
+        return false;
+    }
+    c->next++;
+    return true;
+}
+
+// track_query devolve exatamente os pontos da referência em [t0, t1] que
+// ainda estão no log, em ordem. O que sobrou do log tem de ser um sufixo da
+// referência com ao menos as 'min_pages' páginas mais recentes.
+static bool track_query_check(track_t *t, uint32_t min_pages, uint32_t queries) {
+    track_record_t first = {.t_ms = UINT32_MAX};
+    uint32_t all = track_query(t, 0, UINT32_MAX, track_first_visit, &first);
+    if (all == 0) return track_ref_count == 0;
+    uint32_t oldest = track_ref_lower(first.t_ms);
+    if (all != track_ref_count - oldest) return false;
+    if (min_pages && (track_ref_pages < min_pages || oldest > track_ref_page[track_ref_pages - min_pages]))
+        return false;
+
+    uint32_t rng = 11;
+    for (uint32_t q = 0; q <= queries; q++) {
+        uint32_t t0 = 0, t1 = UINT32_MAX;
+        if (q < queries) {
+            uint32_t span = track_ref_count - oldest;
+            rng = rng * 1664525u + 1013904223u;
+            uint32_t a = oldest + (rng >> 8) % span;
+            rng = rng * 1664525u + 1013904223u;
+            uint32_t b = a + (rng >> 8) % (q % 4 == 0 ? span : 64);
+            if (b >= track_ref_count) b = track_ref_count - 1;
+            // Limites exatos, entre dois pontos ou antes do início do log
+            t0 = track_ref[a].t_ms - (q % 3 == 0 ? 500 : 0);
+            t1 = track_ref[b].t_ms + (q % 5 == 0 ? 500 : 0);
+            if (q % 7 == 0) t0 = 0;
+        }
+        uint32_t lo = track_ref_lower(t0), hi = t1 == UINT32_MAX ? track_ref_count : track_ref_lower(t1 + 1);
+        if (lo < oldest) lo = oldest;
+        track_cmp_t c = {.next = lo, .end = hi, .ok = true};
+        uint32_t n = track_query(t, t0, t1, track_cmp_visit, &c);
+        if (!c.ok || c.next != hi || n != hi - lo) return false;
+    }
+    return true;
+}
+
+// Acrescenta pontos até a página pendente ficar vazia com a próxima gravação
+// no início de um setor (que será apagado) ou fora dele
+static bool track_fill_until(track_t *t, bool sector_start) {
+    do {
+        if (!track_ref_append(t)) return false;
+    } while (t->pending.header.count != 0 || (t->write_page % TRACK_PAGES_PER_SECTOR == 0) != sector_start);
+    return true;
+}
+
+// Trajeto na flash: várias voltas no buffer circular com partidas no meio,
+// rodízio dos apagamentos, consultas por intervalo e quedas de energia no
+// meio da gravação de uma página e no meio do apagamento de um setor
+static bool track_check(uint32_t *erase_min, uint32_t *erase_max) {
+    static track_t t;
+    flash_sim_reset();
+    track_ref_count = track_ref_pages = 0;
+    track_reboot(&t);
+    uint32_t reboot_every = 300 * TRACK_RECORDS_PER_PAGE + 7; // Partidas com a página pela metade
+    for (uint32_t i = 1; i <= 3 * t.page_count * TRACK_RECORDS_PER_PAGE + 100; i++) {
+        if (!track_ref_append(&t)) return false;
+        if (i % reboot_every == 0) {
+            if (!track_flush(&t)) return false;
+            track_reboot(&t);
+        }
+    }
+    const flash_sim_stats_t *fs = flash_sim_stats();
+    *erase_min = UINT32_MAX;
+    *erase_max = 0;
+    for (uint32_t s = 0; s < FLASH_SIM_SECTORS; s++) {
+        if (fs->erase_count[s] < *erase_min) *erase_min = fs->erase_count[s];
+        if (fs->erase_count[s] > *erase_max) *erase_max = fs->erase_count[s];
+    }
+    if (*erase_max - *erase_min > 1 || *erase_min < 3) return false;
+    if (!track_query_check(&t, t.page_count - TRACK_PAGES_PER_SECTOR, 300)) return false;
+
+    // Corte no meio da gravação de uma página (fora do início de um setor)
+    if (!track_fill_until(&t, false)) return false;
+    track_record_t last = track_ref[track_ref_count - 1];
+    flash_sim_cut_power_after(TRACK_PAGE_SIZE / 2);
+    for (uint32_t i = 0; i < TRACK_RECORDS_PER_PAGE - 1; i++)
+        if (!track_ref_append(&t)) return false;
+    if (track_ref_append(&t)) return false; // A página cheia não chega inteira à flash
+    track_ref_drop_page();
+    flash_sim_cut_power_after(0);
+    track_reboot(&t);
+    if (t.last_t != last.t_ms || !track_query_check(&t, 0, 100)) return false;
+    for (uint32_t i = 0; i < 3 * TRACK_RECORDS_PER_PAGE; i++)
+        if (!track_ref_append(&t)) return false;
+    if (!track_query_check(&t, 0, 100)) return false;
+
+    // Corte no meio do apagamento de um setor ainda com dados antigos
+    if (!track_fill_until(&t, true)) return false;
+    last = track_ref[track_ref_count - 1];
+    flash_sim_cut_power_after(TRACK_SECTOR_SIZE / 4 + 100);
+    for (uint32_t i = 0; i < TRACK_RECORDS_PER_PAGE - 1; i++)
+        if (!track_ref_append(&t)) return false;
+    if (track_ref_append(&t)) return false;
+    track_ref_drop_page();
+    flash_sim_cut_power_after(0);
+    track_reboot(&t);
+    if (t.last_t != last.t_ms || t.write_page % TRACK_PAGES_PER_SECTOR != 0 || !track_query_check(&t, 0, 100))
+        return false;
+    // O setor cortado é apagado de novo na próxima gravação
+    for (uint32_t i = 0; i < 2 * TRACK_PAGES_PER_SECTOR * TRACK_RECORDS_PER_PAGE; i++)
+        if (!track_ref_append(&t)) return false;
+    return track_query_check(&t, 0, 100);
+}
+
+// Geofence: passeio aleatório reprodutível pela área de 4096 x 4096
+typedef struct {
+    geofence_t fence;
+    uint32_t rng;
+    int32_t x, y;
+    uint32_t events;
+} geofence_walk_t;
+
+static void walk_step(geofence_walk_t *w) {
+    w->rng = w->rng * 1664525u + 1013904223u;
+    w->x += (int32_t)((w->rng >> 8) % 41) - 20;
+    w->y += (int32_t)((w->rng >> 20) % 41) - 20;
+    if (w->x < 0) w->x = 0;
+    if (w->x > 4095) w->x = 4095;
+    if (w->y < 0) w->y = 0;
+    if (w->y > 4095) w->y = 4095;
+}
+
+static void op_geofence_update(void *ctx) {
+    geofence_walk_t *w = ctx;
+    geofence_event_t events[GEOFENCE_MAX_EVENTS];
+    walk_step(w);
+    w->events += geofence_update(&w->fence, w->x, w->y, events);
+}
+
+// Referência do geofence: varre todas as zonas a cada amostra, sem grade,
+// com o polígono em double e a distância à borda exata (inteiros de 128 bits)
+#define GEOFENCE_REF_ZONES 1024
+
+static bool geofence_ref_inside(const geofence_map_t *m, const geofence_zone_t *z, int32_t x, int32_t y) {
+    const geofence_point_t *v = &m->vertices[z->first_vertex];
+    bool inside = false;
+    for (uint32_t i = 0, j = z->vertex_count - 1; i < z->vertex_count; j = i++) {
+        if ((v[i].y > y) == (v[j].y > y)) continue;
+        double xint = v[i].x + (double)(y - v[i].y) * (v[j].x - v[i].x) / (v[j].y - v[i].y);
+        if (x < xint) inside = !inside;
+    }
+    return inside;
+}
+
+static bool geofence_ref_near(const geofence_map_t *m, const geofence_zone_t *z, int32_t x, int32_t y) {
+    const geofence_point_t *v = &m->vertices[z->first_vertex];
+    __int128 margin2 = (__int128)m->hysteresis * m->hysteresis;
+    for (uint32_t i = 0, j = z->vertex_count - 1; i < z->vertex_count; j = i++) {
+        int64_t ex = v[i].x - v[j].x, ey = v[i].y - v[j].y;
+        int64_t px = x - v[j].x, py = y - v[j].y;
+        int64_t len2 = ex * ex + ey * ey, dot = px * ex + py * ey;
+        if (len2 != 0 && dot > 0 && dot < len2) {
+            __int128 cross = (__int128)px * ey - (__int128)py * ex;
+            if (cross * cross < margin2 * len2) return true;
+        } else {
+            int64_t dx = dot <= 0 || len2 == 0 ? px : x - v[i].x;
+            int64_t dy = dot <= 0 || len2 == 0 ? py : y - v[i].y;
+            if (dx * dx + dy * dy < margin2) return true;
+        }
+    }
+    return false;
+}
+
+static int geofence_event_cmp(const void *a, const void *b) {
+    const geofence_event_t *ea = a, *eb = b;
+    if (ea->zone != eb->zone) return ea->zone < eb->zone ? -1 : 1;
+    return (int)ea->type - (int)eb->type;
+}
+
+// Passeio aleatório em 'map' comparando, amostra a amostra, os eventos de
+// entrada/saída (com a ação da zona), as zonas ativas e a zona de maior
+// prioridade com a referência. Também confere que a histerese segurou
+// eventos: sem ela, o mesmo passeio gera mais trocas.
+static bool geofence_check(const geofence_map_t *map, uint32_t steps, uint32_t *events_out,
+                           uint32_t *events_no_hyst) {
+    static bool ref_active[GEOFENCE_REF_ZONES], raw_inside[GEOFENCE_REF_ZONES];
+    geofence_walk_t w = {.rng = 7, .x = 2048, .y = 2048};
+    geofence_event_t got[GEOFENCE_MAX_EVENTS], want[GEOFENCE_REF_ZONES];
+    uint32_t ref_count = 0;
+
+    if (map->zone_count > GEOFENCE_REF_ZONES) return false;
+    memset(ref_active, 0, sizeof(ref_active));
+    memset(raw_inside, 0, sizeof(raw_inside));
+    geofence_init(&w.fence, map);
+    *events_out = *events_no_hyst = 0;
+    for (uint32_t s = 0; s < steps; s++) {
+        walk_step(&w);
+        uint32_t n = geofence_update(&w.fence, w.x, w.y, got);
+
+        uint32_t m = 0;
+        for (uint16_t zone = 0; zone < map->zone_count; zone++) {
+            const geofence_zone_t *z = &map->zones[zone];
+            bool inside = geofence_ref_inside(map, z, w.x, w.y);
+            if (inside != raw_inside[zone]) (*events_no_hyst)++;
+            raw_inside[zone] = inside;
+            if (ref_active[zone] && !inside && !geofence_ref_near(map, z, w.x, w.y)) {
+                ref_active[zone] = false;
+                ref_count--;
+                want[m++] = (geofence_event_t){zone, GEOFENCE_EXIT, z->action};
+            } else if (!ref_active[zone] && inside) {
+                ref_active[zone] = true;
+                ref_count++;
+                want[m++] = (geofence_event_t){zone, GEOFENCE_ENTER, z->action};
+            }
+        }
+        // Acima do limite, o motor descarta entradas por ordem da grade
+        if (ref_count > GEOFENCE_MAX_ACTIVE || n != m) return false;
+        qsort(got, n, sizeof(got[0]), geofence_event_cmp);
+        for (uint32_t i = 0; i < n; i++) {
+            if (got[i].zone != want[i].zone || got[i].type != want[i].type || got[i].action != want[i].action)
+                return false;
+        }
+        *events_out += n;
+
+        if (w.fence.active_count != ref_count) return false;
+        int best = -1;
+        for (uint32_t i = 0; i < w.fence.active_count; i++) {
+            if (!ref_active[w.fence.active[i]]) return false;
+            best = best > map->zones[w.fence.active[i]].priority ? best : map->zones[w.fence.active[i]].priority;
+        }
+        uint16_t top = geofence_top_zone(&w.fence);
+        if (best < 0 ? top != GEOFENCE_NO_ZONE
+                     : top == GEOFENCE_NO_ZONE || map->zones[top].priority != best ||
+                           geofence_action(&w.fence) != (geofence_action_t)map->zones[top].action)
+            return false;
+    }
+    return *events_out > 0 && *events_out < *events_no_hyst;
+}
+
+// Mapa de permanência: amostras a cada 500 ms (laço com alerta ativo)
+static heatmap_t heat;
+static heatmap_view_t heat_view;
+
+static void op_heatmap_dwell(void *ctx) {
+    geofence_walk_t *w = ctx;
+    walk_step(w);
+    heatmap_dwell(&heat, w->x, w->y, 500);
+}
+
+// Minimapa completo (grade reduzida, pontilhado, contornos e cursor), sem envio
+static void op_heatmap_draw(void *ctx) {
+    geofence_walk_t *w = ctx;
+    heatmap_draw(&heat, &heat_view, &display, w->x, w->y);
+    bench_sink += display.buffer[64];
+}
+
+// Referências escalares do mapa de permanência
+static uint8_t heat_ref_decay(uint8_t v) {
+    return (uint8_t)(v - (v + 7) / 8);
+}
+
+// Limiar do Bayer 4x4 pela construção recursiva a partir do 2x2
+static uint32_t heat_ref_bayer(uint32_t y, uint32_t x) {
+    static const uint8_t m2[2][2] = {{0, 2}, {3, 1}};
+    return 4u * m2[y & 1][x & 1] + m2[(y >> 1) & 1][(x >> 1) & 1];
+}
+
+// Minimapa sem contornos e com o cursor fora da vista: pixel aceso se a
+// média das células dividida pelo pico passa de (limiar + 0.5) / 16
+static bool heat_ref_draw_check(const heatmap_t *h, uint8_t shift) {
+    static heatmap_view_t v;
+    heatmap_view_init(&v, h, 32, 0, shift, NULL);
+    memset(display.buffer, 0, sizeof(display.buffer));
+    heatmap_draw(h, &v, &display, -100000, -100000);
+    uint32_t n = 1u << shift;
+    for (uint32_t y = 0; y < SSD1306_HEIGHT; y++) {
+        for (uint32_t x = 0; x < SSD1306_WIDTH; x++) {
+            bool want = false;
+            if (x >= v.x && x < v.x + v.w && y < v.h && h->peak) {
+                uint32_t sum = 0;
+                for (uint32_t dy = 0; dy < n; dy++)
+                    for (uint32_t dx = 0; dx < n; dx++) sum += h->cells[y * n + dy][(x - v.x) * n + dx];
+                double level = (double)sum / (n * n) / h->peak;
+                want = level > (heat_ref_bayer(y, x - v.x) + 0.5) / 16.0;
+            }
+            bool got = (display.buffer[(y / 8) * display.width + x] >> (y % 8)) & 1;
+            if (got != want) return false;
+        }
+    }
+    return true;
+}
+
+// Decaimento de todos os 256 valores em todas as posições da palavra (e com
+// todos os vizinhos de palavra ao longo da grade), saturação do contador e
+// pontilhado, contra as referências escalares
+static bool heatmap_check(void) {
+    static heatmap_t h;
+    static uint8_t before[HEATMAP_ROWS][HEATMAP_COLS];
+    heatmap_init(&h, 0, 0, 5);
+    for (uint32_t r = 0; r < HEATMAP_ROWS; r++)
+        for (uint32_t c = 0; c < HEATMAP_COLS; c++) h.cells[r][c] = (uint8_t)(c * 3 + r * 37 + (r >> 3));
+    h.peak = 255;
+    memcpy(before, h.cells, sizeof(before));
+
+    // Uma passada completa (fora da grade: só decai)
+    uint32_t step_ms = HEATMAP_DECAY_PERIOD_MS * HEATMAP_DECAY_MAX_ROWS / HEATMAP_ROWS;
+    for (uint32_t i = 0; i < HEATMAP_ROWS / HEATMAP_DECAY_MAX_ROWS; i++) heatmap_dwell(&h, -1, -1, step_ms);
+    bool seen[256] = {false};
+    for (uint32_t r = 0; r < HEATMAP_ROWS; r++) {
+        for (uint32_t c = 0; c < HEATMAP_COLS; c++) {
+            if (h.cells[r][c] != heat_ref_decay(before[r][c])) return false;
+            seen[before[r][c]] = true;
+        }
+    }
+    for (uint32_t v = 0; v < 256; v++)
+        if (!seen[v]) return false;
+    if (h.peak != heat_ref_decay(255) || h.decay_row != 0) return false;
+
+    // O arredondamento para cima zera qualquer contador (v = 1 decai para 0):
+    // 255 leva 31 passadas
+    for (uint32_t i = 0; i < 31 * HEATMAP_ROWS / HEATMAP_DECAY_MAX_ROWS; i++) heatmap_dwell(&h, -1, -1, step_ms);
+    for (uint32_t r = 0; r < HEATMAP_ROWS; r++)
+        for (uint32_t c = 0; c < HEATMAP_COLS; c++)
+            if (h.cells[r][c]) return false;
+
+    // Permanência numa célula com intervalos aleatórios: soma com resto,
+    // satura em 255 e decai quando a passada chega à sua linha
+    heatmap_init(&h, 0, 0, 5);
+    uint32_t rng = 3, ref = 0, ref_acc = 0, cx = 77, cy = 45, saturated = 0;
+    for (uint32_t i = 0; i < 20000; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        uint32_t dt = (rng >> 8) % (i % 1000 < 500 ? 20000 : 400);
+        uint32_t row = h.decay_row;
+        heatmap_dwell(&h, (int32_t)(cx << 5) + 3, (int32_t)(cy << 5) + 30, dt);
+        ref_acc += dt;
+        ref += ref_acc / HEATMAP_MS_PER_COUNT;
+        ref_acc %= HEATMAP_MS_PER_COUNT;
+        if (ref >= 255) {
+            ref = 255;
+            saturated++;
+        }
+        for (; row != h.decay_row; row = (row + 1) % HEATMAP_ROWS)
+            if (row == cy) ref = heat_ref_decay((uint8_t)ref);
+        if (h.cells[cy][cx] != ref) return false;
+    }
+    if (!saturated) return false;
+
+    // Pontilhado com a grade cheia de valores sorteados, dois tamanhos de pixel
+    for (uint32_t r = 0; r < HEATMAP_ROWS; r++) {
+        for (uint32_t c = 0; c < HEATMAP_COLS; c++) {
+            rng = rng * 1664525u + 1013904223u;
+            h.cells[r][c] = (uint8_t)((rng >> 24) * (r + c) / (HEATMAP_ROWS + HEATMAP_COLS));
+        }
+    }
+    h.peak = 200;
+    if (!heat_ref_draw_check(&h, 1) || !heat_ref_draw_check(&h, 2)) return false;
+    h.peak = 0;
+    return heat_ref_draw_check(&h, 1);
+}
+
+// Mesma sequência de draw_minimap() em finalv3.c
+static void op_minimap_screen(void *ctx) {
+    geofence_walk_t *w = ctx;
+    memset(display.buffer, 0, sizeof(display.buffer));
+    heatmap_draw(&heat, &heat_view, &display, w->x, w->y);
+    ssd1306_show(&display);
+}
+
+// Localização por RSSI: fonte sintética que sorteia um ponto de referência
+// e devolve os beacons ouvidos nele com ruído de +-4 dB
+typedef struct {
+    const fp_db_t *db;
+    uint32_t rng;
+    int32_t true_x, true_y;
+    double err_sum, conf_sum, compared_sum;
+    uint32_t estimates;
+} fp_synth_t;
+
+static bool fp_synth_poll(void *ctx, fp_scan_t *scan) {
+    fp_synth_t *s = ctx;
+    s->rng = s->rng * 1664525u + 1013904223u;
+    uint32_t p = (s->rng >> 8) % s->db->point_count;
+    const int8_t *row = &s->db->rssi[p * s->db->ap_count];
+    s->true_x = s->db->pos[p * 2];
+    s->true_y = s->db->pos[p * 2 + 1];
+    scan->count = 0;
+    for (uint32_t a = 0; a < s->db->ap_count && scan->count < FP_SCAN_MAX; a++) {
+        if (row[a] <= FP_RSSI_FLOOR + 5) continue;
+        s->rng = s->rng * 1664525u + 1013904223u;
+        scan->ap[scan->count].id = s->db->aps[a];
+        scan->ap[scan->count].rssi = (int8_t)(row[a] + (int32_t)((s->rng >> 24) % 9) - 4);
+        scan->count++;
+    }
+    return true;
+}
+
+static void op_fp_locate(void *ctx) {
+    fp_synth_t *s = ctx;
+    fp_source_t src = {fp_synth_poll, s};
+    fp_estimate_t est;
+    if (fp_update(&src, s->db, &est)) {
+        s->err_sum += hypot(est.x - s->true_x, est.y - s->true_y);
+        s->conf_sum += est.confidence;
+        s->compared_sum += est.compared;
+        s->estimates++;
+    }
+}
+
+// Referência da localização: compara a varredura com todos os pontos da base
+// (sem índice) e pondera os FP_K mais próximos por 1 / (d^2 + 1)
+static void fp_ref_locate(const fp_db_t *db, const fp_scan_t *scan, double *x, double *y) {
+    int32_t q[FP_MAX_APS];
+    for (uint32_t a = 0; a < db->ap_count; a++) q[a] = FP_RSSI_FLOOR;
+    for (uint32_t i = 0; i < scan->count; i++) {
+        for (uint32_t a = 0; a < db->ap_count; a++) {
+            if (memcmp(db->aps[a].id, scan->ap[i].id.id, sizeof(scan->ap[i].id.id)) != 0) continue;
+            int32_t r = scan->ap[i].rssi;
+            r = r < FP_RSSI_FLOOR ? FP_RSSI_FLOOR : r > FP_RSSI_CEIL ? FP_RSSI_CEIL : r;
+            if (r > q[a]) q[a] = r;
+        }
+    }
+    uint32_t best_d2[FP_K], best_p[FP_K], found = 0;
+    for (uint32_t p = 0; p < db->point_count; p++) {
+        uint32_t d2 = 0;
+        for (uint32_t a = 0; a < db->ap_count; a++) {
+            int32_t diff = q[a] - db->rssi[p * db->ap_count + a];
+            d2 += (uint32_t)(diff * diff);
+        }
+        if (found == FP_K && d2 >= best_d2[FP_K - 1]) continue;
+        uint32_t i = found < FP_K ? found++ : FP_K - 1;
+        for (; i > 0 && best_d2[i - 1] > d2; i--) {
+            best_d2[i] = best_d2[i - 1];
+            best_p[i] = best_p[i - 1];
+        }
+        best_d2[i] = d2;
+        best_p[i] = p;
+    }
+    double wsum = 0, xs = 0, ys = 0;
+    for (uint32_t i = 0; i < found; i++) {
+        double w = 1.0 / (best_d2[i] + 1.0);
+        wsum += w;
+        xs += w * db->pos[best_p[i] * 2];
+        ys += w * db->pos[best_p[i] * 2 + 1];
+    }
+    *x = xs / wsum;
+    *y = ys / wsum;
+}
+
+// Varreduras sintéticas com a posição verdadeira conhecida: o índice grosso
+// tem de comparar no máximo um quarto da base (em média, e metade no pior
+// caso) e errar no máximo 25% a mais que a busca completa, com confiança
+// média de ao menos 30
+static bool fp_check(const fp_db_t *db, uint32_t scans, double *err, double *ref_err, double *compared) {
+    fp_synth_t s = {.db = db, .rng = 11};
+    uint32_t max_compared = 0, located = 0;
+    double err_sum = 0, ref_sum = 0, conf_sum = 0, compared_sum = 0;
+    for (uint32_t i = 0; i < scans; i++) {
+        fp_scan_t scan;
+        fp_estimate_t est;
+        fp_synth_poll(&s, &scan);
+        if (!fp_locate(db, &scan, &est)) continue;
+        double rx, ry;
+        fp_ref_locate(db, &scan, &rx, &ry);
+        located++;
+        err_sum += hypot(est.x - s.true_x, est.y - s.true_y);
+        ref_sum += hypot(rx - s.true_x, ry - s.true_y);
+        conf_sum += est.confidence;
+        compared_sum += est.compared;
+        if (est.compared > max_compared) max_compared = est.compared;
+    }
+    if (located < scans * 9 / 10) return false;
+    *err = err_sum / located;
+    *ref_err = ref_sum / located;
+    *compared = compared_sum / located;
+    return *err <= *ref_err * 1.25 && *compared <= db->point_count / 4.0 && max_compared <= db->point_count / 2u &&
+           conf_sum / located >= 30;
+}
+
+// Gravação de entradas: amostras do joystick (passeio aleatório) codificadas
+// no anel e drenadas para um buffer em RAM reaproveitado quando enche
+static uint8_t trace_buf[64 * 1024];
+static trace_ram_t trace_ram;
+static trace_sink_t trace_ram_sink;
+
+static void op_trace_record(void *ctx) {
+    geofence_walk_t *w = ctx;
+    walk_step(w);
+    trace_sample(TRACE_CH_JOYSTICK, w->x, w->y, 0);
+    if (trace_drain(&trace_ram_sink, 0) == 0) trace_ram.used = 0; // Buffer cheio: recomeça
+}
+
+static void op_trace_decode(void *ctx) {
+    trace_reader_t *r = ctx;
+    trace_event_t ev;
+    if (!trace_next(r, &ev)) {
+        trace_reader_init(r, trace_buf, trace_ram.used);
+        trace_next(r, &ev);
+    }
+    bench_sink += (uint32_t)ev.v[0];
+}
+
+#define TRACE_CHECK_BLOCK 1000 // Amostras por bloco (trace_seal) nas verificações
+
+// Grava 'n' amostras do passeio a partir de 'w' e confere a decodificação,
+// com todos os blocos conferidos pelo CRC
+static bool trace_roundtrip(geofence_walk_t *w, uint32_t n, double *bytes_per_sample) {
+    geofence_walk_t check = *w;
+    trace_force_key();
+    trace_sink_ram(&trace_ram_sink, &trace_ram, trace_buf, sizeof(trace_buf));
+    for (uint32_t i = 0; i < n; i++) {
+        walk_step(w);
+        trace_sample(TRACE_CH_JOYSTICK, w->x, w->y, 0);
+        if ((i + 1) % TRACE_CHECK_BLOCK == 0) trace_seal(); // Vários blocos, mesmo numa gravação curta
+        trace_drain(&trace_ram_sink, 0);
+    }
+    *bytes_per_sample = (double)trace_ram.used / n;
+
+    trace_reader_t r;
+    trace_event_t ev;
+    uint32_t decoded = 0;
+    trace_reader_init(&r, trace_buf, trace_ram.used);
+    while (trace_next(&r, &ev)) {
+        walk_step(&check);
+        if (ev.ch != TRACE_CH_JOYSTICK || ev.v[0] != check.x || ev.v[1] != check.y) return false;
+        decoded++;
+    }
+    return decoded == n && r.errors == 0 && r.crc_errors == 0 && r.unverified == 0;
+}
+
+// Um bit trocado num valor do meio da gravação: o registro continua válido,
+// então só o CRC pega. O bloco dele some inteiro e os demais saem intactos.
+static bool trace_corrupt_check(geofence_walk_t start, uint32_t n) {
+    static uint8_t copy[sizeof(trace_buf)];
+    static const uint8_t magic[4] = {TRACE_TAG_KEY, 'T', 'R', 'C'};
+    memcpy(copy, trace_buf, trace_ram.used);
+    uint32_t k = trace_ram.used / 2;
+    while (k + 16 < trace_ram.used && memcmp(&copy[k], magic, sizeof(magic)) != 0) k++;
+    if (k + 16 >= trace_ram.used) return false;
+    copy[k + 11 + 2] ^= 0x02; // Chave (11 B), canal e dt: primeiro valor da amostra
+
+    trace_reader_t r;
+    trace_event_t ev;
+    uint32_t decoded = 0, skipped = 0, i = 0;
+    trace_reader_init(&r, copy, trace_ram.used);
+    while (trace_next(&r, &ev)) {
+        // Cada evento tem que ser o próximo da caminhada ou vir depois do bloco descartado
+        walk_step(&start);
+        i++;
+        while (ev.v[0] != start.x || ev.v[1] != start.y) {
+            if (i == n) return false;
+            walk_step(&start);
+            i++;
+            skipped++;
+        }
+        decoded++;
+    }
+    return r.crc_errors == 1 && r.errors == 0 && skipped > 0 && skipped <= TRACE_CHECK_BLOCK &&
+           decoded + skipped == n;
+}
+
+// Gravação na flash simulada (trace_flash.h): enche a região inteira, com
+// uma página completada por trace_flash_flush no meio, lê a imagem de volta
+// com trace_reader (pulando o 0xFF) e confere as amostras em ordem
+static bool trace_flash_check(uint32_t *samples) {
+    static trace_flash_t tf;
+    static uint8_t image[FLASH_SIM_SECTORS * TRACK_SECTOR_SIZE];
+    const track_flash_t *dev = flash_sim_device();
+    geofence_walk_t w = {.rng = 5, .x = 2048, .y = 2048}, check = w;
+    trace_sink_t sink;
+
+    trace_sink_ram(&trace_ram_sink, &trace_ram, trace_buf, sizeof(trace_buf));
+    trace_drain(&trace_ram_sink, 0); // Nada pendente de antes
+    flash_sim_reset();
+    trace_sink_flash(&sink, &tf, dev);
+    trace_force_key();
+    uint32_t n = 0;
+    bool padded = false;
+    while (tf.offset < dev->size) {
+        walk_step(&w);
+        trace_sample(TRACE_CH_JOYSTICK, w.x, w.y, 0);
+        n++;
+        trace_drain(&sink, 0);
+        if (n == 1000) {
+            padded = tf.fill != 0;
+            if (!trace_flash_flush(&tf)) return false;
+        }
+    }
+    // O que não coube fica no anel: descarta
+    trace_drain(&trace_ram_sink, 0);
+    trace_force_key();
+
+    dev->read(0, image, dev->size);
+    trace_reader_t r;
+    trace_event_t ev;
+    uint32_t decoded = 0;
+    trace_reader_init(&r, image, dev->size);
+    while (trace_next(&r, &ev)) {
+        walk_step(&check);
+        if (ev.ch != TRACE_CH_JOYSTICK || ev.v[0] != check.x || ev.v[1] != check.y) return false;
+        decoded++;
+    }
+    *samples = decoded;
+    // Só o último registro pode ter sido cortado pelo fim da região
+    return padded && decoded + 1 >= n && r.errors <= 1 && r.crc_errors == 0 && trace_flash_flush(&tf);
+}
+
+// Simplificação do trajeto: caminhada em trechos retos (rumo novo a cada 40
+// amostras) com ruído de +-4 unidades, como o joystick parado num rumo
+#define SIMPLIFY_TOLERANCE 48
+#define SIMPLIFY_WINDOW 30
+
+typedef struct {
+    uint32_t rng;
+    int32_t x, y, dx, dy;
+    uint32_t i;
+} leg_walk_t;
+
+static void leg_step(leg_walk_t *w, int16_t *x, int16_t *y) {
+    if (w->i++ % 40 == 0) {
+        w->rng = w->rng * 1664525u + 1013904223u;
+        w->dx = (int32_t)((w->rng >> 8) % 33) - 16;
+        w->dy = (int32_t)((w->rng >> 20) % 33) - 16;
+    }
+    w->x += w->dx;
+    w->y += w->dy;
+    if (w->x < 0 || w->x > 4095) w->dx = -w->dx, w->x += 2 * w->dx;
+    if (w->y < 0 || w->y > 4095) w->dy = -w->dy, w->y += 2 * w->dy;
+    w->rng = w->rng * 1664525u + 1013904223u;
+    *x = (int16_t)(w->x + (int32_t)((w->rng >> 12) % 9) - 4);
+    *y = (int16_t)(w->y + (int32_t)((w->rng >> 24) % 9) - 4);
+}
+
+static track_simplify_t simp;
+static leg_walk_t leg;
+
+static void op_track_simplify(void *ctx) {
+    (void)ctx;
+    int16_t x, y;
+    track_record_t kept[TRACK_SIMPLIFY_MAX_OUT];
+    leg_step(&leg, &x, &y);
+    bench_sink += track_simplify_push(&simp, leg.i, x, y, 0, kept);
+}
+
+static double seg_dist(const track_record_t *a, const track_record_t *b, int16_t x, int16_t y) {
+    double dx = b->x - a->x, dy = b->y - a->y, vx = x - a->x, vy = y - a->y;
+    double len2 = dx * dx + dy * dy, t = len2 > 0 ? (vx * dx + vy * dy) / len2 : 0;
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+    return hypot(vx - t * dx, vy - t * dy);
+}
+
+// Simplifica 'n' amostras, com alertas num trecho, e confere que toda
+// amostra descartada está dentro da tolerância e todo alerta foi mantido
+static bool simplify_check(uint32_t n, double *ratio, double *max_err) {
+    static int16_t xs[20000], ys[20000];
+    static uint8_t fl[20000];
+    static track_record_t out[20000];
+    uint32_t m = 0;
+    leg_walk_t w = {.rng = 7, .x = 2048, .y = 2048};
+    track_simplify_t s;
+    track_simplify_init(&s, SIMPLIFY_TOLERANCE, SIMPLIFY_WINDOW);
+    for (uint32_t i = 0; i < n; i++) {
+        leg_step(&w, &xs[i], &ys[i]);
+        fl[i] = (i >= n / 2 && i < n / 2 + 50) ? TRACK_FLAG_RED_ALERT : 0;
+        m += track_simplify_push(&s, i, xs[i], ys[i], fl[i], &out[m]);
+    }
+    m += track_simplify_flush(&s, &out[m]);
+    *ratio = (double)n / m;
+    *max_err = 0;
+    uint32_t seg = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        while (seg + 1 < m && out[seg + 1].t_ms <= i) seg++;
+        if (out[seg].t_ms == i) {
+            if (out[seg].x != xs[i] || out[seg].y != ys[i]) return false;
+            continue;
+        }
+        if (fl[i] || seg + 1 >= m) return false; // Alerta descartado ou amostra depois do último ponto
+        double e = seg_dist(&out[seg], &out[seg + 1], xs[i], ys[i]);
+        if (e > *max_err) *max_err = e;
+    }
+    return *max_err <= SIMPLIFY_TOLERANCE && s.points_out == m;
+}
+
+// Barramento: uma posição publicada e lida pelos consumidores do laço de
+// finalv3.c (um que lê todas as amostras e um que só quer a mais recente)
+static bus_sub_t bus_all, bus_last;
+
+static void op_bus_fanout(void *ctx) {
+    geofence_walk_t *w = ctx;
+    walk_step(w);
+    bus_position_t *p = bus_claim(BUS_POSITION);
+    p->x = w->x;
+    p->y = w->y;
+    p->source = BUS_SRC_JOYSTICK;
+    bus_publish(BUS_POSITION, time_us_64());
+
+    const bus_position_t *q;
+    uint64_t t;
+    while ((q = bus_peek(&bus_all, &t))) {
+        bench_sink += q->x;
+        bus_release(&bus_all);
+    }
+    if ((q = bus_latest(&bus_last, &t))) {
+        bench_sink += q->y;
+        bus_release(&bus_last);
+    }
+}
+
+// Um consumidor que lê uma vez a cada 'period' publicações perde exatamente
+// as que não cabem no buffer; os demais não perdem nenhuma
+static bool bus_overrun_check(uint32_t period, uint32_t rounds) {
+    bus_sub_t slow, fast;
+    bus_subscribe(&slow, BUS_POSITION);
+    bus_subscribe(&fast, BUS_POSITION);
+    uint32_t depth = 8, seen = 0;
+    for (uint32_t i = 0; i < period * rounds; i++) {
+        bus_position_t *p = bus_claim(BUS_POSITION);
+        p->x = (uint16_t)i;
+        bus_publish(BUS_POSITION, time_us_64());
+        while (bus_peek(&fast, NULL)) bus_release(&fast);
+        if ((i + 1) % period == 0) {
+            const bus_position_t *q;
+            uint32_t expect = i + 1 - depth;
+            while ((q = bus_peek(&slow, NULL))) {
+                if (q->x != (uint16_t)expect++) return false;
+                bus_release(&slow);
+                seen++;
+            }
+        }
+    }
+    return fast.lost == 0 && fast.read == period * rounds && seen == depth * rounds &&
+           slow.lost == (period - depth) * rounds;
+}
+
+// CRC: página do trajeto (crc32) e quadro do rádio copiado para o buffer
+// do DMA (crc16_ccitt_copy), as duas chamadas do firmware
+static uint8_t crc_buf[TRACK_PAGE_SIZE], crc_dst[TRACK_PAGE_SIZE];
+
+static void op_crc32_page(void *ctx) {
+    (void)ctx;
+    crc_buf[0]++;
+    bench_sink += crc32(crc_buf, TRACK_PAGE_SIZE);
+}
+
+static void op_crc16_frame(void *ctx) {
+    (void)ctx;
+    crc_buf[0]++;
+    bench_sink += crc16_ccitt_copy(crc_dst, crc_buf, 80, CRC16_CCITT_INIT);
+}
+
+// Referências bit a bit, direto da definição dos polinômios
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+    }
+    return crc;
+}
+
+static uint16_t crc16_bitwise(uint16_t crc, const uint8_t *p, size_t len) {
+    while (len--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (int k = 0; k < 8; k++) crc = (uint16_t)((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+    }
+    return crc;
+}
+
+// Conformidade das tabelas de crc.c: valores de referência, tamanhos e
+// alinhamentos variados, cálculo em partes e as cópias
+static bool crc_check(void) {
+    static const char check[] = "123456789";
+    if (crc32(check, 9) != 0xCBF43926u) return false;
+    if (crc16_ccitt_update(CRC16_CCITT_INIT, check, 9) != 0x29B1) return false;
+    uint32_t rng = 1;
+    for (uint32_t i = 0; i < sizeof(crc_buf); i++) {
+        rng = rng * 1664525u + 1013904223u;
+        crc_buf[i] = (uint8_t)(rng >> 24);
+    }
+    for (uint32_t len = 0; len + 3 <= sizeof(crc_buf); len += 1 + len / 8) {
+        for (uint32_t off = 0; off < 4; off++) {
+            const uint8_t *d = &crc_buf[off];
+            uint32_t c32 = crc32_bitwise(CRC32_INIT, d, len);
+            uint16_t c16 = crc16_bitwise(CRC16_CCITT_INIT, d, len);
+            if (crc32_update(CRC32_INIT, d, len) != c32 || crc16_ccitt_update(CRC16_CCITT_INIT, d, len) != c16)
+                return false;
+            uint32_t half = len / 2;
+            if (crc32_update(crc32_update(CRC32_INIT, d, half), d + half, len - half) != c32) return false;
+            memset(crc_dst, 0, sizeof(crc_dst));
+            if (crc16_ccitt_copy(crc_dst, d, len, CRC16_CCITT_INIT) != c16 || memcmp(crc_dst, d, len) != 0)
+                return false;
+            if (crc32_copy(crc_dst, d, len, CRC32_INIT) != c32) return false;
+        }
+    }
+    return true;
+}
+
+// Gestos dos botões: bordas sintéticas (com ruído) na PIO simulada, no
+// relógio dos alarmes. Cada evento é conferido em tipo, borda de início,
+// duração e instante de entrega, em ms relativos ao início do cenário. Um
+// passo sem pino liga (ou desliga) a máscara de interrupções, como uma
+// gravação na flash: os instantes devem continuar os das bordas.
+#define GESTURE_PIN_A 5
+#define GESTURE_PIN_B 6
+#define GESTURE_MAX_STEPS 12
+#define GESTURE_MAX_EVENTS 8
+
+typedef struct {
+    uint32_t ms;
+    uint8_t gpio; // 0 = máscara de interrupções
+    bool pressed;
+} gesture_step_t;
+
+typedef struct {
+    uint8_t gpio, gesture;
+    uint32_t t_ms, duration_ms, at_ms;
+} gesture_event_t;
+
+typedef struct {
+    const char *name;
+    gesture_step_t steps[GESTURE_MAX_STEPS];
+    gesture_event_t events[GESTURE_MAX_EVENTS];
+} gesture_case_t;
+
+#define GA GESTURE_PIN_A
+#define GB GESTURE_PIN_B
+
+// Janela de 10 ms, intervalo de 400 ms e longa de 1000 ms (padrões)
+static const gesture_case_t gesture_cases[] = {
+    {"simples",
+     {{0, GA, true}, {500, GA, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10}, {GA, BUTTON_SINGLE, 0, 500, 900}}},
+    {"ruido",
+     {{0, GA, true}, {3, GA, false}, {5, GA, true}, {6, GA, false}, {8, GA, true},
+      {600, GA, false}, {601, GA, true}, {603, GA, false}},
+     {{GA, BUTTON_PRESS, 8, 0, 18}, {GA, BUTTON_SINGLE, 8, 595, 1003}}},
+    {"pulso_curto", {{0, GA, true}, {5, GA, false}}, {{0}}},
+    {"duplo",
+     {{0, GA, true}, {100, GA, false}, {250, GA, true}, {350, GA, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10}, {GA, BUTTON_PRESS, 250, 0, 260}, {GA, BUTTON_DOUBLE, 0, 350, 750}}},
+    {"triplo",
+     {{0, GB, true}, {100, GB, false}, {200, GB, true}, {300, GB, false}, {400, GB, true}, {500, GB, false}},
+     {{GB, BUTTON_PRESS, 0, 0, 10},
+      {GB, BUTTON_PRESS, 200, 0, 210},
+      {GB, BUTTON_PRESS, 400, 0, 410},
+      {GB, BUTTON_TRIPLE, 0, 500, 510}}},
+    {"longa",
+     {{0, GA, true}, {1500, GA, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10}, {GA, BUTTON_LONG, 0, 1000, 1000}}},
+    {"intervalo_excedido",
+     {{0, GA, true}, {100, GA, false}, {600, GA, true}, {700, GA, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10},
+      {GA, BUTTON_SINGLE, 0, 100, 500},
+      {GA, BUTTON_PRESS, 600, 0, 610},
+      {GA, BUTTON_SINGLE, 600, 100, 1100}}},
+    {"dois_botoes",
+     {{0, GA, true}, {50, GB, true}, {100, GA, false}, {150, GB, false}, {250, GB, true}, {350, GB, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10},
+      {GB, BUTTON_PRESS, 50, 0, 60},
+      {GB, BUTTON_PRESS, 250, 0, 260},
+      {GA, BUTTON_SINGLE, 0, 100, 500},
+      {GB, BUTTON_DOUBLE, 50, 300, 750}}},
+    {"longa_na_segunda",
+     {{0, GA, true}, {100, GA, false}, {300, GA, true}, {2000, GA, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 10}, {GA, BUTTON_PRESS, 300, 0, 310}, {GA, BUTTON_LONG, 0, 1300, 1300}}},
+    // Interrupção atendida com atraso (máscara de 300 ms, como um apagamento)
+    {"atrasada",
+     {{0, 0, true}, {0, GA, true}, {100, GA, false}, {300, 0, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 300}, {GA, BUTTON_SINGLE, 0, 100, 500}}},
+    {"atrasada_duplo",
+     {{0, 0, true}, {0, GA, true}, {100, GA, false}, {300, GA, true}, {400, GA, false}, {700, 0, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 700}, {GA, BUTTON_PRESS, 300, 0, 700}, {GA, BUTTON_DOUBLE, 0, 400, 800}}},
+    {"atrasada_alem_do_intervalo",
+     {{0, 0, true}, {0, GA, true}, {100, GA, false}, {900, 0, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 900}, {GA, BUTTON_SINGLE, 0, 100, 900}}},
+    {"atrasada_longa",
+     {{0, 0, true}, {0, GA, true}, {1200, GA, false}, {1500, 0, false}},
+     {{GA, BUTTON_PRESS, 0, 0, 1500}, {GA, BUTTON_LONG, 0, 1000, 1500}}},
+};
+
+#undef GA
+#undef GB
+
+static gesture_event_t gesture_got[GESTURE_MAX_EVENTS + 1];
+static uint32_t gesture_got_count;
+static uint64_t gesture_base_us;
+
+static void gesture_record(const button_event_t *ev) {
+    if (gesture_got_count > GESTURE_MAX_EVENTS) return;
+    gesture_got[gesture_got_count++] = (gesture_event_t){
+        .gpio = ev->gpio,
+        .gesture = ev->gesture,
+        .t_ms = (ev->t_us - (uint32_t)gesture_base_us) / 1000u,
+        .duration_ms = ev->duration_us / 1000u,
+        .at_ms = (uint32_t)((host_alarm_now_us() - gesture_base_us) / 1000u),
+    };
+}
+
+static bool gesture_run(const gesture_case_t *c) {
+    gesture_got_count = 0;
+    gesture_base_us = host_alarm_now_us();
+    uint32_t at = 0, irq = 0;
+    for (uint32_t i = 0; i < GESTURE_MAX_STEPS; i++) {
+        const gesture_step_t *st = &c->steps[i];
+        if (i && !st->ms && !st->gpio && !st->pressed) break; // Fim dos passos
+        host_alarm_advance_ms(st->ms - at);
+        at = st->ms;
+        if (st->gpio)
+            host_button_set(st->gpio, st->pressed);
+        else if (st->pressed)
+            irq = save_and_disable_interrupts();
+        else
+            restore_interrupts(irq);
+    }
+    host_alarm_advance_ms(3000); // Todos os timeouts vencem
+
+    uint32_t expected = 0;
+    while (expected < GESTURE_MAX_EVENTS && c->events[expected].gpio) expected++;
+    bool ok = gesture_got_count == expected && host_alarm_pending() == 0 && !buttons_is_pressed(GESTURE_PIN_A) &&
+              !buttons_is_pressed(GESTURE_PIN_B);
+    for (uint32_t i = 0; ok && i < expected; i++) {
+        const gesture_event_t *e = &c->events[i], *g = &gesture_got[i];
+        ok = e->gpio == g->gpio && e->gesture == g->gesture && e->t_ms == g->t_ms &&
+             e->duration_ms == g->duration_ms && e->at_ms == g->at_ms;
+    }
+    if (!ok) printf("buttons: cenario '%s' divergiu (%u eventos)\n", c->name, (unsigned)gesture_got_count);
+    return ok;
+}
+
+static bool gestures_check(void) {
+    static const uint pins[] = {GESTURE_PIN_A, GESTURE_PIN_B};
+    static const buttons_config_t config = BUTTONS_CONFIG_DEFAULT;
+    host_time_virtual(true); // time_us_32 no relógio dos alarmes
+    buttons_init(pins, 2, &config, gesture_record);
+    bool ok = true;
+    for (uint32_t i = 0; i < sizeof(gesture_cases) / sizeof(gesture_cases[0]); i++) ok &= gesture_run(&gesture_cases[i]);
+    host_time_virtual(false);
+    return ok;
+}
+
+// Espelho: coordenadas mudando na tela de movimento, como no laço
+// principal. Cada quadro é capturado em ssd1306_show e codificado por inteiro.
+static void op_mirror_coords(void *ctx) {
+    uint32_t *i = ctx;
+    char text[20];
+    snprintf(text, sizeof(text), "X %4u Y %4u", (unsigned)(*i * 37 % 4096), (unsigned)(*i * 91 % 4096));
+    (*i)++;
+    ssd1306_draw_string(&display, TEXT_OFFSET, 24, text);
+    while (mirror_drain(MIRROR_DRAIN_BYTES)) {
+    }
+}
+
+// Decodificador do espelho (o mesmo de tools/mirror_view.py)
+typedef struct {
+    uint8_t screen[MIRROR_BYTES];
+    uint32_t pos, frames;
+} mirror_view_t;
+
+static bool mirror_decode(mirror_view_t *v, const uint8_t *p, size_t len) {
+    size_t i = 0;
+    while (i + 3 <= len) {
+        if (p[i] != MIRROR_SYNC0 || p[i + 1] != MIRROR_SYNC1) return false;
+        size_t end = i + 3 + p[i + 2];
+        if (end > len) return false;
+        for (i += 3; i < end;) {
+            uint8_t op = p[i++];
+            uint32_t n;
+            if (op == MIRROR_OP_KEY) {
+                memset(v->screen, 0, sizeof(v->screen));
+                v->pos = 0;
+                i += 2;
+            } else if (op == MIRROR_OP_END) {
+                v->pos = 0;
+                v->frames++;
+                i += 6;
+            } else if (op >= MIRROR_OP_RUN) {
+                n = (uint32_t)(op - MIRROR_OP_RUN) + MIRROR_RUN_MIN;
+                if (v->pos + n > MIRROR_BYTES) return false;
+                while (n--) v->screen[v->pos++] ^= p[i];
+                i++;
+            } else if (op >= MIRROR_OP_XOR) {
+                n = (uint32_t)(op - MIRROR_OP_XOR) + 1;
+                if (v->pos + n > MIRROR_BYTES) return false;
+                while (n--) v->screen[v->pos++] ^= p[i++];
+            } else {
+                v->pos += (uint32_t)op + 1;
+            }
+        }
+    }
+    return i == len;
+}
+
+// Telas variadas, redesenhadas também no meio da codificação e com pouco
+// orçamento por volta, depois de uma reconexão: depois de cada quadro
+// completo a tela do PC deve ser igual à do display
+// Quadro desenhado por uma "interrupção" no meio de uma captura do laço
+static uint8_t mirror_isr_screen[MIRROR_BYTES];
+
+static void mirror_isr(void) {
+    mirror_frame(mirror_isr_screen, SSD1306_WIDTH, SSD1306_HEIGHT);
+}
+
+static bool mirror_check(uint32_t rounds, double *bytes_per_frame) {
+    static uint8_t out[1 << 20];
+    static mirror_view_t view;
+    mirror_stats_t before, after;
+    // Reconexão do terminal: o espelho recomeça com um quadro-chave
+    host_usb_connected = false;
+    mirror_drain(MIRROR_DRAIN_BYTES);
+    host_usb_connected = true;
+    mirror_get_stats(&before);
+    uint32_t rng = 3;
+    bool ok = true;
+    for (uint32_t r = 0; r < rounds && ok; r++) {
+        rng = rng * 1664525u + 1013904223u;
+        switch ((rng >> 24) % 4) {
+        case 0:
+            memset(display.buffer, 0, sizeof(display.buffer));
+            ssd1306_draw_border(&display, 1 + (int)(r % 2));
+            break;
+        case 1:
+            for (int k = 0; k < 40; k++) {
+                rng = rng * 1664525u + 1013904223u;
+                ssd1306_draw_pixel(&display, (int)(rng >> 8) % 128, (int)(rng >> 20) % 64, (rng >> 3) & 1);
+            }
+            break;
+        case 2:
+            memset(display.buffer, 0xFF, sizeof(display.buffer) / 2);
+            break;
+        default:
+            break;
+        }
+        // A cada 4 voltas, a captura do laço é interrompida por outra, logo
+        // depois de reservar o quadro (1) ou depois de publicar (2): nos dois
+        // casos o quadro da interrupção é o mais novo e é o que o PC deve ver
+        bool nested = r % 4 == 1;
+        if (nested) {
+            memcpy(mirror_isr_screen, display.buffer, sizeof(display.buffer));
+            rng = rng * 1664525u + 1013904223u;
+            for (uint32_t k = 0; k < 64; k++) mirror_isr_screen[((rng >> 16) + k) % sizeof(display.buffer)] ^= 0xFF;
+            host_irq_after(1 + (r / 4) % 2, mirror_isr);
+        }
+        char text[20];
+        snprintf(text, sizeof(text), "ATENCAO %u", (unsigned)r);
+        ssd1306_draw_string(&display, (int)(r % 40), (int)(r % 50), text); // Chama ssd1306_show
+        host_stdio_capture(out, sizeof(out));
+        mirror_drain(100);
+        if (r % 3 == 0 && !nested) ssd1306_show(&display); // Redesenho no meio do quadro
+        while (mirror_drain(100)) {
+        }
+        const uint8_t *expect = nested ? mirror_isr_screen : display.buffer;
+        ok = !host_irq_handler && mirror_decode(&view, out, host_stdio_captured()) &&
+             memcmp(view.screen, expect, sizeof(display.buffer)) == 0;
+    }
+    host_stdio_capture(NULL, 0);
+    mirror_get_stats(&after);
+    *bytes_per_frame = (double)(after.bytes - before.bytes) / (after.frames - before.frames);
+    return ok && view.frames == after.frames - before.frames;
+}
+
+#ifdef BENCH_FP_DB
+extern const fp_db_t fingerprint_bench_db; // Gerado no build (4096 pontos, 32 beacons)
+#endif
+
+#ifdef BENCH_GEOFENCE_MAP
+extern const geofence_map_t geofence_bench_map; // Gerado no build (400 zonas)
+#endif
+
+void bench_cases(void) {
+    ssd1306_init(&display, i2c1, SSD1306_ADDRESS, SSD1306_WIDTH, SSD1306_HEIGHT);
+
+    bench_set_unit("call");
+    bench_run("ssd1306_draw_string/alert", op_draw_string_alert, NULL);
+    bench_run("ssd1306_draw_string/coords", op_draw_string_coords, NULL);
+    bench_run("ssd1306_draw_border", op_draw_border, NULL);
+
+    bench_set_unit("frame");
+    bench_run("ssd1306_show", op_show, NULL);
+    bench_run("screen/alert", op_alert_screen, NULL);
+    bench_run("screen/movement", op_movement_frame, NULL);
+
+    bench_set_unit("boot");
+    bench_run("boot/display_first_frame", op_boot_display, NULL);
+
+    bench_set_unit("msg");
+    bench_run("format/gps_message", op_format_gps_message, NULL);
+    bench_run("stdio/gps_message_printf", op_printf_gps_message, NULL);
+    bench_run("stdio/gps_message_tlog", op_tlog_gps_message, NULL);
+
+    flash_sim_reset();
+    track_mount(&track, flash_sim_device(), 0);
+    bench_set_unit("point");
+    bench_run("track/append", op_track_append, NULL);
+    track_simplify_init(&simp, SIMPLIFY_TOLERANCE, SIMPLIFY_WINDOW);
+    leg = (leg_walk_t){.rng = 1, .x = 2048, .y = 2048};
+    bench_run("track/simplify", op_track_simplify, NULL);
+    double simplify_ratio, simplify_err;
+    bool simplify_ok = simplify_check(20000, &simplify_ratio, &simplify_err);
+    printf("track_simplify: %.2f:1, erro maximo %.1f (tolerancia %d), alertas mantidos %s\n", simplify_ratio,
+           simplify_err, SIMPLIFY_TOLERANCE, bench_check("track_simplify", simplify_ok));
+    bench_set_unit("call");
+    bench_run("track/mount", op_track_mount, NULL);
+    bench_run("track/query_last_minute", op_track_query_minute, NULL);
+    uint32_t erase_min = 0, erase_max = 0;
+    bool track_ok = track_check(&erase_min, &erase_max);
+    printf("track: apagamentos por setor %u..%u, consultas e cortes de energia %s\n", (unsigned)erase_min,
+           (unsigned)erase_max, bench_check("track/power_cut", track_ok));
+
+    static geofence_walk_t walk;
+    bench_set_unit("sample");
+    geofence_init(&walk.fence, &geofence_map);
+    walk.rng = 1;
+    walk.x = walk.y = 2048;
+    bench_run("geofence/update_default_map", op_geofence_update, &walk);
+    uint32_t fence_events, fence_raw;
+    bool fence_ok = geofence_check(&geofence_map, 200000, &fence_events, &fence_raw);
+    printf("geofence: %u eventos (%u sem histerese) no mapa padrao, grade igual a varredura %s\n",
+           (unsigned)fence_events, (unsigned)fence_raw, bench_check("geofence/reference", fence_ok));
+#ifdef BENCH_GEOFENCE_MAP
+    geofence_init(&walk.fence, &geofence_bench_map);
+    walk.rng = 1;
+    walk.x = walk.y = 2048;
+    bench_run("geofence/update_400_zones", op_geofence_update, &walk);
+    fence_ok = geofence_check(&geofence_bench_map, 200000, &fence_events, &fence_raw);
+    printf("geofence: %u eventos (%u sem histerese) em 400 zonas, grade igual a varredura %s\n",
+           (unsigned)fence_events, (unsigned)fence_raw, bench_check("geofence/reference_400", fence_ok));
+#endif
+
+    heatmap_init(&heat, 0, 0, 5);
+    heatmap_view_init(&heat_view, &heat, 32, 0, 1, &geofence_map);
+    walk.rng = 1;
+    walk.x = walk.y = 2048;
+    bench_run("heatmap/dwell", op_heatmap_dwell, &walk);
+    bench_set_unit("frame");
+    bench_run("heatmap/draw", op_heatmap_draw, &walk);
+    bench_run("screen/minimap", op_minimap_screen, &walk);
+    printf("heatmap: decaimento, saturacao e pontilhado conferem com a referencia %s\n",
+           bench_check("heatmap/reference", heatmap_check()));
+
+    trace_sink_ram(&trace_ram_sink, &trace_ram, trace_buf, sizeof(trace_buf));
+    walk.rng = 1;
+    walk.x = walk.y = 2048;
+    bench_set_unit("sample");
+    bench_run("trace/record_joystick", op_trace_record, &walk);
+    double trace_bps;
+    geofence_walk_t trace_start = walk;
+    bool trace_ok = trace_roundtrip(&walk, 10000, &trace_bps) && trace_corrupt_check(trace_start, 10000);
+    static trace_reader_t trace_reader;
+    trace_reader_init(&trace_reader, trace_buf, trace_ram.used);
+    bench_run("trace/decode", op_trace_decode, &trace_reader);
+    printf("trace: %.2f bytes/amostra, ida e volta com CRC por bloco %s\n", trace_bps, bench_check("trace/roundtrip", trace_ok));
+    uint32_t trace_flash_samples = 0;
+    bool trace_flash_ok = trace_flash_check(&trace_flash_samples);
+    printf("trace: %u amostras na flash (%u KB), leitura de volta %s\n", (unsigned)trace_flash_samples,
+           (unsigned)(FLASH_SIM_SECTORS * TRACK_SECTOR_SIZE / 1024), bench_check("trace/flash", trace_flash_ok));
+
+    bus_subscribe(&bus_all, BUS_POSITION);
+    bus_subscribe(&bus_last, BUS_POSITION);
+    walk.rng = 1;
+    walk.x = walk.y = 2048;
+    bench_run("bus/publish_fanout", op_bus_fanout, &walk);
+    printf("bus: perdas do consumidor lento %s\n", bench_check("bus/overrun", bus_overrun_check(32, 100)));
+
+    bench_set_unit("page");
+    bench_run("crc/crc32_track_page", op_crc32_page, NULL);
+    bench_set_unit("msg");
+    bench_run("crc/crc16_lora_copy", op_crc16_frame, NULL);
+    printf("crc: tabelas conferem com a referencia %s\n", bench_check("crc/reference", crc_check()));
+
+    static uint32_t mirror_i;
+    bench_set_unit("frame");
+    ssd1306_clear(&display);
+    while (mirror_drain(MIRROR_DRAIN_BYTES)) {
+    }
+    bench_run("mirror/coords_frame", op_mirror_coords, &mirror_i);
+    double mirror_bpf;
+    bool mirror_ok = mirror_check(2000, &mirror_bpf);
+    printf("mirror: %.1f bytes/quadro em telas variadas, reconstrucao %s\n", mirror_bpf, bench_check("mirror/reconstruct", mirror_ok));
+
+    printf("buttons: %u cenarios de gestos e debounce %s\n", (unsigned)(sizeof(gesture_cases) / sizeof(gesture_cases[0])),
+           bench_check("buttons/gestures", gestures_check()));
+
+#ifdef BENCH_FP_DB
+    static fp_synth_t fp = {.db = &fingerprint_bench_db, .rng = 1};
+    bench_set_unit("scan");
+    bench_run("fingerprint/locate_4096", op_fp_locate, &fp);
+    if (fp.estimates)
+        printf("fingerprint: erro medio %.0f unidades, confianca media %.0f, %.0f pontos comparados por consulta\n",
+               fp.err_sum / fp.estimates, fp.conf_sum / fp.estimates, fp.compared_sum / fp.estimates);
+    double fp_err, fp_ref_err, fp_compared;
+    bool fp_ok = fp_check(&fingerprint_bench_db, 2000, &fp_err, &fp_ref_err, &fp_compared);
+    printf("fingerprint: erro %.0f (busca completa %.0f), %.0f de %u pontos comparados %s\n", fp_err, fp_ref_err,
+           fp_compared, (unsigned)fingerprint_bench_db.point_count, bench_check("fingerprint/accuracy", fp_ok));
+#endif
+}
@@ -0,0 +1,251 @@
+#include "bench.h"
+#include "pico_host.h"
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+#include "gps.h"
+#include "lora.h"
+#include "emergency.h"
+#include "neighbors.h"
+#include "crc.h"
+#include <stdio.h>
+#include <string.h>
+
+// Suíte do firmware real (projetoreal/: ssd1306.c, gps.c, lora.c,
+// emergency.c, neighbors.c e a formatação de mensagens de main.c).
+
+const char *const bench_suite_name = "projetoreal";
+
+static ssd1306_t display;
+
+// Fluxo NMEA típico de um receptor a 1 Hz (GGA, GSA, GSV, RMC, VTG)
+static const char nmea_stream[] =
+    "$GPGGA,123519.00,0923.45678,S,04030.12345,W,1,08,0.9,376.4,M,-12.1,M,,*5C\r\n"
+    "$GPGSA,A,3,04,05,09,12,17,24,25,28,,,,,1.6,0.9,1.3*3A\r\n"
+    "$GPGSV,3,1,10,04,45,120,38,05,33,040,41,09,12,300,29,12,67,180,44*7B\r\n"
+    "$GPGSV,3,2,10,17,22,090,35,24,51,210,42,25,08,330,25,28,40,010,39*70\r\n"
+    "$GPGSV,3,3,10,30,05,250,,31,15,150,31*7C\r\n"
+    "$GPRMC,123519.00,A,0923.45678,S,04030.12345,W,0.12,84.4,210225,,,A*6B\r\n"
+    "$GPVTG,84.4,T,,M,0.12,N,0.22,K,A*03\r\n";
+
+static char gps_data[100];
+static char lora_message[150];
+
+static void op_gps_read(void *ctx) {
+    (void)ctx;
+    bench_sink += gps_read(uart0, gps_data, sizeof(gps_data));
+}
+
+// Mesma formatação da transmissão periódica em main.c
+static void op_lora_position(void *ctx) {
+    (void)ctx;
+    snprintf(lora_message, sizeof(lora_message), "GPS: %s", gps_data);
+    lora_send(uart1, lora_message);
+}
+
+// Caminho da interrupção do Botão B: quadro montado da posição guardada e
+// entregue ao rádio por DMA
+static void op_lora_emergency(void *ctx) {
+    (void)ctx;
+    emergency_trigger(time_us_32());
+}
+
+static void op_draw_border(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_border(&display, 1);
+    bench_sink += display.buffer[0];
+}
+
+static void op_draw_string_alert(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_string(&display, 0, 0, "ATENCAO");
+    bench_sink += display.buffer[0];
+}
+
+static void op_show(void *ctx) {
+    (void)ctx;
+    ssd1306_show(&display);
+}
+
+// Quadro de alerta do laço principal (inatividade de 10 minutos)
+static void op_alert_screen(void *ctx) {
+    (void)ctx;
+    ssd1306_draw_string(&display, 0, 0, "ATENCAO");
+    ssd1306_show(&display);
+}
+
+// Quadro limpo desenhado quando o acelerômetro detecta movimento
+static void op_movement_frame(void *ctx) {
+    (void)ctx;
+    ssd1306_clear(&display);
+    ssd1306_show(&display);
+}
+
+// Vizinhos: beacons de 300 crachás (IDs sequenciais, o pior caso para um
+// hash fraco), um a cada 50 ms, com o envelhecimento da volta do laço
+#define BENCH_NEIGHBORS 300
+
+typedef struct {
+    neighbors_t nb;
+    uint32_t rng;
+    uint32_t now_ms;
+    char line[LORA_LINE_MAX];
+} neighbors_bench_t;
+
+static void op_neighbors_beacon(void *ctx) {
+    neighbors_bench_t *b = ctx;
+    b->rng = b->rng * 1664525u + 1013904223u;
+    uint32_t id = 0x1A2B0000u + (b->rng >> 8) % BENCH_NEIGHBORS;
+    snprintf(b->line, sizeof(b->line), "B:%08lX,-%lu", (unsigned long)id, (unsigned long)(60 + (b->rng >> 24) % 60));
+    b->now_ms += 50;
+    bench_sink += neighbors_line(&b->nb, b->line, b->now_ms);
+    neighbors_age(&b->nb, b->now_ms);
+}
+
+static void op_neighbors_summary(void *ctx) {
+    neighbors_bench_t *b = ctx;
+    char msg[150];
+    for (uint32_t i = 0; i < 8; i++) neighbors_heard(&b->nb, 0x1A2B0000u + i * 37, -80, b->now_ms);
+    bench_sink += neighbors_summary(&b->nb, b->now_ms, msg, sizeof(msg));
+}
+
+// Enche a tabela, confere a recusa além do limite, a contagem de encontros
+// e que o envelhecimento esvazia a tabela em uma passada
+static bool neighbors_check(void) {
+    static neighbors_t nb;
+    neighbors_init(&nb, 0xCAFE);
+    for (uint32_t i = 1; i <= NEIGHBORS_MAX; i++)
+        if (!neighbors_heard(&nb, i, -70, 1000)) return false;
+    if (neighbors_heard(&nb, NEIGHBORS_MAX + 1, -70, 1000) || nb.rejected != 1) return false;
+    if (neighbors_line(&nb, "B:0000CAFE,-50", 1000) || !neighbors_line(&nb, "B:00000008,-64", 1000 + NEIGHBORS_GAP_MS + 1))
+        return false;
+    const neighbor_t *n = neighbors_find(&nb, 8);
+    if (!n || n->encounters != 2 || n->beacons != 2 || n->rssi != -64) return false;
+    // Metade sem beacon há mais que o limite: só ela sai
+    uint32_t now = 2000 + NEIGHBORS_TIMEOUT_MS;
+    for (uint32_t i = 2; i <= NEIGHBORS_MAX; i += 2) neighbors_heard(&nb, i, -70, now - 1000);
+    for (uint32_t k = 0; k < 2 * NEIGHBORS_SLOTS / NEIGHBORS_SWEEP_SLOTS; k++) neighbors_age(&nb, now);
+    for (uint32_t i = 1; i <= NEIGHBORS_MAX; i++)
+        if ((neighbors_find(&nb, i) != NULL) != (i % 2 == 0)) return false;
+    return nb.count == NEIGHBORS_MAX / 2 && nb.expired == NEIGHBORS_MAX / 2;
+}
+
+// Quadro de emergência esperado na UART, com o CRC de lora_send_urgent;
+// 'newline' quando ele encerra uma linha interrompida
+static size_t emergency_frame(char *out, size_t size, bool newline, uint32_t attempt, const char *fix) {
+    char body[64];
+    int len = snprintf(body, sizeof(body), "EMERGENCIA %lu: %s", (unsigned long)attempt, fix);
+    uint16_t crc = crc16_ccitt_update(CRC16_CCITT_INIT, body, (size_t)len);
+    return (size_t)snprintf(out, size, "%s%s*%04X\n", newline ? "\n" : "", body, crc);
+}
+
+static void emergency_irq(void) {
+    emergency_trigger(time_us_32());
+}
+
+// Repetições nos instantes de EMERGENCY_RETRY_MS e só neles, parada pelo
+// emergency_cancel, substituição de um quadro urgente ainda no DMA e a
+// quebra de linha que encerra uma mensagem comum interrompida. Os alarmes e
+// o DMA são os controláveis de pico_host.c.
+static bool emergency_check(void) {
+    static const uint32_t at_ms[] = {0, 1000, 3000, 7000, 15000, 30000};
+    static const char fix[] = "X:1 Y:2";
+    static uint8_t tx[512];
+    char want[128];
+    emergency_cancel();
+    emergency_set_fix(fix);
+    host_alarm_advance_ms(60000);
+    if (host_alarm_pending()) return false;
+
+    // Um quadro por tentativa, cada um no seu instante, e nada depois
+    host_uart_capture(tx, sizeof(tx));
+    uint64_t t0 = host_alarm_now_us();
+    emergency_trigger(time_us_32());
+    size_t seen = 0;
+    uint32_t frames = 0;
+    for (uint32_t ms = 0; ms <= 40000; ms++) {
+        if (ms) host_alarm_advance_ms(1);
+        size_t got = host_uart_captured();
+        if (got == seen) continue;
+        if (frames == 6 || (host_alarm_now_us() - t0) / 1000 != at_ms[frames]) return false;
+        size_t n = emergency_frame(want, sizeof(want), false, frames + 1, fix);
+        if (got - seen != n || memcmp(&tx[seen], want, n)) return false;
+        seen = got;
+        frames++;
+    }
+    if (frames != 6 || host_alarm_pending()) return false;
+
+    // Cancelamento depois da 2ª tentativa
+    size_t frame_len = emergency_frame(want, sizeof(want), false, 1, fix);
+    host_uart_capture(tx, sizeof(tx));
+    emergency_trigger(time_us_32());
+    host_alarm_advance_ms(1000);
+    emergency_cancel();
+    host_alarm_advance_ms(60000);
+    if (emergency_is_active() || host_alarm_pending() || host_uart_captured() != 2 * frame_len) return false;
+
+    // Novo gatilho com o quadro anterior ainda no DMA: só o 1º byte dele
+    // saiu, e o novo começa com '\n' para o receptor descartar o pedaço
+    host_uart_capture(tx, sizeof(tx));
+    host_dma_hold(true);
+    emergency_trigger(time_us_32());
+    emergency_trigger(time_us_32());
+    host_dma_hold(false);
+    emergency_cancel();
+    size_t n = emergency_frame(want, sizeof(want), true, 1, fix);
+    if (host_uart_captured() != 1 + n || tx[0] != 'E' || memcmp(&tx[1], want, n)) return false;
+
+    // Emergência no meio de lora_send: a mensagem para, a linha é encerrada
+    // antes do quadro e a próxima mensagem comum sai inteira
+    static const char msg[] = "GPS: teste";
+    host_uart_capture(tx, sizeof(tx));
+    host_irq_after(4, emergency_irq);
+    bool sent = lora_send(uart1, msg);
+    emergency_cancel();
+    size_t got = host_uart_captured();
+    if (sent || got <= n) return false;
+    size_t cut = got - n;
+    if (cut >= strlen(msg) || memcmp(tx, msg, cut) || memcmp(&tx[cut], want, n)) return false;
+    host_uart_capture(tx, sizeof(tx));
+    if (!lora_send(uart1, "ok")) return false;
+    uint16_t crc = crc16_ccitt_update(CRC16_CCITT_INIT, "ok", 2);
+    snprintf(want, sizeof(want), "ok*%04X\n", crc);
+    got = host_uart_captured();
+    host_uart_capture(NULL, 0);
+    return got == strlen(want) && !memcmp(tx, want, got);
+}
+
+void bench_cases(void) {
+    ssd1306_init(&display, i2c0, 0x3C, 128, 64);
+    host_uart_feed(uart0, nmea_stream, strlen(nmea_stream));
+    gps_read(uart0, gps_data, sizeof(gps_data));
+
+    bench_set_unit("call");
+    bench_run("ssd1306_draw_border", op_draw_border, NULL);
+    bench_run("ssd1306_draw_string/alert", op_draw_string_alert, NULL);
+
+    bench_set_unit("frame");
+    bench_run("ssd1306_show", op_show, NULL);
+    bench_run("screen/alert", op_alert_screen, NULL);
+    bench_run("screen/movement", op_movement_frame, NULL);
+
+    bench_set_unit("sentence");
+    bench_run("gps_read/nmea", op_gps_read, NULL);
+
+    bench_set_unit("msg");
+    lora_init(uart1);
+    emergency_init(uart1);
+    emergency_set_fix(gps_data);
+    bench_run("lora/position_message", op_lora_position, NULL);
+    bench_run("lora/emergency_message", op_lora_emergency, NULL);
+    printf("emergency: repeticoes em 1/3/7/15/30 s, cancelamento e preempcao %s\n",
+           bench_check("emergency/retry", emergency_check()));
+
+    static neighbors_bench_t nbb = {.rng = 1};
+    neighbors_init(&nbb.nb, 0xCAFE);
+    bench_set_unit("beacon");
+    bench_run("neighbors/beacon_300", op_neighbors_beacon, &nbb);
+    bench_set_unit("msg");
+    bench_run("neighbors/summary", op_neighbors_summary, &nbb);
+    printf("neighbors: %u na tabela (%u bytes), verificacao %s\n", nbb.nb.count, (unsigned)sizeof(neighbors_t),
+           bench_check("neighbors", neighbors_check()));
+}
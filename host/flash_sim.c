@@ -0,0 +1,71 @@
+#include "flash_sim.h"
+#include <string.h>
+
+#define FLASH_SIM_SIZE (FLASH_SIM_SECTORS * TRACK_SECTOR_SIZE)
+
+static uint8_t flash_mem[FLASH_SIM_SIZE];
+static flash_sim_stats_t stats;
+static uint32_t power_budget = 0; // Bytes restantes até o "corte" (0 = sem corte)
+static bool power_cut = false;
+
+void flash_sim_reset(void) {
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    memset(&stats, 0, sizeof(stats));
+    power_budget = 0;
+    power_cut = false;
+}
+
+void flash_sim_cut_power_after(uint32_t bytes) {
+    power_budget = bytes;
+    power_cut = false;
+}
+
+const flash_sim_stats_t *flash_sim_stats(void) {
+    return &stats;
+}
+
+// Consome o orçamento de energia; retorna quantos dos 'len' bytes chegam a ser escritos
+static uint32_t flash_sim_budget(uint32_t len) {
+    if (power_cut) return 0;
+    if (power_budget == 0) return len;
+    if (len >= power_budget) {
+        uint32_t n = power_budget;
+        power_budget = 0;
+        power_cut = true;
+        return n;
+    }
+    power_budget -= len;
+    return len;
+}
+
+static void flash_sim_read(uint32_t offset, void *dst, size_t len) {
+    memcpy(dst, &flash_mem[offset], len);
+}
+
+static bool flash_sim_program(uint32_t offset, const void *page) {
+    const uint8_t *src = page;
+    uint32_t n = flash_sim_budget(TRACK_PAGE_SIZE);
+    for (uint32_t i = 0; i < n; i++) flash_mem[offset + i] &= src[i];
+    stats.programs++;
+    return n == TRACK_PAGE_SIZE;
+}
+
+static bool flash_sim_erase(uint32_t offset) {
+    uint32_t n = flash_sim_budget(TRACK_SECTOR_SIZE);
+    // Apagamento interrompido deixa o setor parcialmente apagado
+    memset(&flash_mem[offset], 0xFF, n);
+    stats.erase_count[offset / TRACK_SECTOR_SIZE]++;
+    stats.erases++;
+    return n == TRACK_SECTOR_SIZE;
+}
+
+static const track_flash_t flash_sim = {
+    .size = FLASH_SIM_SIZE,
+    .read = flash_sim_read,
+    .program = flash_sim_program,
+    .erase = flash_sim_erase,
+};
+
+const track_flash_t *flash_sim_device(void) {
+    return &flash_sim;
+}
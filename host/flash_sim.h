@@ -0,0 +1,30 @@
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+#include "track.h"
+
+// Simulador de flash NOR para os builds de host: a gravação só zera bits
+// (como no chip real), o apagamento devolve 0xFF ao setor inteiro e cada
+// setor conta quantas vezes foi apagado (desgaste).
+
+#define FLASH_SIM_SECTORS 64
+
+typedef struct {
+    uint32_t erase_count[FLASH_SIM_SECTORS];
+    uint32_t programs;
+    uint32_t erases;
+} flash_sim_stats_t;
+
+// Apaga todo o simulador (flash nova) e zera as estatísticas.
+void flash_sim_reset(void);
+
+// Simula falta de energia: após 'bytes' bytes gravados, as gravações e
+// apagamentos seguintes param no meio e falham. 0 desativa.
+void flash_sim_cut_power_after(uint32_t bytes);
+
+const flash_sim_stats_t *flash_sim_stats(void);
+
+// Dispositivo para track_mount.
+const track_flash_t *flash_sim_device(void);
+
+#endif
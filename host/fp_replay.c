@@ -0,0 +1,89 @@
+#include "fingerprint.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reproduz varreduras gravadas contra a base do repositório (fingerprint_db.c).
+// Uma varredura por linha, com a posição verdadeira opcional no início:
+//   [x y] 02:00:00:00:00:01=-48 02:00:00:00:00:02=-70 ...
+// Linhas vazias e iniciadas por '#' são ignoradas.
+
+typedef struct {
+    FILE *in;
+    int has_truth;
+    long true_x, true_y;
+} replay_t;
+
+static int parse_ap(const char *tok, fp_scan_t *scan) {
+    unsigned b[6];
+    int rssi;
+    if (sscanf(tok, "%x:%x:%x:%x:%x:%x=%d", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &rssi) != 7) return 0;
+    if (scan->count >= FP_SCAN_MAX) return 1;
+    for (int i = 0; i < 6; i++) scan->ap[scan->count].id.id[i] = (uint8_t)b[i];
+    scan->ap[scan->count].rssi = (int8_t)(rssi < -128 ? -128 : rssi > 0 ? 0 : rssi);
+    scan->count++;
+    return 1;
+}
+
+static bool replay_poll(void *ctx, fp_scan_t *scan) {
+    replay_t *r = ctx;
+    char line[2048];
+    while (fgets(line, sizeof(line), r->in)) {
+        char *tok = strtok(line, " \t\r\n");
+        if (!tok || tok[0] == '#') continue;
+        scan->count = 0;
+        r->has_truth = 0;
+        char *end;
+        long x = strtol(tok, &end, 10);
+        if (*end == '\0') {
+            char *ty = strtok(NULL, " \t\r\n");
+            if (!ty) continue;
+            r->true_x = x;
+            r->true_y = strtol(ty, NULL, 10);
+            r->has_truth = 1;
+            tok = strtok(NULL, " \t\r\n");
+        }
+        for (; tok; tok = strtok(NULL, " \t\r\n")) {
+            if (!parse_ap(tok, scan)) fprintf(stderr, "ignorado: %s\n", tok);
+        }
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    replay_t r = {.in = stdin};
+    if (argc > 1 && !(r.in = fopen(argv[1], "r"))) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fp_source_t src = {replay_poll, &r};
+    unsigned scans = 0, located = 0, truths = 0;
+    double err_sum = 0;
+    for (;;) {
+        fp_estimate_t est;
+        fp_scan_t scan;
+        if (!src.poll(src.ctx, &scan)) break;
+        scans++;
+        if (!fp_locate(&fingerprint_db, &scan, &est)) {
+            printf("%u: sem estimativa (%u beacons conhecidos)\n", scans, est.heard);
+            continue;
+        }
+        located++;
+        printf("%u: x=%ld y=%ld confianca=%u beacons=%u comparados=%u", scans, (long)est.x, (long)est.y,
+               est.confidence, est.heard, est.compared);
+        if (r.has_truth) {
+            double err = hypot((double)(est.x - r.true_x), (double)(est.y - r.true_y));
+            err_sum += err;
+            truths++;
+            printf(" erro=%.0f", err);
+        }
+        printf("\n");
+    }
+    printf("%u varreduras, %u estimadas", scans, located);
+    if (truths) printf(", erro medio %.0f unidades", err_sum / truths);
+    printf("\n");
+    return 0;
+}
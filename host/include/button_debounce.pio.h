@@ -0,0 +1,21 @@
+#ifndef HOST_BUTTON_DEBOUNCE_PIO_H
+#define HOST_BUTTON_DEBOUNCE_PIO_H
+
+// Substituto do cabeçalho gerado pelo pioasm a partir de
+// button_debounce.pio: no host a máquina de estados é simulada em
+// pico_host.c, com a mesma janela de estabilidade.
+#include "hardware/pio.h"
+#include "pico_host.h"
+
+static const pio_program_t button_debounce_program = {0};
+
+#define BUTTON_DEBOUNCE_CYCLES_PER_US 5
+
+static inline uint32_t button_debounce_program_init(PIO pio, uint sm, uint offset, uint pin, float clk_div,
+                                                    uint32_t window_us) {
+    (void)offset;
+    (void)clk_div;
+    return host_pio_debounce_init(pio, sm, pin, window_us);
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+// Substituto mínimo de hardware/clocks.h: clk_sys no valor padrão do RP2040.
+#include "pico/types.h"
+
+enum clock_index { clk_sys = 5 };
+
+static inline uint32_t clock_get_hz(enum clock_index clk) {
+    (void)clk;
+    return 125000000u;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+// Substituto mínimo de hardware/gpio.h: a configuração dos pinos não tem
+// efeito no host (os níveis dos botões vêm de host_button_set).
+#include "pico/types.h"
+
+#define GPIO_IN false
+#define GPIO_OUT true
+
+static inline void gpio_init(uint gpio) { (void)gpio; }
+static inline void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+static inline void gpio_pull_up(uint gpio) { (void)gpio; }
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+// Substituto mínimo de hardware/i2c.h: as escritas são apenas contabilizadas
+// (ver host_bus_stats_t em pico_host.h).
+#include "pico/types.h"
+
+typedef struct i2c_inst {
+    int index;
+} i2c_inst_t;
+
+extern i2c_inst_t host_i2c_inst[2];
+#define i2c0 (&host_i2c_inst[0])
+#define i2c1 (&host_i2c_inst[1])
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+#endif
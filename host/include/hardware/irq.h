@@ -0,0 +1,21 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+// Substituto mínimo de hardware/irq.h: no host não há interrupções, os
+// tratadores só são registrados. Os compartilhados são chamados pelas
+// simulações de pico_host.c (botões na PIO).
+#include "pico/types.h"
+
+#define PIO0_IRQ_0 7
+#define UART0_IRQ 20
+#define UART1_IRQ 21
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+static inline void irq_set_exclusive_handler(uint num, irq_handler_t handler) { (void)num; (void)handler; }
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef HOST_HARDWARE_PIO_H
+#define HOST_HARDWARE_PIO_H
+
+// Substituto mínimo de hardware/pio.h para o debounce dos botões: a máquina
+// de estados é simulada em pico_host.c (host_button_set), com a FIFO RX e a
+// interrupção de FIFO não vazia.
+#include "pico/types.h"
+
+typedef struct {
+    uint index;
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t host_pio_inst[2];
+#define pio0 (&host_pio_inst[0])
+#define pio1 (&host_pio_inst[1])
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+enum pio_interrupt_source {
+    pis_sm0_rx_fifo_not_empty = 0,
+    pis_sm1_rx_fifo_not_empty,
+    pis_sm2_rx_fifo_not_empty,
+    pis_sm3_rx_fifo_not_empty,
+};
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint32_t pio_sm_get(PIO pio, uint sm);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+// Substituto mínimo de hardware/sync.h. No host não há interrupções de
+// verdade: a máscara só é acompanhada para que uma interrupção simulada
+// (host_irq_after, ver pico_host.h) ou uma da PIO que chegou com a máscara
+// ligada rode quando for reabilitada.
+#include "pico/types.h"
+
+extern volatile bool host_irq_masked;
+extern void (*volatile host_irq_handler)(void);
+extern volatile uint32_t host_irq_pending;
+void host_irq_restored(void);
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    uint32_t status = host_irq_masked;
+    host_irq_masked = true;
+    return status;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    host_irq_masked = status != 0;
+    if (!status && (host_irq_handler || host_irq_pending)) host_irq_restored();
+}
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+// Substituto mínimo de hardware/uart.h: a recepção lê de um fluxo roteirizado
+// (host_uart_feed) e a transmissão é apenas contabilizada.
+#include "pico/types.h"
+
+#define UART_UARTFR_TXFE_BITS 0x00000080u
+
+typedef struct {
+    volatile uint32_t dr; // Destino das transferências de DMA (apenas contadas)
+    volatile uint32_t fr; // Flags: a FIFO de transmissão está sempre vazia
+} uart_hw_t;
+
+typedef struct uart_inst {
+    const char *rx_data;  // Fluxo de recepção (ver host_uart_feed)
+    size_t rx_len;
+    size_t rx_pos;
+    uart_hw_t hw;
+} uart_inst_t;
+
+extern uart_inst_t host_uart_inst[2];
+#define uart0 (&host_uart_inst[0])
+#define uart1 (&host_uart_inst[1])
+
+bool uart_is_readable(uart_inst_t *uart);
+char uart_getc(uart_inst_t *uart);
+void uart_putc(uart_inst_t *uart, char c);
+void uart_puts(uart_inst_t *uart, const char *s);
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *src, size_t len);
+void uart_putc_raw(uart_inst_t *uart, char c);
+
+// No host a transmissão nunca espera e não há FIFO a configurar.
+static inline bool uart_is_writable(uart_inst_t *uart) { (void)uart; return true; }
+static inline void uart_set_fifo_enabled(uart_inst_t *uart, bool enabled) { (void)uart; (void)enabled; }
+static inline uart_hw_t *uart_get_hw(uart_inst_t *uart) { return &uart->hw; }
+static inline uint uart_get_dreq(uart_inst_t *uart, bool tx) { (void)tx; return uart == &host_uart_inst[0] ? 0 : 2; }
+static inline void uart_set_irq_enables(uart_inst_t *uart, bool rx, bool tx) { (void)uart; (void)rx; (void)tx; }
+
+#endif
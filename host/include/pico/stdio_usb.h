@@ -0,0 +1,12 @@
+#ifndef HOST_PICO_STDIO_USB_H
+#define HOST_PICO_STDIO_USB_H
+
+// Substituto mínimo de pico/stdio_usb.h: a conexão do terminal é simulada
+// por host_usb_connected (pico_host.c, conectado por padrão).
+#include "pico/types.h"
+
+extern bool host_usb_connected;
+
+static inline bool stdio_usb_connected(void) { return host_usb_connected; }
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+// Substituto mínimo de pico/stdlib.h para os builds de host (bench).
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/i2c.h"
+#include "hardware/uart.h"
+
+void sleep_ms(uint32_t ms);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+int putchar_raw(int c);
+static inline void tight_loop_contents(void) {}
+static inline void hard_assert(bool condition) {
+    if (!condition) __builtin_trap();
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+// Substituto mínimo dos tipos do Pico SDK para os builds de host (bench).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+#endif
@@ -0,0 +1,475 @@
+#define _POSIX_C_SOURCE 199309L
+#include "pico_host.h"
+#include "pico/stdlib.h"
+#include "pico/time.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include <stdlib.h>
+#include <time.h>
+
+// Implementação das funções do SDK usadas pelos drivers nos builds de host.
+// Nada é enviado de fato: os acessos aos barramentos apenas alimentam os
+// contadores em host_stats, usados pelo bench para medir tráfego por quadro.
+
+i2c_inst_t host_i2c_inst[2] = { {0}, {1} };
+uart_inst_t host_uart_inst[2] = {
+    {.hw.fr = UART_UARTFR_TXFE_BITS},
+    {.hw.fr = UART_UARTFR_TXFE_BITS},
+};
+
+host_bus_stats_t host_stats;
+bool host_usb_connected = true;
+
+void host_stats_reset(void) {
+    host_bus_stats_t zero = {0};
+    host_stats = zero;
+}
+
+uint64_t host_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// ---------- pico/stdlib ----------
+void sleep_ms(uint32_t ms) {
+    (void)ms; // No bench o tempo de espera não interessa
+}
+
+static bool time_virtual;
+static uint64_t alarm_now_us;
+
+void host_time_virtual(bool on) {
+    time_virtual = on;
+}
+
+uint64_t time_us_64(void) {
+    return time_virtual ? alarm_now_us : host_time_ns() / 1000u;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+static uint8_t *stdio_capture;
+static size_t stdio_capture_size, stdio_capture_used;
+
+void host_stdio_capture(uint8_t *buf, size_t size) {
+    stdio_capture = buf;
+    stdio_capture_size = size;
+    stdio_capture_used = 0;
+}
+
+size_t host_stdio_captured(void) {
+    return stdio_capture_used;
+}
+
+int putchar_raw(int c) {
+    host_stats.stdio_tx_bytes++;
+    if (stdio_capture && stdio_capture_used < stdio_capture_size) stdio_capture[stdio_capture_used++] = (uint8_t)c;
+    return c;
+}
+
+// ---------- hardware/i2c ----------
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c; (void)addr; (void)src; (void)nostop;
+    host_stats.i2c_bytes += len + 1; // +1 pelo byte de endereço
+    host_stats.i2c_transactions++;
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c; (void)addr; (void)nostop;
+    for (size_t i = 0; i < len; i++) dst[i] = 0;
+    host_stats.i2c_bytes += len + 1;
+    host_stats.i2c_transactions++;
+    return (int)len;
+}
+
+// ---------- hardware/sync ----------
+volatile bool host_irq_masked;
+void (*volatile host_irq_handler)(void);
+volatile uint32_t host_irq_pending; // Linhas de irq que esperam a máscara
+static uint32_t host_irq_countdown;
+static void irq_deliver_pending(void);
+
+void host_irq_after(uint32_t n, void (*handler)(void)) {
+    host_irq_countdown = n;
+    host_irq_handler = handler;
+}
+
+void host_irq_restored(void) {
+    irq_deliver_pending();
+    if (!host_irq_handler) return;
+    if (host_irq_countdown && --host_irq_countdown) return;
+    void (*handler)(void) = host_irq_handler;
+    host_irq_handler = NULL;
+    host_irq_masked = true; // Contexto de interrupção
+    handler();
+    host_irq_masked = false;
+}
+
+// ---------- hardware/irq ----------
+#define HOST_IRQS 32
+
+static irq_handler_t irq_shared[HOST_IRQS];
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    if (num < HOST_IRQS) irq_shared[num] = handler; // Um tratador por linha basta aos drivers
+}
+
+static void irq_raise(uint num) {
+    if (num >= HOST_IRQS || !irq_shared[num]) return;
+    if (host_irq_masked) {
+        host_irq_pending |= 1u << num; // Atendida em restore_interrupts
+        return;
+    }
+    host_irq_masked = true;
+    irq_shared[num]();
+    host_irq_masked = false;
+}
+
+static void irq_deliver_pending(void) {
+    while (host_irq_pending) {
+        uint num = (uint)__builtin_ctz(host_irq_pending);
+        host_irq_pending &= ~(1u << num);
+        irq_raise(num);
+    }
+}
+
+// ---------- hardware/pio ----------
+// Uma máquina de debounce por botão: o nível do pino muda em
+// host_button_set; a mudança é confirmada 'window_us' depois, se o pino não
+// mudou de novo, com a mesma palavra que button_debounce.pio põe na FIFO RX
+// (31 bits do contador X, que desce 1 por us a partir de 0 em t_zero, e o
+// bit 0: 0 = pressionado, 1 = solto). A FIFO tem 4 posições e descarta
+// quando cheia (push noblock).
+#define HOST_PIO_SMS 4
+#define HOST_PIO_FIFO 4
+
+pio_hw_t host_pio_inst[2] = { {0}, {1} };
+
+static struct {
+    bool used;
+    uint gpio;
+    uint32_t window_us;
+    bool level;       // Nível atual do pino (true = pressionado)
+    bool stable;      // Último estado confirmado
+    uint64_t since_us; // Instante da última mudança do pino
+    uint64_t t_zero;  // Instante em que X valia 0
+    uint32_t fifo[HOST_PIO_FIFO];
+    uint8_t fifo_head, fifo_count;
+} pio_sm[HOST_PIO_SMS];
+static uint32_t pio_claimed;
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+    (void)pio; (void)program;
+    return 0;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    (void)pio;
+    for (int sm = 0; sm < HOST_PIO_SMS; sm++) {
+        if (!(pio_claimed & (1u << sm))) {
+            pio_claimed |= 1u << sm;
+            return sm;
+        }
+    }
+    if (required) abort();
+    return -1;
+}
+
+void pio_set_irq0_source_enabled(PIO pio, enum pio_interrupt_source source, bool enabled) {
+    (void)pio; (void)source; (void)enabled; // A simulação sempre interrompe
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    (void)pio;
+    return pio_sm[sm].fifo_count == 0;
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    (void)pio;
+    if (pio_sm[sm].fifo_count == 0) return 0;
+    uint32_t word = pio_sm[sm].fifo[pio_sm[sm].fifo_head];
+    pio_sm[sm].fifo_head = (uint8_t)((pio_sm[sm].fifo_head + 1) % HOST_PIO_FIFO);
+    pio_sm[sm].fifo_count--;
+    return word;
+}
+
+uint32_t host_pio_debounce_init(PIO pio, uint sm, uint gpio, uint32_t window_us) {
+    (void)pio;
+    pio_sm[sm].t_zero = alarm_now_us;
+    pio_sm[sm].used = true;
+    pio_sm[sm].gpio = gpio;
+    pio_sm[sm].window_us = window_us;
+    pio_sm[sm].level = pio_sm[sm].stable = false;
+    pio_sm[sm].since_us = alarm_now_us;
+    pio_sm[sm].fifo_count = 0;
+    return (uint32_t)alarm_now_us;
+}
+
+void host_button_set(uint gpio, bool pressed) {
+    for (int sm = 0; sm < HOST_PIO_SMS; sm++) {
+        if (!pio_sm[sm].used || pio_sm[sm].gpio != gpio || pio_sm[sm].level == pressed) continue;
+        pio_sm[sm].level = pressed;
+        pio_sm[sm].since_us = alarm_now_us;
+    }
+}
+
+// Próxima confirmação até 'end' (-1 se nenhuma)
+static int pio_next_due(uint64_t end, uint64_t *at_us) {
+    int due = -1;
+    for (int sm = 0; sm < HOST_PIO_SMS; sm++) {
+        if (!pio_sm[sm].used || pio_sm[sm].level == pio_sm[sm].stable) continue;
+        uint64_t at = pio_sm[sm].since_us + pio_sm[sm].window_us;
+        if (at <= end && (due < 0 || at < *at_us)) {
+            due = sm;
+            *at_us = at;
+        }
+    }
+    return due;
+}
+
+static void pio_confirm(int sm) {
+    pio_sm[sm].stable = pio_sm[sm].level;
+    if (pio_sm[sm].fifo_count < HOST_PIO_FIFO) {
+        uint32_t x = 0u - (uint32_t)(alarm_now_us - pio_sm[sm].t_zero);
+        pio_sm[sm].fifo[(pio_sm[sm].fifo_head + pio_sm[sm].fifo_count) % HOST_PIO_FIFO] =
+            x << 1 | (pio_sm[sm].stable ? 0u : 1u);
+        pio_sm[sm].fifo_count++;
+    }
+    irq_raise(PIO0_IRQ_0);
+}
+
+// ---------- hardware/uart ----------
+static uint8_t *uart_capture;
+static size_t uart_capture_size, uart_capture_used;
+
+void host_uart_capture(uint8_t *buf, size_t size) {
+    uart_capture = buf;
+    uart_capture_size = size;
+    uart_capture_used = 0;
+}
+
+size_t host_uart_captured(void) {
+    return uart_capture_used;
+}
+
+static void uart_capture_bytes(const uint8_t *src, size_t len) {
+    for (size_t i = 0; i < len && uart_capture && uart_capture_used < uart_capture_size; i++)
+        uart_capture[uart_capture_used++] = src[i];
+}
+
+void host_uart_feed(uart_inst_t *uart, const char *data, size_t len) {
+    uart->rx_data = data;
+    uart->rx_len = len;
+    uart->rx_pos = 0;
+}
+
+bool uart_is_readable(uart_inst_t *uart) {
+    return uart->rx_len > 0;
+}
+
+char uart_getc(uart_inst_t *uart) {
+    if (uart->rx_len == 0) return 0;
+    char c = uart->rx_data[uart->rx_pos];
+    if (++uart->rx_pos == uart->rx_len) uart->rx_pos = 0;
+    host_stats.uart_rx_bytes++;
+    return c;
+}
+
+void uart_putc(uart_inst_t *uart, char c) {
+    (void)uart;
+    host_stats.uart_tx_bytes++;
+    uart_capture_bytes((const uint8_t *)&c, 1);
+}
+
+void uart_putc_raw(uart_inst_t *uart, char c) {
+    uart_putc(uart, c);
+}
+
+void uart_puts(uart_inst_t *uart, const char *s) {
+    while (*s) uart_putc(uart, *s++);
+}
+
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *src, size_t len) {
+    (void)uart;
+    host_stats.uart_tx_bytes += len;
+    uart_capture_bytes(src, len);
+}
+
+// ---------- hardware/dma ----------
+// A transferência é instantânea (ou segura por host_dma_hold); o único uso
+// nos drivers é a transmissão pela UART, contada e capturada como tal.
+#define HOST_DMA_CHANNELS 12
+
+static uint32_t dma_claimed;
+static bool dma_hold;
+static struct {
+    const volatile uint8_t *src;
+    uint count; // 0 = livre
+} dma_pending[HOST_DMA_CHANNELS];
+
+static void dma_complete(uint channel) {
+    host_stats.uart_tx_bytes += dma_pending[channel].count;
+    uart_capture_bytes((const uint8_t *)dma_pending[channel].src, dma_pending[channel].count);
+    dma_pending[channel].count = 0;
+}
+
+void host_dma_hold(bool hold) {
+    dma_hold = hold;
+    if (hold) return;
+    for (uint ch = 0; ch < HOST_DMA_CHANNELS; ch++)
+        if (dma_pending[ch].count) dma_complete(ch);
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (int ch = 0; ch < HOST_DMA_CHANNELS; ch++) {
+        if (!(dma_claimed & (1u << ch))) {
+            dma_claimed |= 1u << ch;
+            return ch;
+        }
+    }
+    if (required) abort();
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config c = {0};
+    return c;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    (void)config; (void)write_addr;
+    if (!trigger) return;
+    dma_pending[channel].src = read_addr;
+    dma_pending[channel].count = transfer_count;
+    if (!dma_hold) dma_complete(channel);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    return dma_pending[channel].count != 0;
+}
+
+void dma_channel_abort(uint channel) {
+    dma_pending[channel].count = 0; // O que faltava não sai
+}
+
+// ---------- pico/time ----------
+// Os alarmes só disparam em host_alarm_advance_ms, num relógio próprio: o
+// bench controla quando cada um vence sem esperar de verdade.
+#define HOST_ALARMS 8
+
+static struct {
+    alarm_id_t id; // 0 = livre
+    uint64_t at_us;
+    alarm_callback_t callback;
+    void *user_data;
+} alarms[HOST_ALARMS];
+static alarm_id_t alarm_next_id = 1;
+
+static bool alarm_insert(alarm_id_t id, uint64_t at_us, alarm_callback_t callback, void *user_data) {
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (alarms[i].id) continue;
+        alarms[i].id = id;
+        alarms[i].at_us = at_us;
+        alarms[i].callback = callback;
+        alarms[i].user_data = user_data;
+        return true;
+    }
+    return false;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    alarm_id_t id = alarm_next_id;
+    if (!alarm_insert(id, alarm_now_us + us, callback, user_data))
+        return -1; // Sem alarmes livres, como no SDK
+    alarm_next_id = alarm_next_id == INT32_MAX ? 1 : alarm_next_id + 1;
+    return id;
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t)ms * 1000u, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    for (int i = 0; i < HOST_ALARMS; i++) {
+        if (alarms[i].id == alarm_id && alarm_id > 0) {
+            alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t host_alarm_now_us(void) {
+    return alarm_now_us;
+}
+
+uint32_t host_alarm_pending(void) {
+    uint32_t n = 0;
+    for (int i = 0; i < HOST_ALARMS; i++) n += alarms[i].id != 0;
+    return n;
+}
+
+void host_alarm_advance_ms(uint32_t ms) {
+    uint64_t end = alarm_now_us + (uint64_t)ms * 1000u;
+    for (;;) {
+        int due = -1;
+        for (int i = 0; i < HOST_ALARMS; i++) {
+            if (alarms[i].id && alarms[i].at_us <= end && (due < 0 || alarms[i].at_us < alarms[due].at_us)) due = i;
+        }
+        // Confirmações dos botões na PIO, em ordem com os alarmes
+        uint64_t pio_at;
+        int sm = pio_next_due(due < 0 ? end : alarms[due].at_us, &pio_at);
+        if (sm >= 0 && (due < 0 || pio_at < alarms[due].at_us)) {
+            alarm_now_us = pio_at;
+            pio_confirm(sm);
+            continue;
+        }
+        if (due < 0) break;
+        alarm_now_us = alarms[due].at_us;
+        alarm_id_t id = alarms[due].id;
+        alarm_callback_t callback = alarms[due].callback;
+        void *user_data = alarms[due].user_data;
+        alarms[due].id = 0;
+        // Retorno do callback como no SDK: > 0 reagenda a partir do instante
+        // previsto, < 0 a partir de agora, 0 encerra
+        bool masked = host_irq_masked;
+        host_irq_masked = true;
+        int64_t next = callback(id, user_data);
+        host_irq_masked = masked;
+        if (next != 0) alarm_insert(id, alarm_now_us + (uint64_t)(next > 0 ? next : -next), callback, user_data);
+    }
+    alarm_now_us = end;
+}
+
+// ---------- Contagem de alocações ----------
+// Com -Wl,--wrap=malloc (ver CMakeLists.txt) as chamadas dos módulos passam por aqui.
+#ifdef HOST_WRAP_MALLOC
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    host_stats.allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    host_stats.allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    host_stats.allocs++;
+    return __real_realloc(ptr, size);
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef PICO_HOST_H
+#define PICO_HOST_H
+
+#include "pico/types.h"
+#include "hardware/pio.h"
+#include "hardware/uart.h"
+
+// Contadores de tráfego dos barramentos simulados no host.
+typedef struct {
+    uint64_t i2c_bytes;         // Bytes escritos/lidos via I2C (inclui bytes de controle)
+    uint64_t i2c_transactions;  // Número de transações I2C (chamadas *_blocking)
+    uint64_t uart_tx_bytes;     // Bytes enviados pelas UARTs
+    uint64_t uart_rx_bytes;     // Bytes consumidos das UARTs
+    uint64_t stdio_tx_bytes;    // Bytes enviados pela stdio (USB no alvo)
+    uint64_t allocs;            // Chamadas a malloc/calloc/realloc
+} host_bus_stats_t;
+
+extern host_bus_stats_t host_stats;
+
+// Zera todos os contadores.
+void host_stats_reset(void);
+
+// Define o fluxo que a UART devolverá em uart_getc. O fluxo é circular:
+// ao chegar ao fim, recomeça do início (simula um GPS transmitindo sem parar).
+void host_uart_feed(uart_inst_t *uart, const char *data, size_t len);
+
+// Copia também para 'buf' os bytes enviados por putchar_raw (até 'size'),
+// para conferir o conteúdo dos quadros binários. NULL desliga.
+void host_stdio_capture(uint8_t *buf, size_t size);
+size_t host_stdio_captured(void);
+
+// Relógio monotônico do host em nanossegundos.
+uint64_t host_time_ns(void);
+
+// Copia os bytes transmitidos pelas UARTs (pela CPU ou por DMA, na ordem em
+// que saem) para 'buf', até 'size'. NULL desliga.
+void host_uart_capture(uint8_t *buf, size_t size);
+size_t host_uart_captured(void);
+
+// Com hold, as transferências de DMA disparadas ficam em andamento
+// (dma_channel_is_busy) até serem abortadas ou até host_dma_hold(false),
+// que as conclui. Sem hold, terminam no próprio disparo.
+void host_dma_hold(bool hold);
+
+// Alarmes: ficam pendentes até host_alarm_advance_ms, que avança o relógio
+// dos alarmes (separado de time_us_64) e chama os vencidos em ordem, como a
+// interrupção do timer, incluindo os reagendados pelo retorno do callback.
+void host_alarm_advance_ms(uint32_t ms);
+uint64_t host_alarm_now_us(void);
+uint32_t host_alarm_pending(void);
+
+// Interrupção simulada: 'handler' roda uma vez, quando as interrupções forem
+// reabilitadas (restore_interrupts) pela n-ésima vez a partir de agora.
+void host_irq_after(uint32_t n, void (*handler)(void));
+
+// Com 'on', time_us_32/time_us_64 devolvem o relógio dos alarmes em vez do
+// relógio do host (durações medidas pelos módulos ficam exatas).
+void host_time_virtual(bool on);
+
+// Botões na PIO: host_button_set muda o nível do pino no instante atual do
+// relógio dos alarmes. A máquina de estados do debounce (uma por pino,
+// criada por button_debounce_program_init) só confirma a mudança depois de
+// 'window_us' sem outra mudança; então põe a palavra na FIFO RX e chama o
+// tratador de PIO0_IRQ_0, em ordem com os alarmes, dentro de
+// host_alarm_advance_ms. Com as interrupções mascaradas
+// (save_and_disable_interrupts), o tratador espera o restore_interrupts,
+// como no alvo durante uma gravação na flash. Retorna o instante em que o
+// contador da máquina vale 0.
+uint32_t host_pio_debounce_init(PIO pio, uint sm, uint gpio, uint32_t window_us);
+void host_button_set(uint gpio, bool pressed);
+
+#endif
@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "track.h"
+#include "track_simplify.h"
+#include "geofence.h"
+#include "heatmap.h"
+#include "buttons.h"
+#include "flash_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reproduz uma gravação de entradas (inc/trace.h) na lógica de posição do
+// firmware da raiz: geofence, trajeto (na flash simulada) e mapa de
+// permanência, na mesma ordem do laço de finalv3.c e com os instantes da
+// gravação. O resultado é determinístico: o resumo (FNV-1a dos eventos, do
+// trajeto e do mapa) é o mesmo a cada execução da mesma gravação.
+//
+//   tlog_decode.py /dev/ttyACM0 --trace captura.trc
+//   ./build-host/trace_replay captura.trc [--eventos]
+
+#define BUTTON_B 6 // Mesmo pino de finalv3.c
+#define TRACK_TOLERANCE 48 // Mesma simplificação do trajeto de finalv3.c
+#define TRACK_WINDOW 30
+
+static uint32_t digest = 2166136261u;
+
+static void digest_add(const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) digest = (digest ^ p[i]) * 16777619u;
+}
+
+static bool digest_record(const track_record_t *r, void *ctx) {
+    (void)ctx;
+    digest_add(&r->t_ms, sizeof(r->t_ms));
+    digest_add(&r->x, sizeof(r->x));
+    digest_add(&r->y, sizeof(r->y));
+    digest_add(&r->flags, sizeof(r->flags));
+    return true;
+}
+
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = malloc(size > 0 ? (size_t)size : 1);
+    *len = fread(data, 1, (size_t)size, f);
+    fclose(f);
+    return data;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s captura.trc [--eventos]\n", argv[0]);
+        return 1;
+    }
+    bool verbose = argc > 2 && strcmp(argv[2], "--eventos") == 0;
+    size_t len;
+    uint8_t *data = read_file(argv[1], &len);
+
+    static geofence_t fence;
+    static heatmap_t heat;
+    static track_t track;
+    static track_simplify_t simp;
+    geofence_init(&fence, &geofence_map);
+    heatmap_init(&heat, 0, 0, 5);
+    flash_sim_reset();
+    track_mount(&track, flash_sim_device(), 0);
+    track_simplify_init(&simp, TRACK_TOLERANCE, TRACK_WINDOW);
+
+    trace_reader_t r;
+    trace_event_t ev;
+    uint32_t counts[TRACE_CH_COUNT] = {0};
+    uint32_t zone_events = 0, last_ms = 0;
+    bool emergency = false, first = true;
+    uint32_t b_presses = 0;
+    bool b_triggered = false;
+    trace_reader_init(&r, data, len);
+    while (trace_next(&r, &ev)) {
+        counts[ev.ch]++;
+        uint32_t now_ms = ev.t_us / 1000;
+        if (ev.ch == TRACE_CH_BUTTON) {
+            if (verbose) printf("[%10.3f ms] botao %d: gesto %d (%d ms)\n", ev.t_us / 1000.0, (int)ev.v[0],
+                                (int)ev.v[1], (int)(ev.v[2] / 1000));
+            // Como no finalv3: a 2ª pressão do B ativa, o triplo de outro gesto desativa
+            if (ev.v[0] == BUTTON_B && ev.v[1] == BUTTON_PRESS) {
+                if (++b_presses == 2 && !emergency) emergency = b_triggered = true;
+            } else if (ev.v[0] == BUTTON_B) {
+                if (ev.v[1] == BUTTON_TRIPLE && !b_triggered) emergency = false;
+                b_presses = 0;
+                b_triggered = false;
+            }
+            digest_add(ev.v, sizeof(ev.v));
+        } else if (ev.ch == TRACE_CH_JOYSTICK) {
+            int32_t x = ev.v[0], y = ev.v[1];
+            geofence_event_t events[GEOFENCE_MAX_EVENTS];
+            uint32_t n = geofence_update(&fence, x, y, events);
+            for (uint32_t i = 0; i < n; i++) {
+                if (verbose)
+                    printf("[%10.3f ms] zona %d: %s (acao %d)\n", ev.t_us / 1000.0, events[i].zone,
+                           events[i].type == GEOFENCE_ENTER ? "entrada" : "saida", events[i].action);
+                digest_add(&events[i], sizeof(events[i]));
+                digest_add(&now_ms, sizeof(now_ms));
+            }
+            zone_events += n;
+
+            uint8_t flags = 0;
+            if (geofence_action(&fence) >= GEOFENCE_ACTION_ALERT) flags |= TRACK_FLAG_OUT_OF_RANGE;
+            if (emergency) flags |= TRACK_FLAG_EMERGENCY;
+            track_record_t kept[TRACK_SIMPLIFY_MAX_OUT];
+            uint32_t k = track_simplify_push(&simp, now_ms, (int16_t)x, (int16_t)y, flags, kept);
+            for (uint32_t i = 0; i < k; i++) track_append(&track, kept[i].t_ms, kept[i].x, kept[i].y, kept[i].flags);
+            heatmap_dwell(&heat, x, y, first ? 0 : now_ms - last_ms);
+            last_ms = now_ms;
+            first = false;
+        } else if (verbose) {
+            printf("[%10.3f ms] canal %d: %u bytes\n", ev.t_us / 1000.0, ev.ch, (unsigned)ev.len);
+        }
+    }
+
+    track_record_t last;
+    if (track_simplify_flush(&simp, &last)) track_append(&track, last.t_ms, last.x, last.y, last.flags);
+    track_query(&track, 0, UINT32_MAX, digest_record, NULL);
+    digest_add(heat.cells, sizeof(heat.cells));
+
+    uint32_t samples = 0;
+    for (int i = 0; i < TRACE_CH_COUNT; i++) samples += counts[i];
+    printf("%zu bytes, %u eventos (%.2f bytes/evento): joystick %u, botoes %u, acelerometro %u, gps %u\n", len,
+           samples, samples ? (double)len / samples : 0.0, counts[TRACE_CH_JOYSTICK], counts[TRACE_CH_BUTTON],
+           counts[TRACE_CH_ACCEL], counts[TRACE_CH_GPS]);
+    printf("%u registros perdidos na gravacao, %u invalidos na leitura, %u blocos com CRC errado, %u eventos sem "
+           "conferencia\n",
+           r.dropped, r.errors, r.crc_errors, r.unverified);
+    printf("trajeto: %u amostras, %u pontos gravados (%.2f:1, tolerancia %d)\n", simp.points_in, simp.points_out,
+           simp.points_out ? (double)simp.points_in / simp.points_out : 0.0, TRACK_TOLERANCE);
+    printf("%u eventos de zona, resumo %08x\n", zone_events, digest);
+    free(data);
+    return 0;
+}
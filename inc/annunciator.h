@@ -0,0 +1,95 @@
+#ifndef ANNUNCIATOR_H
+#define ANNUNCIATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+
+// =====================
+// Sinalizador (LEDs e buzzer) temporizado por hardware
+// =====================
+// Os padrões são declarativos (piscar N vezes, bip intermitente, sirene) e
+// são convertidos uma única vez numa tabela de níveis de PWM, guardada
+// enquanto o firmware roda; tocar o padrão de novo só reprograma o DMA. Canais de DMA
+// copiam essa sequência para os registradores das slices de PWM dos LEDs e
+// da buzzer, um passo por volta de uma slice de PWM livre usada como
+// marcador de tempo. Padrões contínuos se repetem por encadeamento de DMA
+// (um canal de controle reinicia o canal de dados), então depois de
+// annun_play a CPU não faz mais nada; padrões finitos geram uma única
+// interrupção ao terminar, para devolver a saída à camada de baixo.
+//
+// Camadas: cada camada guarda o seu padrão e a de maior prioridade controla
+// todas as saídas. Parar a emergência devolve os LEDs à camada de zona ou de
+// inatividade sem que o chamador precise reiniciá-las.
+
+typedef enum {
+    ANNUN_BUZZER = 0,
+    ANNUN_LED_GREEN,
+    ANNUN_LED_BLUE,
+    ANNUN_LED_RED,
+    ANNUN_OUT_COUNT
+} annun_out_t;
+
+typedef enum {
+    ANNUN_LAYER_INACTIVITY = 0, // Alertas de inatividade
+    ANNUN_LAYER_ZONE,           // Zona restrita (geofence)
+    ANNUN_LAYER_EMERGENCY,      // Emergência: sobrepõe todas as outras
+    ANNUN_LAYER_COUNT
+} annun_layer_t;
+
+#define ANNUN_LEVEL_MAX 1000   // Nível máximo (TOP das slices de PWM)
+#define ANNUN_MAX_STEPS 256    // Passos por sequência (padrão finito: todas as repetições)
+#define ANNUN_MAX_STEP_MS 50   // Maior passo aceito pelo marcador de tempo
+#define ANNUN_SWEEP_STEP_MS 20 // Passo máximo com varredura de frequência
+
+#ifndef ANNUN_MAX_PATTERNS
+#define ANNUN_MAX_PATTERNS 8   // Padrões convertidos guardados
+#endif
+#ifndef ANNUN_POOL_STEPS
+#define ANNUN_POOL_STEPS 512   // Passos de todas as tabelas guardadas, somados
+#endif
+
+#ifndef ANNUN_PACER_SLICE
+#define ANNUN_PACER_SLICE 0    // Slice de PWM sem pinos usada como marcador de tempo
+#endif
+
+// Onda retangular de uma saída. on_ms = 0 deixa a saída desligada; off_ms = 0
+// a deixa ligada o ciclo todo. phase_ms atrasa o início (LEDs alternados).
+typedef struct {
+    uint16_t on_ms;
+    uint16_t off_ms;
+    uint16_t phase_ms;
+    uint16_t level; // 0..ANNUN_LEVEL_MAX
+} annun_wave_t;
+
+typedef struct {
+    annun_wave_t out[ANNUN_OUT_COUNT];
+    uint16_t period_ms;   // Duração de um ciclo do padrão
+    uint16_t sweep_lo_hz; // Sirene: a buzzer varre de lo a hi e volta em um ciclo
+    uint16_t sweep_hi_hz; // (0 = tom fixo da buzzer)
+    uint8_t repeat;       // 0 = contínuo até annun_stop; N = N ciclos
+} annun_pattern_t;
+
+// Configura as slices de PWM e os canais de DMA. pins[] segue annun_out_t.
+void annun_init(const uint pins[ANNUN_OUT_COUNT], uint16_t buzzer_hz);
+
+// Converte o padrão na sua tabela (uma vez; chamadas seguintes não fazem
+// nada). A conversão percorre todos os passos, com divisões de 64 bits na
+// sirene: deve ser feita no laço ou na inicialização, não em interrupções.
+// Retorna false se o padrão não cabe em ANNUN_MAX_STEPS passos ou se não há
+// mais espaço (ANNUN_MAX_PATTERNS, ANNUN_POOL_STEPS).
+bool annun_prepare(const annun_pattern_t *pattern);
+
+// Associa um padrão à camada, convertendo-o antes se preciso. Chamar de novo
+// com o mesmo padrão não o reinicia. Retorna false como annun_prepare. Pode
+// ser chamada de interrupções com um padrão já preparado: aí só reprograma os
+// canais de DMA.
+bool annun_play(annun_layer_t layer, const annun_pattern_t *pattern);
+
+// Remove o padrão da camada; a camada ativa de maior prioridade assume.
+void annun_stop(annun_layer_t layer);
+
+// true se a camada ainda tem padrão (padrões finitos saem ao terminar)
+bool annun_active(annun_layer_t layer);
+
+#endif // ANNUNCIATOR_H
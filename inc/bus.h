@@ -0,0 +1,117 @@
+#ifndef BUS_H
+#define BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Barramento de amostras (publicação/assinatura)
+// =====================
+// Cada produtor publica uma amostra datada num tópico: ADC do joystick ou
+// posição por RSSI, acelerômetro, sentença do GPS. Cada consumidor tem o
+// seu cursor (bus_sub_t) e lê no próprio ritmo. A amostra é lida direto do
+// buffer circular do tópico, sem cópia. Um consumidor lento não atrasa o
+// produtor nem os outros consumidores. Quando o produtor dá a volta no
+// buffer, as amostras não lidas são perdidas e contadas como 'lost' no
+// assinante. Assim, outro consumidor pode entrar sem outra leitura do sensor.
+//
+// Sem trava: o cabeçalho de cada posição funciona como seqlock. O produtor
+// marca a posição como ocupada, escreve os dados e grava o número de ordem.
+// bus_release() confere que o número não mudou durante a leitura; se mudou,
+// a amostra foi sobrescrita no meio e a leitura deve ser descartada.
+// Cada tópico aceita um único produtor, e cada assinante deve ser lido de um
+// único contexto (laço principal ou uma mesma interrupção).
+//
+//   const bus_position_t *p;
+//   uint64_t t;
+//   while ((p = bus_peek(&sub, &t))) {
+//       usa(p->x, p->y, t);
+//       bus_release(&sub);
+//   }
+
+#define BUS_GPS_MAX 100 // Bytes de uma sentença NMEA (com o '\0')
+
+// Origem de uma posição
+#define BUS_SRC_JOYSTICK 0
+#define BUS_SRC_RSSI     1
+
+typedef struct {
+    uint16_t x, y; // Posição (0..4095)
+    uint8_t source; // BUS_SRC_*
+} bus_position_t;
+
+typedef struct {
+    int16_t raw[3]; // Registros crus do MPU6050
+    float g[3];     // Mesmos valores em g
+} bus_accel_t;
+
+typedef struct {
+    char sentence[BUS_GPS_MAX];
+} bus_gps_t;
+
+// Tópicos: nome, tipo da amostra e profundidade do buffer (potência de 2).
+// A profundidade é quantas amostras um consumidor pode ficar para trás sem
+// perder nenhuma.
+#define BUS_TOPICS(X)                      \
+    X(BUS_POSITION, bus_position_t, 8)     \
+    X(BUS_ACCEL,    bus_accel_t,    8)     \
+    X(BUS_GPS,      bus_gps_t,      4)
+
+#define BUS_ENUM_ID(name, type, depth) name,
+
+typedef enum {
+    BUS_TOPICS(BUS_ENUM_ID)
+    BUS_TOPIC_COUNT
+} bus_topic_t;
+
+typedef struct bus_sub {
+    bus_topic_t topic;
+    uint32_t next;         // Número de ordem da próxima amostra
+    uint32_t read;         // Amostras lidas
+    uint32_t lost;         // Amostras sobrescritas antes da leitura
+    struct bus_sub *link;  // Próximo assinante do mesmo tópico (estatísticas)
+} bus_sub_t;
+
+typedef struct {
+    uint32_t published;    // Amostras publicadas
+    uint32_t rate_mhz;     // Taxa de publicação na última janela (mHz)
+    uint32_t subscribers;
+    uint32_t lost;         // Soma das perdas dos assinantes
+    uint32_t max_lag;      // Maior atraso atual de um assinante (amostras)
+} bus_stats_t;
+
+#define BUS_RATE_WINDOW_US 10000000 // Janela da taxa de publicação
+
+// =====================
+// Produtor
+// =====================
+// bus_claim() devolve a área da próxima amostra (a mais antiga do buffer),
+// já marcada como ocupada. O produtor preenche e chama bus_publish() com o
+// instante da leitura (time_us_64).
+void *bus_claim(bus_topic_t topic);
+void bus_publish(bus_topic_t topic, uint64_t t_us);
+
+// =====================
+// Assinante
+// =====================
+// Começa a ler a partir da próxima publicação.
+void bus_subscribe(bus_sub_t *sub, bus_topic_t topic);
+
+// Próxima amostra não lida (NULL se não houver). O ponteiro vale até
+// bus_release(), que avança o cursor e devolve false se a amostra foi
+// sobrescrita durante a leitura (e deve ser descartada).
+const void *bus_peek(bus_sub_t *sub, uint64_t *t_us);
+bool bus_release(bus_sub_t *sub);
+
+// Amostra mais recente, já lida ou não (NULL se nada foi publicado). Pula as
+// intermediárias sem contá-las como perdidas; também termina com
+// bus_release().
+const void *bus_latest(bus_sub_t *sub, uint64_t *t_us);
+
+// =====================
+// Estatísticas
+// =====================
+void bus_get_stats(bus_topic_t topic, bus_stats_t *stats);
+const char *bus_topic_name(bus_topic_t topic);
+
+#endif // BUS_H
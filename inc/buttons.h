@@ -0,0 +1,69 @@
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+
+// =====================
+// Botões com debounce em PIO e reconhecimento de gestos
+// =====================
+// Cada botão tem uma máquina de estados PIO (button_debounce.pio) que só
+// informa mudanças que ficaram estáveis durante a janela de debounce; a CPU
+// recebe uma interrupção por pressão/soltura confirmada, nunca por ruído.
+// O reconhecedor transforma essas bordas em gestos: clique simples, duplo,
+// triplo e pressão longa. Como um clique simples só é confirmado quando o
+// intervalo para o próximo expira, os timeouts usam alarmes do timer; quem
+// precisa reagir sem essa espera usa BUTTON_PRESS, entregue a cada pressão.
+//
+// Os instantes são os das bordas no pino, gravados pela própria PIO na
+// palavra da FIFO: uma interrupção atendida com atraso (as gravações na
+// flash mascaram as interrupções) não muda o instante nem a classificação
+// do gesto. BUTTON_PRESS sai na confirmação, uma janela de debounce depois
+// da borda.
+//
+// O callback é chamado em contexto de interrupção (PIO ou alarme).
+
+#define BUTTONS_MAX 4                 // Uma máquina de estados por botão (um bloco PIO)
+#define BUTTONS_DEBOUNCE_US 10000     // Janela de estabilidade padrão
+#define BUTTONS_MULTI_GAP_MS 400      // Intervalo máximo entre pressões de um clique múltiplo
+#define BUTTONS_LONG_MS 1000          // Pressão longa
+
+typedef enum {
+    BUTTON_PRESS = 0,     // Cada pressão confirmada, sem esperar o gesto
+    BUTTON_SINGLE,
+    BUTTON_DOUBLE,
+    BUTTON_TRIPLE,
+    BUTTON_LONG,
+} button_gesture_t;
+
+typedef struct {
+    uint8_t gpio;         // Pino do botão
+    uint8_t gesture;      // button_gesture_t
+    uint32_t t_us;        // Borda da primeira pressão do gesto (time_us_32)
+    uint32_t duration_us; // Da primeira pressão até a última soltura (ou até virar longa)
+} button_event_t;
+
+typedef void (*button_callback_t)(const button_event_t *ev);
+
+typedef struct {
+    uint32_t debounce_us;
+    uint32_t multi_gap_ms;
+    uint32_t long_ms;
+} buttons_config_t;
+
+#define BUTTONS_CONFIG_DEFAULT {BUTTONS_DEBOUNCE_US, BUTTONS_MULTI_GAP_MS, BUTTONS_LONG_MS}
+
+// Configura os pinos (entrada com pull-up), carrega o programa no pio0 e
+// habilita as interrupções. 'count' <= BUTTONS_MAX.
+void buttons_init(const uint *pins, uint count, const buttons_config_t *config, button_callback_t callback);
+
+// true enquanto o botão está pressionado (estado já sem ruído)
+bool buttons_is_pressed(uint gpio);
+
+// true da primeira pressão até o gesto ser entregue (inclusive a pressão
+// longa): o laço adia as gravações na flash enquanto uma ativação pelo
+// botão ainda pode chegar.
+bool buttons_gesture_pending(uint gpio);
+
+#endif // BUTTONS_H
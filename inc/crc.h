@@ -0,0 +1,63 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// =====================
+// CRC dos quadros de rádio, das páginas do trajeto e do estado preservado
+// =====================
+// Dois CRCs, os mesmos em todo o firmware:
+//
+//   CRC-32       (IEEE 802.3 / zlib, polinômio refletido 0xEDB88320):
+//                crc = crc32_update(CRC32_INIT, ...) por partes; o valor
+//                final é ~crc (ou crc32() de uma vez).
+//   CRC-16/CCITT (polinômio 0x1021, estado inicial 0xFFFF, sem inversão
+//                final, "CCITT-FALSE"): sufixo dos quadros LoRa.
+//
+// No alvo (CRC_SNIFFER = 1) o cálculo é feito pelo sniffer do DMA: os bytes
+// passam por um canal de DMA e o sniffer acumula o CRC de tudo o que o canal
+// lê. crc16_ccitt_copy e crc32_copy aproveitam a cópia que já seria feita
+// (ex.: o quadro urgente para o buffer do DMA da UART) e devolvem o CRC sem
+// uma segunda passada pelos dados. Trechos menores que CRC_DMA_MIN e as
+// chamadas antes de crc_init usam a tabela de 256 entradas.
+//
+// O sniffer é um só: cada cálculo mascara as interrupções enquanto o usa
+// (uma página de 256 bytes leva ~3 µs). crc_init confere o sniffer contra a
+// tabela; se algum resultado diferir, o firmware segue só com a tabela.
+//
+// No build de host (CRC_SNIFFER = 0) só existe a tabela. A suíte do host
+// confere a tabela contra a implementação bit a bit e os valores de
+// referência ("123456789": CRC-32 0xCBF43926, CRC-16 0x29B1).
+
+#ifndef CRC_SNIFFER
+#define CRC_SNIFFER 1
+#endif
+
+#define CRC32_INIT 0xFFFFFFFFu
+#define CRC16_CCITT_INIT 0xFFFFu
+#define CRC_DMA_MIN 16 // Abaixo disso a tabela é mais rápida que programar o DMA
+
+// Reserva um canal de DMA e confere o sniffer. true se o sniffer será usado
+// (sempre false no host ou sem canal livre).
+bool crc_init(void);
+
+uint32_t crc32_update(uint32_t crc, const void *data, size_t len);
+uint16_t crc16_ccitt_update(uint16_t crc, const void *data, size_t len);
+
+// CRC-32 completo (estado inicial e inversão final)
+static inline uint32_t crc32(const void *data, size_t len) {
+    return ~crc32_update(CRC32_INIT, data, len);
+}
+
+// Copiam 'len' bytes de 'src' para 'dst' (sem sobreposição) e continuam o
+// CRC sobre os bytes copiados.
+uint32_t crc32_copy(void *dst, const void *src, size_t len, uint32_t crc);
+uint16_t crc16_ccitt_copy(void *dst, const void *src, size_t len, uint16_t crc);
+
+// Versões só por tabela: referência da conferência do sniffer
+uint32_t crc32_update_sw(uint32_t crc, const void *data, size_t len);
+uint16_t crc16_ccitt_update_sw(uint16_t crc, const void *data, size_t len);
+
+#endif // CRC_H
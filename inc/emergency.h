@@ -0,0 +1,61 @@
+#ifndef EMERGENCY_H
+#define EMERGENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hardware/uart.h"
+
+// =====================
+// Caminho rápido da emergência (botão -> rádio)
+// =====================
+// emergency_trigger() é chamada direto do tratamento do botão (interrupção).
+// Ela monta o quadro "EMERGENCIA <n>: <posição>\n" a partir da última
+// posição guardada pelo laço (emergency_set_fix), sem formatação, e o entrega
+// ao rádio com lora_send_urgent, que interrompe qualquer mensagem comum em
+// andamento. Display, GPS e as esperas do laço ficam de fora do caminho: a
+// interrupção os preempta.
+//
+// O pior caso até o primeiro byte na UART é o tempo de dois bytes de uma
+// mensagem comum à frente (lora.h, ~2 ms a 9600 baud) mais a cópia do quadro. A latência de
+// cada ativação (do gatilho e da pressão do botão até o primeiro byte) é
+// medida e entregue ao laço por emergency_poll_report. A pressão é a borda
+// no pino, gravada pela PIO (buttons.h): a medida inclui a janela de
+// debounce e o atraso no atendimento da interrupção, por exemplo durante uma
+// gravação na flash. O orçamento é contado dessa borda, então o gatilho
+// deve sair na própria pressão, não no fim do gesto.
+//
+// O quadro é repetido nos instantes de EMERGENCY_RETRY_MS (contados a
+// partir do gatilho) com a posição mais recente, até emergency_cancel.
+
+#define EMERGENCY_FIX_MAX 100
+#define EMERGENCY_BUDGET_US 15000 // Da borda: 10 ms de debounce + 5 ms até o primeiro byte
+#define EMERGENCY_RETRY_MS {1000, 3000, 7000, 15000, 30000}
+
+typedef struct {
+    uint32_t triggers;   // Ativações
+    uint32_t frames;     // Quadros enviados (inclui repetições)
+    uint32_t last_us;    // Gatilho -> primeiro byte na UART (última ativação)
+    uint32_t max_us;     // Pior caso observado (da pressão)
+    uint32_t press_us;   // Pressão do botão -> primeiro byte (última ativação)
+    uint32_t over_budget; // Ativações com press_us acima de EMERGENCY_BUDGET_US
+} emergency_stats_t;
+
+// 'radio' já inicializada com uart_init e lora_init.
+void emergency_init(uart_inst_t *radio);
+
+// Guarda a posição mais recente para os quadros (laço principal).
+void emergency_set_fix(const char *fix);
+
+// Envia o quadro imediatamente e (re)inicia as repetições. 'press_us' é o
+// instante (time_us_32) da pressão que originou o gatilho.
+void emergency_trigger(uint32_t press_us);
+
+// Para as repetições.
+void emergency_cancel(void);
+
+bool emergency_is_active(void);
+
+// true uma vez após cada ativação, com as estatísticas atualizadas.
+bool emergency_poll_report(emergency_stats_t *out);
+
+#endif // EMERGENCY_H
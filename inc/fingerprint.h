@@ -0,0 +1,91 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Localização por impressão digital de RSSI
+// =====================
+// Uma pesquisa de campo registra, em pontos de referência com posição
+// conhecida, a potência (RSSI) recebida de cada beacon/AP do local.
+// tools/gen_fingerprints.py converte essa pesquisa em tabelas const (na
+// flash): um vetor int8 em dBm por ponto (piso FP_RSSI_FLOOR para beacons
+// não ouvidos) e um índice grosso que agrupa os pontos pelo beacon mais
+// forte. Uma varredura só é comparada aos grupos dos seus FP_PROBE_GROUPS
+// beacons mais fortes, o que mantém a busca abaixo de 1 ms mesmo com
+// milhares de pontos.
+//
+// A posição é a média dos FP_K vizinhos mais próximos (distância euclidiana
+// em dB) ponderada pelo inverso da distância ao quadrado. A confiança
+// (0 a 100) cai com o erro RMS do melhor vizinho e com a dispersão dos
+// vizinhos em torno da estimativa.
+//
+// As varreduras chegam por uma fonte plugável (fp_source_t): o rádio
+// Wi-Fi do Pico W no firmware, varreduras gravadas ou sintéticas no host.
+
+// Com FP_ENABLED = 0 (padrão) o firmware ignora a localização por RSSI.
+// No CMake: -DBADGE_WIFI_LOCALIZATION=ON.
+#ifndef FP_ENABLED
+#define FP_ENABLED 0
+#endif
+
+#define FP_MAX_APS 64          // Beacons por base
+#define FP_SCAN_MAX 32         // Beacons por varredura
+#define FP_RSSI_FLOOR (-100)   // dBm atribuído a beacons não ouvidos
+#define FP_RSSI_CEIL (-20)
+#define FP_K 4                 // Vizinhos ponderados
+#define FP_PROBE_GROUPS 3      // Grupos do índice visitados por consulta
+#define FP_MIN_APS 3           // Beacons ouvidos para tentar uma estimativa
+#define FP_RMS_BAD_DB 12       // Erro RMS (dB) com confiança zero
+#define FP_SPREAD_BAD 512      // Dispersão dos vizinhos (unidades de posição) com confiança zero
+
+typedef struct {
+    uint8_t id[6]; // BSSID do AP (ou identificador do beacon)
+} fp_ap_id_t;
+
+typedef struct {
+    const fp_ap_id_t *aps;      // ap_count identificadores em ordem crescente
+    const int8_t *rssi;         // point_count x ap_count (dBm)
+    const int16_t *pos;         // point_count x 2 (x, y)
+    const uint16_t *group_start; // ap_count + 1: pontos agrupados pelo beacon mais forte
+    uint16_t ap_count;
+    uint16_t point_count;
+} fp_db_t;
+
+typedef struct {
+    uint8_t count;
+    struct {
+        fp_ap_id_t id;
+        int8_t rssi;
+    } ap[FP_SCAN_MAX];
+} fp_scan_t;
+
+typedef struct {
+    int32_t x, y;
+    uint8_t confidence; // 0 a 100
+    uint8_t heard;      // Beacons da varredura presentes na base
+    uint16_t compared;  // Pontos de referência comparados
+} fp_estimate_t;
+
+// Fonte de varreduras: poll() devolve true quando 'scan' recebeu uma
+// varredura nova (sem bloquear).
+typedef struct {
+    bool (*poll)(void *ctx, fp_scan_t *scan);
+    void *ctx;
+} fp_source_t;
+
+// Base padrão gerada a partir de fingerprints.json (fingerprint_db.c)
+extern const fp_db_t fingerprint_db;
+
+// Estima a posição de uma varredura. false se a varredura tem menos de
+// FP_MIN_APS beacons conhecidos.
+bool fp_locate(const fp_db_t *db, const fp_scan_t *scan, fp_estimate_t *out);
+
+// Consulta a fonte e, havendo varredura nova, atualiza 'out'.
+bool fp_update(const fp_source_t *src, const fp_db_t *db, fp_estimate_t *out);
+
+// Fonte do rádio Wi-Fi do Pico W (fingerprint_cyw43.c); inicializa o CYW43.
+bool fp_cyw43_init(fp_source_t *src);
+
+#endif // FINGERPRINT_H
@@ -0,0 +1,91 @@
+#ifndef GEOFENCE_H
+#define GEOFENCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Cerca virtual (geofence) com índice em grade
+// =====================
+// As zonas (polígonos com prioridade e ação) são definidas em zonas.json e
+// convertidas por tools/gen_zonas.py em geofence_zonas.c: tabelas const (na
+// flash) já distribuídas numa grade uniforme. Cada amostra de posição testa
+// apenas as zonas da sua célula e as zonas em que o crachá já está, então o
+// custo por amostra não cresce com o número total de zonas.
+//
+// Histerese: entra-se numa zona ao ficar dentro do polígono; sai-se apenas
+// quando a distância até a borda passa de 'hysteresis' (unidades do mapa),
+// evitando eventos repetidos com a posição oscilando na borda.
+
+#define GEOFENCE_MAX_ACTIVE 8         // Zonas simultâneas acompanhadas
+#define GEOFENCE_MAX_ZONES_PER_CELL 16 // Limite garantido pelo gerador
+#define GEOFENCE_MAX_VERTICES 32      // Limite garantido pelo gerador
+#define GEOFENCE_NO_ZONE 0xFFFF
+
+typedef enum {
+    GEOFENCE_ACTION_NONE = 0,
+    GEOFENCE_ACTION_LOG,   // Apenas registra entrada/saída
+    GEOFENCE_ACTION_WARN,  // Aviso discreto
+    GEOFENCE_ACTION_ALERT, // Área restrita: alerta visual e sonoro
+} geofence_action_t;
+
+typedef struct {
+    int16_t x, y;
+} geofence_point_t;
+
+typedef struct {
+    uint16_t first_vertex;  // Índice em geofence_map_t.vertices
+    uint8_t vertex_count;
+    uint8_t priority;       // Maior valor vence quando há zonas sobrepostas
+    uint8_t action;         // geofence_action_t
+    int16_t min_x, min_y, max_x, max_y; // Retângulo envolvente
+} geofence_zone_t;
+
+typedef struct {
+    const geofence_point_t *vertices;
+    const geofence_zone_t *zones;
+    uint16_t zone_count;
+    const uint16_t *cell_start; // grid_w * grid_h + 1 posições em cell_zones
+    const uint16_t *cell_zones; // Zonas candidatas de cada célula
+    int16_t x0, y0;             // Origem da grade
+    uint8_t cell_shift;         // Célula de 2^cell_shift unidades
+    uint8_t grid_w, grid_h;
+    uint16_t hysteresis;
+} geofence_map_t;
+
+typedef enum {
+    GEOFENCE_ENTER,
+    GEOFENCE_EXIT,
+} geofence_event_type_t;
+
+typedef struct {
+    uint16_t zone;
+    uint8_t type;   // geofence_event_type_t
+    uint8_t action; // Ação da zona
+} geofence_event_t;
+
+// Máximo de eventos gerados por uma amostra
+#define GEOFENCE_MAX_EVENTS (GEOFENCE_MAX_ACTIVE + GEOFENCE_MAX_ZONES_PER_CELL)
+
+typedef struct {
+    const geofence_map_t *map;
+    uint16_t active[GEOFENCE_MAX_ACTIVE];
+    uint8_t active_count;
+} geofence_t;
+
+// Mapa padrão gerado a partir de zonas.json (geofence_zonas.c)
+extern const geofence_map_t geofence_map;
+
+void geofence_init(geofence_t *g, const geofence_map_t *map);
+
+// Avalia uma posição. Escreve os eventos de entrada/saída em 'events'
+// (capacidade GEOFENCE_MAX_EVENTS) e retorna quantos foram gerados.
+uint32_t geofence_update(geofence_t *g, int32_t x, int32_t y, geofence_event_t *events);
+
+// Zona ativa de maior prioridade (GEOFENCE_NO_ZONE se nenhuma).
+uint16_t geofence_top_zone(const geofence_t *g);
+
+// Ação da zona ativa de maior prioridade (GEOFENCE_ACTION_NONE se nenhuma).
+geofence_action_t geofence_action(const geofence_t *g);
+
+#endif // GEOFENCE_H
@@ -0,0 +1,62 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+#include "geofence.h"
+
+// =====================
+// Mapa de ocupação (tempo de permanência por célula)
+// =====================
+// Grade fixa de contadores de 8 bits com saturação: cada amostra de posição
+// soma o tempo passado na célula (O(1)). Um decaimento exponencial (x 7/8
+// por HEATMAP_DECAY_PERIOD_MS) percorre a grade algumas linhas por amostra,
+// então o custo por amostra continua limitado e os valores não crescem sem
+// limite: o mapa mostra onde o crachá esteve nos últimos minutos.
+//
+// O minimapa reduz a grade (média de 2^shift x 2^shift células por pixel)
+// e a converte em pixels com pontilhado ordenado (Bayer 4x4), escrevendo
+// direto no buffer do ssd1306_t. Os contornos das zonas do geofence são
+// rasterizados uma vez em heatmap_view_init e só combinados a cada quadro.
+
+#define HEATMAP_COLS 128              // Células por linha
+#define HEATMAP_ROWS 128              // Linhas
+#define HEATMAP_MS_PER_COUNT 250      // Permanência representada por uma unidade
+#define HEATMAP_DECAY_PERIOD_MS 60000 // Uma passada completa de decaimento
+#define HEATMAP_DECAY_MAX_ROWS 8      // Linhas decaídas por amostra, no máximo
+
+#define HEATMAP_VIEW_MAX_BYTES ((HEATMAP_COLS / 2) * (HEATMAP_ROWS / 2) / 8) // shift >= 1
+
+typedef struct {
+    uint8_t cells[HEATMAP_ROWS][HEATMAP_COLS] __attribute__((aligned(4)));
+    int16_t x0, y0;      // Origem da grade (unidades de posição)
+    uint8_t cell_shift;  // Célula de 2^cell_shift unidades
+    uint8_t peak;        // Maior contador (decai junto com a grade)
+    uint16_t decay_row;  // Próxima linha a decair
+    uint32_t decay_acc;  // Tempo acumulado (ms x HEATMAP_ROWS) ainda não decaído
+    uint32_t dwell_acc;  // Resto de permanência (< HEATMAP_MS_PER_COUNT)
+} heatmap_t;
+
+typedef struct {
+    uint8_t x, y;   // Canto superior esquerdo no display (y múltiplo de 8)
+    uint8_t shift;  // Redução: 2^shift células por pixel em cada eixo (>= 1)
+    uint8_t w, h;   // Tamanho em pixels
+    uint8_t outline[HEATMAP_VIEW_MAX_BYTES]; // Contornos das zonas, em páginas do SSD1306
+} heatmap_view_t;
+
+void heatmap_init(heatmap_t *h, int16_t x0, int16_t y0, uint8_t cell_shift);
+
+// Soma dt_ms de permanência na célula de (x, y) e avança o decaimento.
+// Posições fora da grade só avançam o decaimento.
+void heatmap_dwell(heatmap_t *h, int32_t x, int32_t y, uint32_t dt_ms);
+
+// Prepara o minimapa e rasteriza os contornos de 'map' (pode ser NULL).
+void heatmap_view_init(heatmap_view_t *v, const heatmap_t *h, uint8_t x, uint8_t y, uint8_t shift,
+                       const geofence_map_t *map);
+
+// Desenha o minimapa no buffer do display (sem enviar) com um cursor na
+// posição (cur_x, cur_y).
+void heatmap_draw(const heatmap_t *h, const heatmap_view_t *v, ssd1306_t *dev, int32_t cur_x, int32_t cur_y);
+
+#endif // HEATMAP_H
@@ -0,0 +1,62 @@
+#ifndef LORA_H
+#define LORA_H
+
+#include "hardware/uart.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// A recepção (lora_rx_init, lora_read_line, ...) só existe com LORA_RX = 1.
+// O projetoreal a liga (-DLORA_RX=1); o finalv3 só transmite e fica sem o
+// buffer de recepção e a interrupção da UART.
+#ifndef LORA_RX
+#define LORA_RX 0
+#endif
+
+#define LORA_URGENT_MAX 160 // Maior quadro urgente (bytes)
+#define LORA_RX_BUF 1024    // Bytes recebidos guardados pela interrupção (~1 s a 9600 baud)
+#define LORA_LINE_MAX 64    // Maior linha recebida; as mais longas são descartadas
+#define LORA_CRC_LEN 5      // "*HHHH": CRC-16/CCITT (crc.h) no fim de cada mensagem
+
+// Cada mensagem enviada termina com "*HHHH\n", o CRC-16/CCITT em hexadecimal
+// de tudo o que vem antes do último '*' (sem '\r' e '\n' finais da mensagem). As
+// linhas recebidas sem o CRC, ou com um CRC que não confere, são descartadas.
+
+// Prepara a UART do rádio (já inicializada com uart_init). As FIFOs ficam
+// ligadas: a de recepção guarda 32 bytes (~33 ms a 9600 baud) enquanto as
+// interrupções estão mascaradas. lora_send só põe um byte na FIFO de
+// transmissão quando ela está vazia, então no máximo dois bytes de uma
+// mensagem comum ficam à frente do primeiro byte urgente (~2 ms a 9600 baud).
+// Um quadro urgente substituído por outro pode ter até 32 bytes na FIFO, que
+// saem antes do '\n' que o encerra.
+void lora_init(uart_inst_t *uart);
+
+// Função para enviar mensagem via módulo LoRa. Espera um envio urgente em
+// andamento terminar e retorna false se for interrompida por outro.
+bool lora_send(uart_inst_t *uart, const char *message);
+
+// Envio urgente (pode ser chamada de interrupções): interrompe a mensagem
+// em andamento, que é terminada com '\n', e entrega 'frame' à UART por DMA,
+// sem esperar a transmissão. Retorna o instante (time_us_32) em que o
+// primeiro byte entrou na UART.
+uint32_t lora_send_urgent(uart_inst_t *uart, const char *frame, uint32_t len);
+
+#if LORA_RX
+// Liga a recepção: a interrupção da UART guarda os bytes num buffer
+// circular, então o laço principal pode demorar sem perder bytes, e a FIFO
+// de recepção cobre as máscaras curtas de interrupção (ver lora_init).
+void lora_rx_init(uart_inst_t *uart);
+
+// Copia para 'line' a próxima linha completa recebida, sem '\r', '\n' e o
+// CRC (que já foi conferido).
+// Retorna false se ainda não há linha completa (os bytes de uma linha
+// parcial ficam guardados para a próxima chamada).
+bool lora_read_line(char *line, uint32_t size);
+
+// Bytes perdidos com o buffer de recepção cheio
+uint32_t lora_rx_dropped(void);
+
+// Linhas descartadas por CRC ausente ou errado
+uint32_t lora_rx_crc_errors(void);
+#endif // LORA_RX
+
+#endif
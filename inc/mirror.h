@@ -0,0 +1,96 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Espelho do display pela USB
+// =====================
+// Enquanto houver um terminal conectado à USB (stdio_usb_connected), cada
+// quadro que ssd1306_show envia ao display também é enviado ao PC, mas só
+// quando muda. tools/mirror_view.py reconstrói a tela e registra o instante
+// de cada quadro.
+//
+// ssd1306_show entrega ao espelho o mesmo buffer que acabou de montar para a
+// escrita I2C (mirror_frame): se o conteúdo for igual ao último quadro
+// capturado, não há nada a fazer; senão ele é copiado (1 KB). Como
+// ssd1306_show também é chamada da interrupção dos botões, a cópia vai para
+// um quadro livre e só a troca do índice publicado é feita com as
+// interrupções mascaradas; comparação e cópia ficam fora da máscara. A
+// codificação fica para mirror_drain, no laço principal, e é incremental: cada chamada
+// envia no máximo 'max_bytes' e continua de onde parou na próxima, então o
+// custo por volta do laço é limitado e não atrasa os alertas.
+//
+// O quadro é codificado como a diferença (XOR) para o que o PC já tem, com
+// as sequências sem mudança puladas e as repetidas comprimidas (RLE). Cada
+// pacote na USB:
+//
+//   0xFE 0xEF | tamanho (1 B) | operações
+//
+// Operações, aplicadas a partir de um cursor no buffer do display (mesmo
+// layout do ssd1306_t: páginas de 8 linhas, um byte por coluna):
+//
+//   0x00-0x7F  pula n+1 bytes (sem mudança)
+//   0x80-0xBF  n+1 bytes seguintes: XOR com os bytes no cursor
+//   0xC0-0xEF  1 byte seguinte: XOR com os próximos n+3 bytes
+//   0xF0       fim do quadro: número (2 B LE), instante us (4 B LE); o
+//              cursor volta ao início
+//   0xF1       quadro-chave: largura (1 B), altura (1 B); a tela do PC é
+//              apagada e o cursor volta ao início
+//
+// Um quadro-chave é enviado ao conectar e, se a tela mudar, a cada
+// MIRROR_KEY_INTERVAL_MS, para o caso de o PC ter perdido bytes. Se o
+// display for redesenhado no meio da codificação, o resto do quadro sai com
+// o conteúdo novo e o quadro seguinte corrige a diferença.
+//
+// Com MIRROR_ENABLED = 0 as macros MIRROR_* viram código vazio.
+
+#ifndef MIRROR_ENABLED
+#define MIRROR_ENABLED 1
+#endif
+
+#define MIRROR_BYTES (128 * 64 / 8) // Maior buffer de display espelhado
+#define MIRROR_PACKET_MAX 255       // Bytes de operações por pacote
+#define MIRROR_DRAIN_BYTES 512      // Por volta do laço principal
+#define MIRROR_KEY_INTERVAL_MS 10000
+
+#define MIRROR_SYNC0 0xFE
+#define MIRROR_SYNC1 0xEF
+
+#define MIRROR_OP_SKIP 0x00
+#define MIRROR_OP_XOR 0x80
+#define MIRROR_OP_RUN 0xC0
+#define MIRROR_OP_END 0xF0
+#define MIRROR_OP_KEY 0xF1
+
+#define MIRROR_SKIP_MAX 128
+#define MIRROR_XOR_MAX 64
+#define MIRROR_RUN_MIN 3
+#define MIRROR_RUN_MAX 50
+
+typedef struct {
+    uint32_t frames;   // Quadros enviados
+    uint32_t keys;     // Quadros-chave entre eles
+    uint32_t bytes;    // Bytes na USB (pacotes completos)
+    uint32_t captured; // Quadros diferentes capturados (alguns substituídos antes do envio)
+} mirror_stats_t;
+
+// Chamada por ssd1306_show com o buffer da escrita I2C
+void mirror_frame(const uint8_t *buf, uint8_t width, uint8_t height);
+
+// Envia até 'max_bytes' do quadro pendente pela stdio. Retorna os bytes
+// enviados.
+uint32_t mirror_drain(uint32_t max_bytes);
+
+void mirror_get_stats(mirror_stats_t *stats);
+
+#if MIRROR_ENABLED
+#define MIRROR_FRAME(buf, width, height) mirror_frame((buf), (width), (height))
+#define MIRROR_DRAIN() mirror_drain(MIRROR_DRAIN_BYTES)
+#else
+#define MIRROR_FRAME(buf, width, height) ((void)0)
+#define MIRROR_DRAIN() ((void)0)
+#endif
+
+#endif // MIRROR_H
@@ -0,0 +1,108 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Instrumentação dos caminhos críticos
+// =====================
+// Sondas de tempo baseadas no contador de 1 MHz do timer (timer_hw->timerawl).
+// Cada sonda acumula mín/máx/média e um histograma log2 (balde k conta as
+// medidas em [2^(k-1), 2^k) us). O relatório sai pela stdio USB de forma
+// periódica (PROF_DUMP_INTERVAL_MS) ou sob demanda (tecla 'p'; 'r' zera).
+//
+// Com PROF_ENABLED = 0 (padrão) todas as macros viram código vazio.
+// No CMake: -DBADGE_PROFILE=ON (ou -DPROF_ENABLED=1 direto no compilador).
+//
+// Uma mesma sonda pode ser registrada do laço principal e de interrupções
+// (ex.: ssd1306_show, event_to_alarm): prof_record atualiza as estatísticas
+// com as interrupções mascaradas (~1 us).
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED 0
+#endif
+
+#ifndef PROF_DUMP_INTERVAL_MS
+#define PROF_DUMP_INTERVAL_MS 10000 // 0 = apenas sob demanda
+#endif
+
+typedef enum {
+    PROF_MAIN_LOOP,       // Uma iteração completa do laço principal
+    PROF_SSD1306_SHOW,    // Envio do buffer ao display
+    PROF_READ_JOYSTICK,   // Leitura dos dois canais do ADC
+    PROF_MPU6050_READ,    // Leitura do acelerômetro
+    PROF_GPS_READ,        // Leitura de uma sentença NMEA
+    PROF_LORA_SEND,       // Envio de uma mensagem LoRa
+    PROF_EVENT_TO_ALARM,  // Do botão de emergência até o 1º byte do alarme na UART (interrupção)
+    PROF_BUTTONS_IRQ,     // Interrupção dos botões, incluindo o tratamento dos gestos
+    PROF_BOOT_SAMPLE,     // Do reset até a primeira leitura do sensor de posição/movimento
+    PROF_BOOT_FRAME,      // Do reset até o primeiro quadro no display
+    PROF_FP_LOCATE,       // Localização por RSSI de uma varredura (fp_locate)
+    PROF_PROBE_COUNT
+} prof_probe_t;
+
+#define PROF_HIST_BUCKETS 24 // Até 2^23 us (~8,4 s); acima disso cai no último balde
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t hist[PROF_HIST_BUCKETS];
+} prof_stats_t;
+
+#if PROF_ENABLED
+
+#include "hardware/structs/timer.h"
+
+typedef struct {
+    uint8_t probe;
+    uint32_t start;
+} prof_scope_t;
+
+static inline uint32_t prof_now(void) {
+    return timer_hw->timerawl;
+}
+
+// Registra uma medida (em us) na sonda indicada.
+void prof_record(prof_probe_t probe, uint32_t elapsed_us);
+
+static inline prof_scope_t prof_scope_begin(prof_probe_t probe) {
+    prof_scope_t s = { (uint8_t)probe, prof_now() };
+    return s;
+}
+
+static inline void prof_scope_end(prof_scope_t *s) {
+    prof_record((prof_probe_t)s->probe, prof_now() - s->start);
+}
+
+// Imprime o relatório de todas as sondas com medidas.
+void prof_dump(void);
+// Zera todas as estatísticas.
+void prof_reset(void);
+// Chamar no laço principal: faz o despejo periódico e atende os comandos 'p'/'r'.
+void prof_poll(void);
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+
+// Mede do ponto da declaração até a saída do bloco (inclusive via continue/return).
+#define PROF_SCOPE(probe) \
+    prof_scope_t PROF_CONCAT(prof_scope_, __LINE__) __attribute__((cleanup(prof_scope_end))) = prof_scope_begin(probe)
+#define PROF_TIMESTAMP() prof_now()
+#define PROF_RECORD_SINCE(probe, start) prof_record((probe), prof_now() - (start))
+#define PROF_POLL() prof_poll()
+#define PROF_DUMP() prof_dump()
+
+#else
+
+#define PROF_SCOPE(probe) do { } while (0)
+#define PROF_TIMESTAMP() 0u
+#define PROF_RECORD_SINCE(probe, start) do { (void)(start); } while (0)
+#define PROF_POLL() do { } while (0)
+#define PROF_DUMP() do { } while (0)
+
+#endif // PROF_ENABLED
+
+#endif // PROF_H
@@ -0,0 +1,35 @@
+#ifndef RAM_HOT_H
+#define RAM_HOT_H
+
+// =====================
+// Caminhos quentes na SRAM
+// =====================
+// O código roda da flash QSPI através da cache XIP de 16 KB. Uma falha na
+// cache para a CPU enquanto a linha é lida da flash. Isso é pouco na média,
+// mas varia com o que rodou antes, e a variação aparece na latência das
+// interrupções e no tempo de desenho de cada quadro.
+//
+// Com RAM_HOT = 1 (-DBADGE_RAM_HOT=ON no CMake), as funções marcadas com
+// RAM_HOT_FUNC e os dados marcados com RAM_HOT_DATA vão para as seções
+// .time_critical do SDK, copiadas para a SRAM na partida. São marcados:
+// tratamento das interrupções (botões, DMA da sinalização, caminho da
+// emergência), rasterização do display (pixels, caracteres e fonte),
+// leitura dos sensores e a leitura das sentenças NMEA.
+//
+// Com RAM_HOT = 0 (padrão) as macros não mudam nada. O relatório do prof
+// (PROF_ENABLED) traz os contadores da cache XIP para comparar os dois modos.
+
+#ifndef RAM_HOT
+#define RAM_HOT 0
+#endif
+
+#if RAM_HOT
+#include "pico.h"
+#define RAM_HOT_FUNC(name) __not_in_flash_func(name)
+#define RAM_HOT_DATA(group) __not_in_flash(group)
+#else
+#define RAM_HOT_FUNC(name) name
+#define RAM_HOT_DATA(group)
+#endif
+
+#endif // RAM_HOT_H
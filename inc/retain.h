@@ -0,0 +1,56 @@
+#ifndef RETAIN_H
+#define RETAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Estado crítico preservado entre reinicializações
+// =====================
+// Um bloco em RAM não inicializada (__uninitialized_ram), que o runtime não
+// zera na partida. Depois de um reset pelo watchdog, pelo pino RUN ou por
+// software, o bloco ainda guarda o nível de alerta, a última posição, a
+// emergência e o tempo sem movimento. Assim, o crachá volta ao ponto em que
+// parou em vez de recomeçar do zero.
+//
+// Cada gravação leva um número mágico (que inclui o tamanho da estrutura,
+// para não aceitar o bloco de outra versão do firmware) e um CRC32. Ao ligar
+// a alimentação a RAM tem conteúdo aleatório, o CRC falha e retain_load
+// informa partida a frio.
+//
+// A gravação pode vir do laço e dos tratadores dos botões. retain_save monta
+// o bloco e o CRC fora da máscara e mascara só a cópia final (~120 bytes) e
+// o avanço da geração. Se uma interrupção gravou no meio, a gravação do laço
+// é recusada: o chamador relê o estado (retain_snapshot) e monta de novo, sem
+// desfazer o que a interrupção gravou. Quem chama a cada volta compara com o
+// snapshot e só grava o que mudou.
+
+#define RETAIN_FIX_MAX 96
+
+#define RETAIN_FLAG_EMERGENCY 0x01 // Emergência ativa
+#define RETAIN_FLAG_FIX_VALID 0x02 // 'fix' e 'x'/'y' têm uma posição
+
+typedef struct {
+    uint8_t alert_level;     // Nível de alerta do firmware (0 = nenhum)
+    uint8_t flags;           // RETAIN_FLAG_*
+    int16_t x, y;            // Última posição numérica (joystick)
+    uint32_t idle;           // Inatividade na gravação (unidade do firmware)
+    char fix[RETAIN_FIX_MAX]; // Última posição em texto (sentença do GPS)
+} retain_state_t;
+
+// true se havia um estado válido; 'out' recebe o estado e 'resets' (opcional)
+// quantas partidas a quente seguidas o bloco já atravessou.
+bool retain_load(retain_state_t *out, uint32_t *resets);
+
+// Copia o último estado gravado (zerado numa partida a frio) e devolve a
+// geração dele, para retain_save.
+uint32_t retain_snapshot(retain_state_t *out);
+
+// Grava 'state' se nenhuma outra gravação aconteceu depois da geração 'gen';
+// false se aconteceu (nada é gravado).
+bool retain_save(const retain_state_t *state, uint32_t gen);
+
+// Invalida o bloco (a próxima partida será a frio).
+void retain_clear(void);
+
+#endif // RETAIN_H
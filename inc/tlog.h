@@ -0,0 +1,85 @@
+#ifndef TLOG_H
+#define TLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tlog_msgs.h"
+
+// =====================
+// Log tokenizado (substitui printf no caminho crítico)
+// =====================
+// TLOG(TLOG_GPS_POS, x, y) grava o identificador da mensagem, o instante
+// (us) e os argumentos crus num buffer circular em RAM: não há vsnprintf nem
+// escrita bloqueante na USB. tlog_drain(), chamada no laço principal, envia
+// os registros pendentes em quadros binários:
+//
+//   0xFE 0xED | id (1 B) | nargs (1 B) | instante us (4 B LE) | args (4 B LE cada)
+//
+// e tools/tlog_decode.py reconstrói o texto a partir de tlog_msgs.h.
+// Texto comum (printf) pode continuar misturado no mesmo fluxo.
+//
+// Pode ser chamada de interrupções: a reserva da posição no buffer é feita
+// com as interrupções mascaradas por poucas instruções (o Cortex-M0+ não tem
+// LDREX/STREX). Apenas o núcleo 0 deve registrar mensagens.
+//
+// Com TLOG_TEXT = 1 as macros viram printf com o mesmo formato (depuração
+// sem o decodificador).
+
+#ifndef TLOG_TEXT
+#define TLOG_TEXT 0
+#endif
+
+#define TLOG_MAX_ARGS 4
+#define TLOG_RING_SIZE 64 // Registros; potência de 2
+
+#define TLOG_SYNC0 0xFE
+#define TLOG_SYNC1 0xED
+
+#define TLOG_ENUM_ID(name, nargs, fmt) name,
+#define TLOG_ENUM_NARGS(name, nargs, fmt) name##_NARGS = nargs,
+
+typedef enum {
+    TLOG_MESSAGES(TLOG_ENUM_ID)
+    TLOG_MSG_COUNT
+} tlog_id_t;
+
+enum {
+    TLOG_MESSAGES(TLOG_ENUM_NARGS)
+};
+
+// Grava um registro. Preferir a macro TLOG, que confere o número de argumentos.
+void tlog_write(tlog_id_t id, uint32_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+// Envia até 'max_records' registros pendentes pela stdio (0 = todos).
+// Retorna quantos foram enviados.
+uint32_t tlog_drain(uint32_t max_records);
+
+// Número de argumentos após o identificador (0 a 4), para a verificação em
+// tempo de compilação: TLOG_NARG(id, x, y) == 2
+#define TLOG_NARG_(_0, _1, _2, _3, _4, N, ...) N
+#define TLOG_NARG(...) TLOG_NARG_(__VA_ARGS__, 4, 3, 2, 1, 0)
+#define TLOG_ARGS_(id, a0, a1, a2, a3, ...) (int32_t)(a0), (int32_t)(a1), (int32_t)(a2), (int32_t)(a3)
+
+#if TLOG_TEXT
+
+#include <stdio.h>
+extern const char *const tlog_formats[TLOG_MSG_COUNT];
+#define TLOG(...) TLOG_PRINT_(__VA_ARGS__, 0, 0, 0, 0)
+#define TLOG_PRINT_(id, ...) \
+    do { printf(tlog_formats[id], __VA_ARGS__); printf("\n"); } while (0)
+
+#else
+
+#define TLOG(...)                                                                      \
+    do {                                                                               \
+        _Static_assert(TLOG_NARG(__VA_ARGS__) == TLOG_NARGS_OF(__VA_ARGS__, ),     \
+                       "numero de argumentos diferente de tlog_msgs.h");               \
+        tlog_write(TLOG_ID_OF(__VA_ARGS__, ), TLOG_NARG(__VA_ARGS__),                  \
+                   TLOG_ARGS_(__VA_ARGS__, 0, 0, 0, 0));                               \
+    } while (0)
+#define TLOG_ID_OF(id, ...) id
+#define TLOG_NARGS_OF(id, ...) id##_NARGS
+
+#endif // TLOG_TEXT
+
+#endif // TLOG_H
@@ -0,0 +1,34 @@
+#ifndef TLOG_MSGS_H
+#define TLOG_MSGS_H
+
+// =====================
+// Tabela de mensagens do log tokenizado (tlog.h)
+// =====================
+// X(identificador, número de argumentos, "formato printf")
+//
+// O firmware grava apenas o identificador e os argumentos; o texto é
+// reconstruído no PC por tools/tlog_decode.py, que lê esta mesma tabela.
+// Os identificadores seguem a ordem das linhas: acrescente mensagens novas
+// sempre no final para manter logs antigos decodificáveis.
+// Argumentos são inteiros de 32 bits (até TLOG_MAX_ARGS).
+#define TLOG_MESSAGES(X)                                          \
+    X(TLOG_DROPPED,        1, "[tlog] %d mensagens descartadas")  \
+    X(TLOG_BOOT,           0, "Inicializando...")                 \
+    X(TLOG_GPS_POS,        2, "GPS - X:%d Y:%d")                  \
+    X(TLOG_EMERGENCY_ON,   2, "EMERGENCIA - X:%d Y:%d")           \
+    X(TLOG_EMERGENCY_OFF,  0, "Emergencia Desativada.")           \
+    X(TLOG_EMERGENCY_GPS,  2, "EMERGENCIA - GPS - X:%d Y:%d")     \
+    X(TLOG_ATTENTION,      2, "ATENCAO - X:%d Y:%d")              \
+    X(TLOG_ZONE_ENTER,     2, "Zona %d: entrada (acao %d)")       \
+    X(TLOG_ZONE_EXIT,      2, "Zona %d: saida (acao %d)")         \
+    X(TLOG_BUTTON,         3, "Botao %d: gesto %d (%d ms)")     \
+    X(TLOG_FP_POS,         3, "RSSI - X:%d Y:%d (confianca %d)") \
+    X(TLOG_EMERGENCY_LATENCY, 3, "EMERGENCIA enviada em %d us (gesto: %d us, pior caso: %d us)") \
+    X(TLOG_WARM_BOOT,      3, "Partida a quente %d: alerta %d, emergencia %d") \
+    X(TLOG_BOOT_TIMES,     2, "Partida: 1a amostra em %d us, 1o quadro em %d us") \
+    X(TLOG_BUS_STATS,      4, "Barramento: topico %d, %d amostras, %d mHz, %d perdidas") \
+    X(TLOG_TRACK_SIMPLIFY, 3, "Trajeto: %d amostras, %d pontos gravados (razao x100: %d)") \
+    X(TLOG_CRC_SNIFFER,    1, "CRC pelo sniffer do DMA: %d (0 = tabela)") \
+    X(TLOG_MIRROR_STATS,   3, "Espelho do display: %d quadros (%d chave), %d bytes")
+
+#endif // TLOG_MSGS_H
@@ -0,0 +1,166 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// =====================
+// Gravação e reprodução das entradas (sensores e botões)
+// =====================
+// Cada leitura crua (joystick, acelerômetro, bytes do GPS, gestos dos botões)
+// vira um registro compacto num buffer circular de bytes em RAM:
+//
+//   canal (1 B) | dt us (varint) | valores (varint zigzag da diferença
+//   para a amostra anterior do mesmo canal) ou tamanho (varint) + bytes
+//
+// Um registro-chave (TRACE_TAG_KEY + "TRC" + instante absoluto (4 B) + CRC
+// do bloco anterior (2 B) + registros perdidos) zera os preditores. Ele é
+// emitido no início, a cada TRACE_KEY_INTERVAL_US e depois de qualquer
+// perda, então o fluxo pode ser lido a partir de qualquer chave.
+//
+// Bloco = uma chave e os registros até a próxima. O CRC-16/CCITT (crc.h) de
+// cada bloco vai na chave seguinte; o leitor confere o bloco inteiro antes
+// de entregar o primeiro evento dele e descarta os que não conferem (bytes
+// perdidos na USB, página da flash que falhou, bits trocados). O último
+// bloco, ainda sem a chave seguinte, é entregue sem conferência;
+// trace_seal() o fecha na hora. trace_drain() copia os bytes pendentes
+// para um destino (USB, RAM ou flash, ver trace_sink_t).
+//
+// A codificação ocorre com as interrupções mascaradas (o estado dos
+// preditores é compartilhado com os botões, que gravam da interrupção):
+// algumas centenas de ciclos por amostra, o que permite deixar a gravação
+// ligada em produção. Apenas o núcleo 0 deve gravar.
+//
+// trace_reader_t decodifica o mesmo fluxo, no alvo ou no host. Para
+// reproduzir uma gravação (TRACE_REPLAY = 1), o firmware lê os eventos em
+// ordem até a próxima amostra do sensor lido uma vez por volta do laço
+// principal: cada volta recebe exatamente as entradas (e os gestos dos
+// botões entre elas) que recebeu na gravação. O relógio da lógica do laço
+// (loop_time_us) segue os instantes gravados e os botões reais são
+// ignorados até o fim da gravação.
+//
+// Com TRACE_ENABLED = 0 as macros TRACE_* viram código vazio.
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#ifndef TRACE_REPLAY
+#define TRACE_REPLAY 0
+#endif
+
+#define TRACE_RING_SIZE 2048          // Bytes; potência de 2
+#define TRACE_MAX_VALUES 3            // Valores por amostra
+#define TRACE_BYTES_MAX 128           // Bytes por bloco (GPS)
+#define TRACE_KEY_INTERVAL_US 1000000 // Chave periódica (ressincronização)
+
+#define TRACE_TAG_KEY 0xF0
+#define TRACE_SYNC0 0xFE // Quadro na USB: 0xFE 0xEE | tamanho (1 B) | bytes
+#define TRACE_SYNC1 0xEE
+
+// Canais: nome e número de valores por amostra (0 = bloco de bytes).
+// Acrescentar sempre no final para manter gravações antigas legíveis.
+//   JOYSTICK: x, y (ADC cru)          BUTTON: gpio, gesto, duração (us)
+//   ACCEL: x, y, z (registros crus)   GPS: bytes lidos da UART
+#define TRACE_CHANNELS(X)     \
+    X(TRACE_CH_JOYSTICK, 2)   \
+    X(TRACE_CH_BUTTON,   3)   \
+    X(TRACE_CH_ACCEL,    3)   \
+    X(TRACE_CH_GPS,      0)
+
+#define TRACE_ENUM_ID(name, nvalues) name,
+
+typedef enum {
+    TRACE_CHANNELS(TRACE_ENUM_ID)
+    TRACE_CH_COUNT
+} trace_channel_t;
+
+// Destino dos bytes: write() aceita até 'len' bytes e devolve quantos
+// aceitou (menos que 'len' quando está cheio).
+typedef struct {
+    uint32_t (*write)(void *ctx, const uint8_t *data, uint32_t len);
+    void *ctx;
+} trace_sink_t;
+
+// Quadros na stdio (USB), lidos por tools/tlog_decode.py --trace
+extern const trace_sink_t trace_sink_usb;
+
+// Captura num buffer linear em RAM (para enquanto houver espaço)
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t used;
+} trace_ram_t;
+
+void trace_sink_ram(trace_sink_t *sink, trace_ram_t *ram, uint8_t *buf, uint32_t size);
+
+typedef struct {
+    uint32_t records;  // Registros gravados (inclui chaves)
+    uint32_t bytes;    // Bytes gravados
+    uint32_t dropped;  // Registros perdidos por falta de espaço
+} trace_stats_t;
+
+// Grava uma amostra de 'ch' (valores além dos do canal são ignorados).
+void trace_sample(trace_channel_t ch, int32_t a0, int32_t a1, int32_t a2);
+
+// Grava um bloco de bytes (até TRACE_BYTES_MAX; o resto é cortado).
+void trace_bytes(trace_channel_t ch, const void *data, uint32_t len);
+
+// Envia até 'max_bytes' bytes pendentes para 'sink' (0 = todos).
+// Retorna quantos foram enviados.
+uint32_t trace_drain(const trace_sink_t *sink, uint32_t max_bytes);
+
+void trace_get_stats(trace_stats_t *stats);
+
+// Faz o próximo registro sair precedido de uma chave (ex.: o destino vai
+// descartar ou pular bytes).
+void trace_force_key(void);
+
+// Grava uma chave já, fechando o bloco em andamento com o seu CRC (ex.:
+// antes de gravar a última página na flash). false sem espaço no anel.
+bool trace_seal(void);
+
+// =====================
+// Leitura
+// =====================
+typedef struct {
+    trace_channel_t ch;
+    uint32_t t_us;                   // Instante da gravação (time_us_32)
+    int32_t v[TRACE_MAX_VALUES];     // Valores (canais de amostras)
+    const uint8_t *data;             // Bloco (canais de bytes), aponta para o fluxo
+    uint32_t len;
+} trace_event_t;
+
+typedef struct {
+    const uint8_t *p, *end;
+    bool synced;                     // Já passou por uma chave
+    uint32_t t_us;
+    int32_t prev[TRACE_CH_COUNT][TRACE_MAX_VALUES];
+    uint32_t dropped;                // Soma dos registros perdidos informados pelas chaves
+    uint32_t errors;                 // Registros inválidos (ressincroniza na próxima chave)
+    uint32_t crc_errors;             // Blocos descartados por CRC errado
+    uint32_t unverified;             // Eventos entregues sem conferência (último bloco)
+    const uint8_t *block_end;        // Fim do bloco conferido (NULL: último, sem conferência)
+} trace_reader_t;
+
+void trace_reader_init(trace_reader_t *r, const void *data, size_t len);
+
+// Decodifica o próximo evento. false no fim do fluxo.
+bool trace_next(trace_reader_t *r, trace_event_t *ev);
+
+// Gravação gerada por tools/gen_trace_replay.py (builds com TRACE_REPLAY)
+extern const uint8_t trace_replay_data[];
+extern const uint32_t trace_replay_size;
+
+#if TRACE_ENABLED
+#define TRACE_SAMPLE(ch, a0, a1, a2) trace_sample((ch), (a0), (a1), (a2))
+#define TRACE_BYTES(ch, data, len) trace_bytes((ch), (data), (len))
+#define TRACE_DRAIN() trace_drain(&trace_sink_usb, 0)
+#else
+#define TRACE_SAMPLE(ch, a0, a1, a2) ((void)0)
+#define TRACE_BYTES(ch, data, len) ((void)0)
+#define TRACE_DRAIN() ((void)0)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,44 @@
+#ifndef TRACE_FLASH_H
+#define TRACE_FLASH_H
+
+#include "trace.h"
+#include "track.h"
+
+// =====================
+// Destino da gravação de entradas na flash
+// =====================
+// Grava o fluxo do trace.h numa região própria da flash, página a página,
+// apagando cada setor ao entrar nele. A captura começa no início da região
+// e para quando ela enche (os registros seguintes contam como perdidos).
+// Para ler no PC: picotool save -r <início> <fim> captura.bin, com a região
+// logo abaixo da do trajeto (track_flash.c); bytes 0xFF no fim de páginas
+// completadas por trace_flash_flush e no resto da região são pulados pelo
+// leitor, então o arquivo vai direto para trace_replay.
+//
+// No finalv3, TRACE_FLASH = 1 (-DBADGE_TRACE_FLASH=ON) troca o envio pela
+// USB por este destino; a página incompleta é gravada quando a emergência é
+// ativada.
+
+#ifndef TRACE_FLASH
+#define TRACE_FLASH 0
+#endif
+
+typedef struct {
+    const track_flash_t *flash;
+    uint32_t offset;               // Próxima página a gravar
+    uint32_t fill;                 // Bytes em 'page'
+    uint8_t page[TRACK_PAGE_SIZE];
+} trace_flash_t;
+
+// Prepara 'sink' para gravar em 'flash' a partir do início da região.
+void trace_sink_flash(trace_sink_t *sink, trace_flash_t *f, const track_flash_t *flash);
+
+// Grava a página incompleta (completada com 0xFF). O fluxo continua com uma
+// chave na página seguinte. Para que o último bloco já saia conferível,
+// chamar antes trace_seal() e trace_drain().
+bool trace_flash_flush(trace_flash_t *f);
+
+// Região de flash do alvo reservada para a gravação (track_flash.c).
+const track_flash_t *trace_flash_pico(void);
+
+#endif // TRACE_FLASH_H
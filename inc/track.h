@@ -0,0 +1,108 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// =====================
+// Registro de trajeto em flash (log estruturado, append-only)
+// =====================
+// As posições são acumuladas numa página em RAM e gravadas na flash uma
+// página (256 B) por vez. A região reservada é usada como um buffer
+// circular: ao entrar num setor novo (4 KB) ele é apagado — sempre o mais
+// antigo —, de modo que todos os setores sofrem o mesmo número de apagamentos.
+//
+// Cada página tem número de sequência e CRC32. Na montagem (track_mount) a
+// página de maior sequência com CRC válido indica onde o log parou; páginas
+// cortadas por falta de energia falham o CRC e são ignoradas.
+//
+// Os instantes gravados formam um "tempo de log" em ms que continua crescendo
+// entre reinicializações (base = último instante gravado + 1), o que permite
+// buscar intervalos com track_query por busca binária nas páginas.
+
+#define TRACK_PAGE_SIZE 256
+#define TRACK_SECTOR_SIZE 4096
+#define TRACK_PAGES_PER_SECTOR (TRACK_SECTOR_SIZE / TRACK_PAGE_SIZE)
+
+// Flags de cada ponto
+#define TRACK_FLAG_OUT_OF_RANGE 0x01 // Fora da área segura
+#define TRACK_FLAG_RED_ALERT    0x02 // Alerta de inatividade ativo
+#define TRACK_FLAG_EMERGENCY    0x04 // Modo emergência ativo
+
+typedef struct {
+    uint32_t t_ms;  // Tempo de log (ms)
+    int16_t x;
+    int16_t y;
+    uint8_t flags;
+    uint8_t reserved[3];
+} track_record_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;     // Sequência da página (cresce sempre)
+    uint32_t t_first; // Instante do primeiro registro
+    uint32_t t_last;  // Instante do último registro
+    uint16_t count;   // Registros válidos na página
+    uint16_t reserved;
+    uint32_t crc;     // CRC32 do cabeçalho (sem este campo) + registros
+} track_page_header_t;
+
+#define TRACK_RECORDS_PER_PAGE ((TRACK_PAGE_SIZE - sizeof(track_page_header_t)) / sizeof(track_record_t))
+
+typedef struct {
+    track_page_header_t header;
+    track_record_t records[TRACK_RECORDS_PER_PAGE];
+    uint8_t pad[TRACK_PAGE_SIZE - sizeof(track_page_header_t) - TRACK_RECORDS_PER_PAGE * sizeof(track_record_t)];
+} track_page_t;
+
+// Acesso à flash. No alvo: track_flash_pico() (track_flash.c);
+// no host: flash_sim_device() (host/flash_sim.c).
+typedef struct {
+    uint32_t size; // Tamanho da região em bytes (múltiplo de TRACK_SECTOR_SIZE)
+    // Lê 'len' bytes a partir de 'offset' (relativo ao início da região)
+    void (*read)(uint32_t offset, void *dst, size_t len);
+    // Grava uma página inteira (offset alinhado a TRACK_PAGE_SIZE)
+    bool (*program)(uint32_t offset, const void *page);
+    // Apaga um setor (offset alinhado a TRACK_SECTOR_SIZE)
+    bool (*erase)(uint32_t offset);
+} track_flash_t;
+
+typedef struct {
+    const track_flash_t *flash;
+    uint32_t page_count;
+    uint32_t write_page;  // Próxima página física a gravar
+    uint32_t next_seq;    // Sequência da próxima página
+    uint32_t time_base;   // Somado ao tempo desde o boot para formar o tempo de log
+    uint32_t last_t;      // Último instante registrado
+    track_page_t pending; // Página em preenchimento (RAM)
+    uint32_t pages_written;
+    uint32_t sectors_erased;
+} track_t;
+
+// Monta o log: localiza a última página válida e prepara a próxima gravação.
+// 'uptime_ms' é o tempo atual desde o boot (define a base do tempo de log).
+bool track_mount(track_t *t, const track_flash_t *flash, uint32_t uptime_ms);
+
+// Acrescenta um ponto (gravando a página na flash quando ela enche).
+// Retorna false se a gravação da flash falhar.
+bool track_append(track_t *t, uint32_t uptime_ms, int16_t x, int16_t y, uint8_t flags);
+
+// Grava imediatamente a página pendente, mesmo incompleta (ex.: emergência).
+bool track_flush(track_t *t);
+
+// Converte o tempo desde o boot em tempo de log.
+static inline uint32_t track_time(const track_t *t, uint32_t uptime_ms) {
+    return t->time_base + uptime_ms;
+}
+
+// Chama 'cb' para cada ponto com t_from <= t_ms <= t_to, em ordem de tempo
+// (inclui os pontos ainda em RAM). Se 'cb' retornar false a busca para.
+// Retorna o número de pontos entregues.
+typedef bool (*track_visit_t)(const track_record_t *r, void *ctx);
+uint32_t track_query(track_t *t, uint32_t t_from, uint32_t t_to, track_visit_t cb, void *ctx);
+
+// Região de flash do alvo (fim da flash de PICO_FLASH_SIZE_BYTES).
+const track_flash_t *track_flash_pico(void);
+
+#endif // TRACK_H
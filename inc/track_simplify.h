@@ -0,0 +1,57 @@
+#ifndef TRACK_SIMPLIFY_H
+#define TRACK_SIMPLIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "track.h"
+
+// =====================
+// Simplificação do trajeto antes da gravação
+// =====================
+// Fica entre a fonte de posição e o trajeto (track_append). Só passam os
+// pontos necessários para que a polilinha gravada fique a no máximo
+// 'tolerance' unidades de cada posição descartada. Quem anda em linha reta
+// ou está parado gera poucos pontos.
+//
+// Janela deslizante, em fluxo: a partir do último ponto mantido (âncora),
+// os pontos seguintes ficam pendentes enquanto o segmento âncora -> ponto
+// novo passar a menos de 'tolerance' de todos eles. Quando um pendente sai
+// da faixa, o ponto anterior ao novo é mantido e vira a âncora. A janela tem
+// no máximo 'window' pendentes (o último é mantido quando ela enche), então
+// cada amostra custa até 'window' testes de distância, em aritmética inteira.
+//
+// Pontos com qualquer flag (fora da área, alerta, emergência) e os pontos em
+// que as flags mudam são sempre mantidos, junto com o pendente anterior.
+
+#define TRACK_SIMPLIFY_WINDOW_MAX 32
+#define TRACK_SIMPLIFY_MAX_OUT 2 // Pontos liberados por amostra, no máximo
+
+typedef struct {
+    uint16_t tolerance;     // Erro máximo (unidades de posição)
+    uint8_t window;         // Pendentes por segmento (<= TRACK_SIMPLIFY_WINDOW_MAX)
+    bool has_anchor;
+    uint8_t last_flags;     // Flags da amostra anterior
+    uint8_t count;          // Pendentes; o último é o candidato a ponto mantido
+    track_record_t anchor;
+    track_record_t pending[TRACK_SIMPLIFY_WINDOW_MAX];
+    uint32_t points_in;     // Amostras recebidas
+    uint32_t points_out;    // Pontos liberados para o trajeto
+} track_simplify_t;
+
+void track_simplify_init(track_simplify_t *s, uint16_t tolerance, uint8_t window);
+
+// Recebe uma amostra (t_ms em tempo desde o boot, como track_append) e
+// escreve em 'out' os pontos a gravar, em ordem. Retorna quantos (0 a
+// TRACK_SIMPLIFY_MAX_OUT).
+uint32_t track_simplify_push(track_simplify_t *s, uint32_t t_ms, int16_t x, int16_t y, uint8_t flags,
+                             track_record_t out[TRACK_SIMPLIFY_MAX_OUT]);
+
+// Libera o ponto pendente (ex.: antes de track_flush). Retorna 0 ou 1.
+uint32_t track_simplify_flush(track_simplify_t *s, track_record_t out[1]);
+
+// Amostras recebidas por ponto gravado, x100 (250 = 2,5:1)
+static inline uint32_t track_simplify_ratio_x100(const track_simplify_t *s) {
+    return s->points_out ? (uint32_t)((uint64_t)s->points_in * 100 / s->points_out) : 0;
+}
+
+#endif // TRACK_SIMPLIFY_H
@@ -0,0 +1,214 @@
+#include "lora.h"
+#include "prof.h"
+#include "crc.h"
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "ram_hot.h"
+#include <string.h>
+
+static int lora_dma = -1;
+static volatile bool lora_preempted = false; // Envio urgente começou: lora_send desiste
+static volatile bool lora_mid_line = false;  // Mensagem comum parcialmente enviada
+static uint8_t lora_urgent_buf[LORA_URGENT_MAX + 1];
+
+#if LORA_RX
+// Recepção: a interrupção grava em lora_rx_ring, o laço lê em lora_read_line
+static uart_inst_t *lora_rx_uart;
+static uint8_t lora_rx_ring[LORA_RX_BUF];
+static volatile uint32_t lora_rx_head = 0;
+static volatile uint32_t lora_rx_tail = 0;
+static volatile uint32_t lora_rx_lost = 0;
+static uint32_t lora_rx_bad = 0;
+static char lora_line[LORA_LINE_MAX];
+static uint32_t lora_line_len = 0;
+static bool lora_line_overflow = false; // Linha longa demais: descarta até o '\n'
+#endif
+
+void lora_init(uart_inst_t *uart) {
+    uart_set_fifo_enabled(uart, true); // A recepção aguenta ~32 ms de interrupções mascaradas
+    lora_dma = dma_claim_unused_channel(true);
+}
+
+static bool RAM_HOT_FUNC(lora_urgent_busy)(void) {
+    return lora_dma >= 0 && dma_channel_is_busy((uint)lora_dma);
+}
+
+// Cada byte é escrito com as interrupções mascaradas, e só se a UART estiver
+// livre, para que um envio urgente nunca tenha um byte comum no meio. Um byte
+// comum só entra com a FIFO de transmissão vazia: a FIFO fica ligada, mas no
+// máximo dois bytes comuns (um na FIFO e um saindo) ficam à frente de um
+// quadro urgente.
+static bool lora_put(uart_inst_t *uart, const char *s, uint32_t len) {
+    while (len) {
+        uint32_t irq = save_and_disable_interrupts();
+        if (lora_preempted) {
+            restore_interrupts(irq);
+            return false;
+        }
+        bool ready = !lora_urgent_busy() && (uart_get_hw(uart)->fr & UART_UARTFR_TXFE_BITS);
+        if (ready) {
+            uart_putc_raw(uart, *s);
+            lora_mid_line = *s != '\n';
+        }
+        restore_interrupts(irq);
+        if (ready) {
+            s++;
+            len--;
+        }
+    }
+    return true;
+}
+
+// Tamanho sem os '\r' e '\n' finais
+static uint32_t RAM_HOT_FUNC(lora_trim)(const char *s, uint32_t len) {
+    while (len && (s[len - 1] == '\n' || s[len - 1] == '\r')) len--;
+    return len;
+}
+
+// Escreve "*HHHH\n" em 'out' (LORA_CRC_LEN + 1 bytes)
+static void RAM_HOT_FUNC(lora_put_crc)(uint8_t *out, uint16_t crc) {
+    static const char hex[] = "0123456789ABCDEF";
+    out[0] = '*';
+    for (uint32_t i = 0; i < 4; i++) out[1 + i] = (uint8_t)hex[(crc >> (12 - 4 * i)) & 0xF];
+    out[LORA_CRC_LEN] = '\n';
+}
+
+bool lora_send(uart_inst_t *uart, const char *message) {
+    PROF_SCOPE(PROF_LORA_SEND);
+    uint32_t len = lora_trim(message, (uint32_t)strlen(message));
+    uint8_t tail[LORA_CRC_LEN + 1];
+    lora_put_crc(tail, crc16_ccitt_update(CRC16_CCITT_INIT, message, len));
+    while (lora_urgent_busy()) tight_loop_contents();
+    lora_preempted = false;
+    return lora_put(uart, message, len) && lora_put(uart, (const char *)tail, sizeof(tail));
+}
+
+uint32_t RAM_HOT_FUNC(lora_send_urgent)(uart_inst_t *uart, const char *frame, uint32_t len) {
+    uint32_t irq = save_and_disable_interrupts();
+    lora_preempted = true;
+    if (lora_urgent_busy()) {
+        // Quadro urgente anterior ainda saindo: é substituído pelo novo
+        dma_channel_abort((uint)lora_dma);
+        lora_mid_line = true;
+    }
+
+    uint32_t n = 0;
+    if (lora_mid_line) lora_urgent_buf[n++] = '\n';
+    len = lora_trim(frame, len);
+    if (len > LORA_URGENT_MAX - LORA_CRC_LEN - 1 - n) len = LORA_URGENT_MAX - LORA_CRC_LEN - 1 - n;
+    // A cópia para o buffer do DMA já calcula o CRC do quadro (crc.h)
+    uint16_t crc = crc16_ccitt_copy(&lora_urgent_buf[n], frame, len, CRC16_CCITT_INIT);
+    n += len;
+    lora_put_crc(&lora_urgent_buf[n], crc);
+    n += LORA_CRC_LEN + 1;
+    lora_mid_line = false;
+
+    // Primeiro byte direto na FIFO; o resto vai por DMA. A FIFO só está
+    // cheia se um quadro urgente substituído a encheu, e aí a espera é de
+    // um byte.
+    while (!uart_is_writable(uart)) tight_loop_contents();
+    uart_putc_raw(uart, (char)lora_urgent_buf[0]);
+    uint32_t t_first = time_us_32();
+    if (n > 1) {
+        dma_channel_config c = dma_channel_get_default_config((uint)lora_dma);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, uart_get_dreq(uart, true));
+        dma_channel_configure((uint)lora_dma, &c, &uart_get_hw(uart)->dr, &lora_urgent_buf[1], n - 1, true);
+    }
+    restore_interrupts(irq);
+    return t_first;
+}
+
+#if LORA_RX
+static void RAM_HOT_FUNC(lora_rx_irq)(void) {
+    while (uart_is_readable(lora_rx_uart)) {
+        uint8_t c = (uint8_t)uart_getc(lora_rx_uart);
+        uint32_t head = lora_rx_head;
+        if (head - lora_rx_tail < LORA_RX_BUF) {
+            lora_rx_ring[head & (LORA_RX_BUF - 1)] = c;
+            lora_rx_head = head + 1;
+        } else {
+            lora_rx_lost++;
+        }
+    }
+}
+
+void lora_rx_init(uart_inst_t *uart) {
+    lora_rx_uart = uart;
+    uint irq = uart == uart0 ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, lora_rx_irq);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(uart, true, false);
+}
+
+// Confere e retira o "*HHHH" de 'line'. O que o módulo acrescenta depois
+// do CRC (",<RSSI>") é mantido.
+static bool lora_check_crc(char *line, uint32_t *len) {
+    char *star = NULL;
+    for (uint32_t i = 0; i < *len; i++) {
+        if (line[i] == '*') star = &line[i];
+    }
+    if (!star || (uint32_t)(&line[*len] - star) < LORA_CRC_LEN) return false;
+    uint16_t expected = 0;
+    for (uint32_t i = 1; i < LORA_CRC_LEN; i++) {
+        char c = star[i];
+        uint16_t d;
+        if (c >= '0' && c <= '9')
+            d = (uint16_t)(c - '0');
+        else if (c >= 'A' && c <= 'F')
+            d = (uint16_t)(c - 'A' + 10);
+        else
+            return false;
+        expected = (uint16_t)((expected << 4) | d);
+    }
+    char *rest = star + LORA_CRC_LEN;
+    uint32_t body = (uint32_t)(star - line), tail = *len - body - LORA_CRC_LEN;
+    if (tail && *rest != ',') return false;
+    if (crc16_ccitt_update(CRC16_CCITT_INIT, line, body) != expected) return false;
+    memmove(star, rest, tail);
+    *len = body + tail;
+    return true;
+}
+
+bool lora_read_line(char *line, uint32_t size) {
+    while (lora_rx_tail != lora_rx_head) {
+        char c = (char)lora_rx_ring[lora_rx_tail & (LORA_RX_BUF - 1)];
+        lora_rx_tail = lora_rx_tail + 1;
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (lora_line_len < LORA_LINE_MAX - 1)
+                lora_line[lora_line_len++] = c;
+            else
+                lora_line_overflow = true;
+            continue;
+        }
+        bool ok = !lora_line_overflow && lora_line_len > 0;
+        if (ok && !lora_check_crc(lora_line, &lora_line_len)) {
+            lora_rx_bad++;
+            ok = false;
+        }
+        if (ok) {
+            uint32_t n = lora_line_len < size - 1 ? lora_line_len : size - 1;
+            memcpy(line, lora_line, n);
+            line[n] = '\0';
+        }
+        lora_line_len = 0;
+        lora_line_overflow = false;
+        if (ok) return true;
+    }
+    return false;
+}
+
+uint32_t lora_rx_dropped(void) {
+    return lora_rx_lost;
+}
+
+uint32_t lora_rx_crc_errors(void) {
+    return lora_rx_bad;
+}
+#endif // LORA_RX
@@ -0,0 +1,201 @@
+#include "mirror.h"
+#include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+#if MIRROR_ENABLED
+
+// ssd1306_show é chamada do laço e de interrupções (botões). Comparar e
+// copiar 1 KB leva dezenas de us no M0+, então isso fica fora da máscara:
+// cada chamada reserva um quadro que não é o publicado nem o de outro
+// escritor, copia nele e só então troca o índice publicado, como em
+// emergency_set_fix. Três quadros bastam para o laço e uma interrupção que o
+// preempte. Se outro escritor publicou no meio, o quadro dele é o mais novo
+// e a cópia em andamento é descartada. O codificador, no laço, pode ver o
+// seu quadro ser reaproveitado no meio da codificação, mas usa cada byte
+// lido uma só vez: mirror_sent sempre corresponde exatamente ao que foi
+// enviado, e o quadro seguinte corrige a diferença.
+#define MIRROR_SLOTS 3
+
+static uint8_t mirror_buf[MIRROR_SLOTS][MIRROR_BYTES];
+static volatile uint8_t mirror_pub = 0;     // Último quadro capturado
+static volatile uint8_t mirror_claimed = 0; // Quadros em cópia (bits)
+static uint8_t mirror_sent[MIRROR_BYTES];   // O que o PC tem
+static volatile uint32_t mirror_seq = 0;  // Quadros diferentes capturados
+static volatile uint32_t mirror_t_us = 0; // Instante da última captura
+static volatile uint8_t mirror_width = 0, mirror_height = 0;
+
+// Estado do codificador (só o laço principal)
+static bool mirror_connected = false;
+static bool mirror_busy = false;   // Quadro em codificação
+static bool mirror_need_key = true;
+static uint32_t mirror_pos, mirror_len;
+static uint32_t mirror_frame_seq, mirror_frame_t_us;
+static const uint8_t *mirror_cur; // Quadro em codificação
+static uint32_t mirror_sent_seq = 0;
+static uint8_t mirror_key_width, mirror_key_height;
+static uint32_t mirror_key_ms;
+static mirror_stats_t stats;
+
+void mirror_frame(const uint8_t *buf, uint8_t width, uint8_t height) {
+    uint32_t len = (uint32_t)width * height / 8;
+    if (len > MIRROR_BYTES) return;
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t seq = mirror_seq;
+    uint8_t pub = mirror_pub, slot = 0;
+    while (slot < MIRROR_SLOTS && (slot == pub || (mirror_claimed & (1u << slot)))) slot++;
+    if (slot == MIRROR_SLOTS) { // Mais escritores aninhados que quadros: não acontece com um nível de interrupção
+        restore_interrupts(irq);
+        return;
+    }
+    mirror_claimed |= (uint8_t)(1u << slot);
+    bool changed = width != mirror_width || height != mirror_height;
+    restore_interrupts(irq);
+
+    // O quadro publicado não é reservado por ninguém enquanto estiver publicado
+    if (!changed) changed = memcmp(buf, mirror_buf[pub], len) != 0;
+    if (changed) memcpy(mirror_buf[slot], buf, len);
+
+    irq = save_and_disable_interrupts();
+    mirror_claimed &= (uint8_t)~(1u << slot);
+    if (changed && mirror_seq == seq) {
+        mirror_pub = slot;
+        mirror_width = width;
+        mirror_height = height;
+        mirror_t_us = time_us_32();
+        mirror_seq = seq + 1;
+        stats.captured++;
+    }
+    restore_interrupts(irq);
+}
+
+static inline uint8_t mirror_diff(uint32_t i) {
+    return mirror_cur[i] ^ mirror_sent[i];
+}
+
+// Escreve em 'out' a operação que cobre os bytes a partir do cursor e
+// atualiza mirror_sent com ela. Retorna o tamanho (até 1 + MIRROR_XOR_MAX).
+static uint32_t mirror_encode_op(uint8_t *out) {
+    uint32_t i = mirror_pos, left = mirror_len - mirror_pos;
+    uint8_t d = mirror_diff(i);
+    if (d == 0) {
+        uint32_t n = 1;
+        while (n < left && n < MIRROR_SKIP_MAX && mirror_diff(i + n) == 0) n++;
+        out[0] = (uint8_t)(MIRROR_OP_SKIP | (n - 1));
+        mirror_pos += n;
+        return 1;
+    }
+
+    uint32_t run = 1;
+    while (run < left && run < MIRROR_RUN_MAX && mirror_diff(i + run) == d) run++;
+    if (run >= MIRROR_RUN_MIN) {
+        out[0] = (uint8_t)(MIRROR_OP_RUN | (run - MIRROR_RUN_MIN));
+        out[1] = d;
+        for (uint32_t k = 0; k < run; k++) mirror_sent[i + k] ^= d;
+        mirror_pos += run;
+        return 2;
+    }
+
+    // Bytes avulsos até dois sem mudança seguidos ou o início de uma repetição
+    uint32_t n = 0;
+    while (n < left && n < MIRROR_XOR_MAX) {
+        uint8_t x = mirror_diff(i + n);
+        if (n > 0 && x == 0 && (n + 1 >= left || mirror_diff(i + n + 1) == 0)) break;
+        if (n > 0 && n + 2 < left && x == mirror_diff(i + n + 1) && x == mirror_diff(i + n + 2)) break;
+        out[1 + n] = x;
+        mirror_sent[i + n] ^= x;
+        n++;
+    }
+    out[0] = (uint8_t)(MIRROR_OP_XOR | (n - 1));
+    mirror_pos += n;
+    return 1 + n;
+}
+
+// Começa o próximo quadro, se houver. Escreve em 'out' o quadro-chave, se
+// for a vez dele, e retorna o tamanho (0 ou 3); -1 se não há quadro novo.
+static int32_t mirror_begin(uint8_t *out) {
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t seq = mirror_seq, t_us = mirror_t_us;
+    uint8_t width = mirror_width, height = mirror_height, pub = mirror_pub;
+    restore_interrupts(irq);
+    if (width == 0 || (seq == mirror_sent_seq && !mirror_need_key)) return -1;
+
+    mirror_busy = true;
+    mirror_cur = mirror_buf[pub];
+    mirror_pos = 0;
+    mirror_len = (uint32_t)width * height / 8;
+    mirror_frame_seq = seq;
+    mirror_frame_t_us = t_us;
+    uint32_t now_ms = (uint32_t)(time_us_64() / 1000);
+    if (!mirror_need_key && width == mirror_key_width && height == mirror_key_height &&
+        now_ms - mirror_key_ms < MIRROR_KEY_INTERVAL_MS)
+        return 0;
+    memset(mirror_sent, 0, sizeof(mirror_sent));
+    mirror_need_key = false;
+    mirror_key_width = width;
+    mirror_key_height = height;
+    mirror_key_ms = now_ms;
+    stats.keys++;
+    out[0] = MIRROR_OP_KEY;
+    out[1] = width;
+    out[2] = height;
+    return 3;
+}
+
+uint32_t mirror_drain(uint32_t max_bytes) {
+    if (!stdio_usb_connected()) {
+        mirror_connected = false;
+        return 0;
+    }
+    if (!mirror_connected) {
+        // Terminal novo: recomeça com um quadro-chave
+        mirror_connected = true;
+        mirror_need_key = true;
+        mirror_busy = false;
+    }
+
+    uint32_t sent = 0;
+    for (;;) {
+        // Cada pacote comporta ao menos uma operação e o fim do quadro
+        if (max_bytes - sent < 3 + 1 + MIRROR_XOR_MAX + 7) break;
+        uint32_t cap = max_bytes - sent - 3;
+        if (cap > MIRROR_PACKET_MAX) cap = MIRROR_PACKET_MAX;
+
+        uint8_t pkt[3 + MIRROR_PACKET_MAX];
+        uint32_t n = 0;
+        if (!mirror_busy) {
+            int32_t key = mirror_begin(&pkt[3]);
+            if (key < 0) break;
+            n = (uint32_t)key;
+        }
+        while (mirror_pos < mirror_len && n + 1 + MIRROR_XOR_MAX <= cap) n += mirror_encode_op(&pkt[3 + n]);
+        if (mirror_pos == mirror_len && n + 7 <= cap) {
+            uint8_t *e = &pkt[3 + n];
+            e[0] = MIRROR_OP_END;
+            e[1] = (uint8_t)mirror_frame_seq;
+            e[2] = (uint8_t)(mirror_frame_seq >> 8);
+            for (int k = 0; k < 4; k++) e[3 + k] = (uint8_t)(mirror_frame_t_us >> (8 * k));
+            n += 7;
+            mirror_busy = false;
+            mirror_sent_seq = mirror_frame_seq;
+            stats.frames++;
+        }
+
+        pkt[0] = MIRROR_SYNC0;
+        pkt[1] = MIRROR_SYNC1;
+        pkt[2] = (uint8_t)n;
+        for (uint32_t k = 0; k < 3 + n; k++) putchar_raw(pkt[k]);
+        sent += 3 + n;
+        stats.bytes += 3 + n;
+    }
+    return sent;
+}
+
+void mirror_get_stats(mirror_stats_t *out) {
+    uint32_t irq = save_and_disable_interrupts();
+    *out = stats;
+    restore_interrupts(irq);
+}
+
+#endif // MIRROR_ENABLED
@@ -0,0 +1,102 @@
+#include "prof.h"
+
+#if PROF_ENABLED
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "hardware/sync.h"
+#include "ram_hot.h"
+
+static prof_stats_t prof_stats[PROF_PROBE_COUNT];
+static uint32_t last_dump_us;
+
+static const char *const prof_names[PROF_PROBE_COUNT] = {
+    [PROF_MAIN_LOOP] = "main_loop",
+    [PROF_SSD1306_SHOW] = "ssd1306_show",
+    [PROF_READ_JOYSTICK] = "read_joystick",
+    [PROF_MPU6050_READ] = "mpu6050_read_accel",
+    [PROF_GPS_READ] = "gps_read",
+    [PROF_LORA_SEND] = "lora_send",
+    [PROF_EVENT_TO_ALARM] = "event_to_alarm",
+    [PROF_BUTTONS_IRQ] = "buttons_irq",
+    [PROF_BOOT_SAMPLE] = "boot_first_sample",
+    [PROF_BOOT_FRAME] = "boot_first_frame",
+    [PROF_FP_LOCATE] = "fp_locate",
+};
+
+void RAM_HOT_FUNC(prof_record)(prof_probe_t probe, uint32_t elapsed_us) {
+    // Balde = número de bits significativos (0 us -> balde 0)
+    uint32_t bucket = elapsed_us ? 32u - (uint32_t)__builtin_clz(elapsed_us) : 0u;
+    if (bucket >= PROF_HIST_BUCKETS) bucket = PROF_HIST_BUCKETS - 1;
+
+    prof_stats_t *s = &prof_stats[probe];
+    uint32_t irq = save_and_disable_interrupts();
+    if (s->count == 0 || elapsed_us < s->min_us) s->min_us = elapsed_us;
+    if (elapsed_us > s->max_us) s->max_us = elapsed_us;
+    s->count++;
+    s->sum_us += elapsed_us;
+    s->hist[bucket]++;
+    restore_interrupts(irq);
+}
+
+void prof_reset(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    memset(prof_stats, 0, sizeof(prof_stats));
+    restore_interrupts(irq);
+    // Qualquer escrita zera os contadores da cache XIP
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+}
+
+// Acessos à flash pela cache XIP desde o último prof_reset (ou da partida).
+// Os contadores saturam em 2^32; a taxa de falhas é em décimos de %.
+static void prof_dump_xip(void) {
+    uint32_t acc = xip_ctrl_hw->ctr_acc;
+    uint32_t hit = xip_ctrl_hw->ctr_hit;
+    uint32_t miss = acc - hit;
+    uint32_t permille = acc ? (uint32_t)((uint64_t)miss * 1000u / acc) : 0;
+    printf("%-20s acc=%lu hit=%lu miss=%lu (%lu.%lu%%) ram_hot=%d\n", "xip_cache", (unsigned long)acc,
+           (unsigned long)hit, (unsigned long)miss, (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+           RAM_HOT);
+}
+
+void prof_dump(void) {
+    printf("--- PROF (t=%lu ms) ---\n", (unsigned long)(prof_now() / 1000u));
+    for (int i = 0; i < PROF_PROBE_COUNT; i++) {
+        // Cópia local: uma interrupção pode atualizar a sonda durante o printf
+        uint32_t irq = save_and_disable_interrupts();
+        prof_stats_t s = prof_stats[i];
+        restore_interrupts(irq);
+        if (s.count == 0) continue;
+        printf("%-20s n=%lu min=%luus mean=%luus max=%luus |",
+               prof_names[i], (unsigned long)s.count, (unsigned long)s.min_us,
+               (unsigned long)(s.sum_us / s.count), (unsigned long)s.max_us);
+        for (int b = 0; b < PROF_HIST_BUCKETS; b++) {
+            if (s.hist[b]) printf(" <%lu:%lu", 1ul << b, (unsigned long)s.hist[b]);
+        }
+        printf("\n");
+    }
+    prof_dump_xip();
+}
+
+void prof_poll(void) {
+    int c = getchar_timeout_us(0);
+    if (c == 'p') {
+        prof_dump();
+    } else if (c == 'r') {
+        prof_reset();
+        printf("PROF zerado\n");
+    }
+
+#if PROF_DUMP_INTERVAL_MS > 0
+    uint32_t now = prof_now();
+    if (now - last_dump_us >= PROF_DUMP_INTERVAL_MS * 1000u) {
+        last_dump_us = now;
+        prof_dump();
+    }
+#endif
+}
+
+#endif // PROF_ENABLED
@@ -1,8 +1,11 @@
 #include "gps.h"
+#include "prof.h"
 #include "pico/stdlib.h"
+#include "ram_hot.h"
 #include <stdio.h>
 
-bool gps_read(uart_inst_t *uart, char *buffer, size_t len) {
+bool RAM_HOT_FUNC(gps_read)(uart_inst_t *uart, char *buffer, size_t len) {
+    PROF_SCOPE(PROF_GPS_READ);
     size_t count = 0;
     while (uart_is_readable(uart) && count < len - 1) {
         char c = uart_getc(uart);
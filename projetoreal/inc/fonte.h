@@ -3,110 +3,24 @@
 
 #include <stdint.h>
 
+// Tabelas de fonte 5x8 (coluna a coluna, bit 0 no topo), definidas uma
+// única vez em fonte.c
+
 // Fonte para caracteres maiúsculos (A-Z)
-static const uint8_t font_uppercase[26][5] = {
-    {0x7C, 0x12, 0x11, 0x12, 0x7C}, // A
-    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
-    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
-    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
-    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
-    {0x7F, 0x09, 0x09, 0x09, 0x01}, // F
-    {0x3E, 0x41, 0x49, 0x49, 0x3A}, // G
-    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
-    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
-    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
-    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
-    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
-    {0x7F, 0x02, 0x04, 0x02, 0x7F}, // M
-    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
-    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
-    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
-    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
-    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
-    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
-    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
-    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
-    {0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
-    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
-    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y
-    {0x61, 0x51, 0x49, 0x45, 0x43}  // Z
-};
+extern const uint8_t font_uppercase[26][5];
 
 // Fonte para caracteres minúsculos (a-z)
-static const uint8_t font_lowercase[26][5] = {
-    {0x20, 0x54, 0x54, 0x54, 0x78}, // a
-    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
-    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
-    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
-    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
-    {0x0C, 0x52, 0x52, 0x52, 0x3E}, // g
-    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
-    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
-    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
-    {0x7F, 0x10, 0x28, 0x44, 0x00}, // k
-    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
-    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
-    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
-    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
-    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
-    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
-    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
-    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
-    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
-    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
-    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
-    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
-    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
-    {0x44, 0x64, 0x54, 0x4C, 0x44}  // z
-};
+extern const uint8_t font_lowercase[26][5];
 
 // Fonte para caracteres numéricos (0-9)
-static const uint8_t font_numbers[10][5] = {
-    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
-    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
-    {0x62, 0x51, 0x49, 0x49, 0x46}, // 2
-    {0x22, 0x41, 0x49, 0x49, 0x36}, // 3
-    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
-    {0x47, 0x45, 0x45, 0x45, 0x39}, // 5
-    {0x3E, 0x49, 0x49, 0x49, 0x30}, // 6
-    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
-    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
-    {0x06, 0x49, 0x49, 0x49, 0x3E}  // 9
-};
+extern const uint8_t font_numbers[10][5];
 
 // Fonte para caracteres maiúsculos com acentuação e cedilha (exemplo)
 // Ordem: Á, É, Í, Ó, Ú, Â, Ê, Ô, Ã, Õ, Ç
-static const uint8_t font_uppercase_ext[11][5] = {
-    {0x7E, 0x12, 0x11, 0x12, 0x7C}, // Á
-    {0x7F, 0x49, 0x49, 0x49, 0x41}, // É
-    {0x00, 0x41, 0x7F, 0x41, 0x00}, // Í
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // Ó
-    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // Ú
-    {0x7C, 0x0A, 0x09, 0x0A, 0x7C}, // Â
-    {0x7F, 0x09, 0x09, 0x09, 0x06}, // Ê
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // Ô
-    {0x7C, 0x12, 0x11, 0x12, 0x7C}, // Ã
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // Õ
-    {0x3E, 0x41, 0x41, 0x21, 0x12}  // Ç
-};
+extern const uint8_t font_uppercase_ext[11][5];
 
 // Fonte para caracteres minúsculos com acentuação e cedilha (exemplo)
 // Ordem: á, é, í, ó, ú, â, ê, ô, ã, õ, ç
-static const uint8_t font_lowercase_ext[11][5] = {
-    {0x20, 0x54, 0x54, 0x54, 0x78}, // á
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // é
-    {0x00, 0x44, 0x7D, 0x40, 0x00}, // í
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // ó
-    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // ú
-    {0x7C, 0x0A, 0x09, 0x0A, 0x7C}, // â
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // ê
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // ô
-    {0x7C, 0x12, 0x11, 0x12, 0x7C}, // ã
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // õ
-    {0x38, 0x44, 0x44, 0x42, 0x1C}  // ç
-};
+extern const uint8_t font_lowercase_ext[11][5];
 
 #endif // FONTE_H
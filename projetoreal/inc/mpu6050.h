@@ -13,5 +13,9 @@ typedef struct {
 bool mpu6050_init(mpu6050_t *mpu, i2c_inst_t *i2c, uint8_t addr);
 // Lê os valores de aceleração (em g) dos eixos X, Y e Z.
 bool mpu6050_read_accel(mpu6050_t *mpu, float *ax, float *ay, float *az);
+// Lê os registros crus de aceleração (X, Y, Z), como gravados em trace.h.
+bool mpu6050_read_raw(mpu6050_t *mpu, int16_t raw[3]);
+// Converte os registros crus para g (±2 g). Mesmo resultado de mpu6050_read_accel.
+void mpu6050_accel_to_g(const int16_t raw[3], float *ax, float *ay, float *az);
 
 #endif
@@ -0,0 +1,85 @@
+#ifndef NEIGHBORS_H
+#define NEIGHBORS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================
+// Crachás vizinhos (beacons ouvidos pelo LoRa)
+// =====================
+// Cada crachá transmite periodicamente um beacon curto com o seu ID:
+//
+//   B:1A2B3C4D            (o módulo LoRa acrescenta ",<RSSI dBm>" ao receber)
+//
+// Os beacons ouvidos alimentam uma tabela hash de endereçamento aberto
+// (sondagem linear) com tamanho fixo, indexada pelo ID. Cada entrada guarda
+// o último instante em que o vizinho foi ouvido, o RSSI, os beacons ouvidos
+// e quantos encontros houve: um silêncio maior que NEIGHBORS_GAP_MS separa
+// dois encontros.
+//
+// Envelhecimento em O(1) amortizado: cada chamada de neighbors_age() examina
+// só NEIGHBORS_SWEEP_SLOTS posições, continuando de onde a anterior parou, e
+// remove as entradas sem beacon há NEIGHBORS_TIMEOUT_MS. A remoção desloca
+// as entradas seguintes para trás (sem lápides), então a busca continua
+// curta mesmo depois de muitas saídas.
+//
+// neighbors_summary() monta o resumo para o uplink com as entradas que
+// mudaram desde o último resumo, continuando de onde o anterior parou
+// quando nem todas cabem numa mensagem:
+//
+//   V:1A2B3C4D,-87,3,12;0000BEEF,-101,1,95
+//      ID, RSSI (dBm), encontros, segundos desde o último beacon
+
+#define NEIGHBORS_SLOTS 512                 // Posições da tabela (potência de 2)
+#define NEIGHBORS_MAX 384                   // Vizinhos acompanhados (carga de 75%)
+#define NEIGHBORS_TIMEOUT_MS (5 * 60 * 1000) // Sem beacon por 5 min: sai da tabela
+#define NEIGHBORS_GAP_MS (60 * 1000)         // Silêncio que separa dois encontros
+#define NEIGHBORS_SWEEP_SLOTS 16            // Posições examinadas por neighbors_age
+#define NEIGHBORS_RSSI_UNKNOWN INT8_MIN     // Beacon sem RSSI
+
+typedef struct {
+    uint32_t id;        // 0 = posição livre
+    uint32_t first_ms;  // Início do encontro atual
+    uint32_t last_ms;   // Último beacon ouvido
+    uint16_t beacons;   // Beacons ouvidos (satura)
+    uint8_t encounters; // Encontros (satura)
+    int8_t rssi;        // RSSI do último beacon (dBm)
+} neighbor_t;
+
+typedef struct {
+    neighbor_t slots[NEIGHBORS_SLOTS];
+    uint32_t changed[NEIGHBORS_SLOTS / 32]; // Entradas a incluir no próximo resumo
+    uint32_t self_id;   // Beacons com o próprio ID são ignorados
+    uint16_t count;     // Entradas ocupadas
+    uint16_t sweep;     // Próxima posição do envelhecimento
+    uint16_t report;    // Próxima posição do resumo
+    uint32_t heard;     // Beacons aceitos
+    uint32_t rejected;  // Beacons de vizinhos novos com a tabela cheia
+    uint32_t expired;   // Entradas removidas pelo envelhecimento
+} neighbors_t;
+
+void neighbors_init(neighbors_t *nb, uint32_t self_id);
+
+// Formata o beacon deste crachá. Retorna o tamanho (sem o '\0').
+uint32_t neighbors_beacon(uint32_t self_id, char *out, uint32_t size);
+
+// Interpreta uma linha recebida. false se não for um beacon.
+bool neighbors_parse(const char *line, uint32_t *id, int8_t *rssi);
+
+// Registra um beacon ouvido. false se a tabela estiver cheia.
+bool neighbors_heard(neighbors_t *nb, uint32_t id, int8_t rssi, uint32_t now_ms);
+
+// neighbors_parse + neighbors_heard. false se a linha não for um beacon
+// aceito.
+bool neighbors_line(neighbors_t *nb, const char *line, uint32_t now_ms);
+
+// Avança o envelhecimento (chamar a cada volta do laço).
+void neighbors_age(neighbors_t *nb, uint32_t now_ms);
+
+const neighbor_t *neighbors_find(const neighbors_t *nb, uint32_t id);
+
+// Monta o resumo em 'out'. Retorna quantas entradas entraram (0 = nada
+// mudou; 'out' fica vazio).
+uint32_t neighbors_summary(neighbors_t *nb, uint32_t now_ms, char *out, uint32_t size);
+
+#endif // NEIGHBORS_H
@@ -1,18 +1,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "hardware/watchdog.h"
 #include "pico/time.h"
+#include "pico/stdio_usb.h"
+#include "pico/unique_id.h"
 
 #include "ssd1306.h"
-#include "fonte.h"
 #include "gps.h"
 #include "lora.h"
 #include "mpu6050.h"
+#include "prof.h"
+#include "buttons.h"
+#include "trace.h"
+#include "emergency.h"
+#include "retain.h"
+#include "crc.h"
+#include "mirror.h"
+#include "bus.h"
+#include "neighbors.h"
+#include "ram_hot.h"
 
 // Definições de pinos (ajuste conforme sua montagem)
 #define LED_BLUE    16
@@ -43,17 +57,195 @@
 #define NO_MOVEMENT_10_MIN  (10 * 60 * 1000)
 #define NO_MOVEMENT_15_MIN  (15 * 60 * 1000)
 #define LORA_TX_INTERVAL    (2 * 60 * 1000)
+#define BEACON_INTERVAL     (15 * 1000) // Beacon de proximidade para os crachás vizinhos
+#define WATCHDOG_MS         5000 // Bem maior que uma volta do laço
+#define LOOP_PERIOD_MS      200  // Período do laço principal
+#define BLINK_HALF_MS       500  // Meio período das piscadas de inatividade
+#define BUS_STATS_MS        (60 * 1000) // Intervalo do relatório do barramento
+
+// I2C em fast mode (SSD1306 e MPU6050 suportam): um quadro em ~25 ms
+#define I2C_HZ      (400 * 1000)
+
+// Leitura do MPU6050 que falhou, marcada na gravação (os registros são int16)
+#define TRACE_ACCEL_FAILED  INT32_MIN
 
 volatile absolute_time_t last_movement_time;
 volatile absolute_time_t last_lora_tx_time;
 volatile bool buzzer_active = false;
+volatile uint32_t idle_carry_ms = 0; // Inatividade herdada de antes do reset
+volatile bool button_a_reported = true; // Reset pelo Botão A já informado pela USB (o laço imprime)
+
+
+// Consumidores do barramento de amostras (bus.h)
+bus_sub_t sub_motion; // Detector de movimento: todas as amostras do acelerômetro
+bus_sub_t sub_fix;    // Quadros de emergência: cada sentença nova do GPS
+bus_sub_t sub_report; // LoRa, relatório e estado preservado: a sentença mais recente
+
+neighbors_t neighbors; // Crachás ouvidos pelo LoRa (neighbors.h)
+
+// Prototipação da função de tratamento dos botões
+void button_handler(const button_event_t *ev);
+
+// Grava o estado preservado. fix = NULL mantém a última sentença do GPS e
+// idle_ms < 0 mantém o último tempo parado (chamadas dos botões). O tempo
+// parado é gravado em segundos inteiros (em ms), para que a volta do laço só
+// grave quando algo mudou; o registro é montado fora da máscara e, se um
+// botão gravou no meio, montado de novo sobre o que o botão gravou (retain.h).
+void save_state(const char *fix, int64_t idle_ms) {
+    retain_state_t prev, st;
+    uint32_t gen;
+    do {
+        gen = retain_snapshot(&prev);
+        st = prev;
+        if (fix) {
+            strncpy(st.fix, fix, sizeof(st.fix) - 1); // Completa com zeros: memcmp abaixo
+            st.fix[sizeof(st.fix) - 1] = '\0';
+            st.flags |= RETAIN_FLAG_FIX_VALID;
+        }
+        if (idle_ms >= 0) st.idle = (uint32_t)(idle_ms - idle_ms % 1000);
+        st.alert_level = buzzer_active ? 1 : 0;
+        if (emergency_is_active())
+            st.flags |= RETAIN_FLAG_EMERGENCY;
+        else
+            st.flags &= ~RETAIN_FLAG_EMERGENCY;
+        if (memcmp(&st, &prev, sizeof(st)) == 0) return; // Nada mudou desde a última gravação
+    } while (!retain_save(&st, gen));
+}
+
+// Taxa de publicação e perdas dos consumidores lentos, por tópico
+void print_bus_stats(void) {
+    for (int t = 0; t < BUS_TOPIC_COUNT; t++) {
+        bus_stats_t st;
+        bus_get_stats((bus_topic_t)t, &st);
+        if (!st.published) continue;
+        printf("Barramento %s: %lu amostras, %lu.%03lu Hz, %lu assinantes, %lu perdidas, atraso %lu\n",
+               bus_topic_name((bus_topic_t)t), (unsigned long)st.published, (unsigned long)(st.rate_mhz / 1000),
+               (unsigned long)(st.rate_mhz % 1000), (unsigned long)st.subscribers, (unsigned long)st.lost,
+               (unsigned long)st.max_lag);
+    }
+}
+
+// Piscada de um LED por prazos (absolute_time_t), sem bloquear o laço: o LED
+// troca de estado quando o prazo vence, e o laço acorda para isso
+int blink_pin = -1;             // LED piscando (-1 = nenhum)
+bool blink_lit;
+absolute_time_t blink_next;
+
+void blink_set(int pin) {
+    if (pin == blink_pin) return;
+    if (blink_pin >= 0) gpio_put(blink_pin, 0);
+    blink_pin = pin;
+    blink_lit = false;
+    blink_next = get_absolute_time();
+}
+
+void blink_service(void) {
+    if (blink_pin < 0 || !time_reached(blink_next)) return;
+    blink_lit = !blink_lit;
+    gpio_put(blink_pin, blink_lit);
+    blink_next = delayed_by_ms(blink_next, BLINK_HALF_MS);
+}
+
+// ID do crachá nos beacons: os 8 bytes do ID único da flash reduzidos a 32
+// bits (FNV-1a); 0 é reservado para posição livre na tabela de vizinhos
+uint32_t badge_id(void) {
+    pico_unique_board_id_t board;
+    pico_get_unique_board_id(&board);
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; i++) h = (h ^ board.id[i]) * 16777619u;
+    return h ? h : 1;
+}
+
+#if TRACE_REPLAY
+// Reprodução de uma gravação (trace_replay_data.c) no lugar do GPS e do
+// MPU6050: cada volta do laço consome os eventos até a próxima leitura do
+// acelerômetro, feita uma vez por volta.
+trace_reader_t replay;
+bool replay_active = true;
+bool replay_gps_ready = false;
+char replay_gps[TRACE_BYTES_MAX + 1];
+bool replay_accel_ok = false;
+int16_t replay_accel[3];
+uint64_t replay_t_us;        // Instante gravado do último evento (estendido a 64 bits)
+uint32_t replay_last_t;      // Instante de 32 bits do último evento, como gravado
+int64_t replay_clock_offset; // Depois da gravação: o relógio continua de onde ela parou
+
+void replay_inputs(void) {
+    trace_event_t ev;
+    while (replay_active) {
+        if (!trace_next(&replay, &ev)) {
+            replay_active = false;
+            replay_clock_offset = (int64_t)(replay_t_us - time_us_64());
+            break;
+        }
+        replay_t_us += (uint32_t)(ev.t_us - replay_last_t);
+        replay_last_t = ev.t_us;
+        if (ev.ch == TRACE_CH_BUTTON) {
+            button_event_t b = {
+                .gpio = (uint8_t)ev.v[0],
+                .gesture = (uint8_t)ev.v[1],
+                .t_us = time_us_32(), // Só mede a latência da emergência, que é do alvo
+                .duration_us = (uint32_t)ev.v[2],
+            };
+            button_handler(&b);
+        } else if (ev.ch == TRACE_CH_GPS) {
+            memcpy(replay_gps, ev.data, ev.len);
+            replay_gps[ev.len] = '\0';
+            replay_gps_ready = true;
+        } else if (ev.ch == TRACE_CH_ACCEL) {
+            replay_accel_ok = ev.v[0] != TRACE_ACCEL_FAILED;
+            for (int i = 0; i < 3; i++) replay_accel[i] = (int16_t)ev.v[i];
+            break;
+        }
+    }
+}
+
+// Gestos dos botões reais: ignorados enquanto a gravação é reproduzida, para
+// não se misturarem aos gravados
+void RAM_HOT_FUNC(live_button_handler)(const button_event_t *ev) {
+    if (!replay_active) button_handler(ev);
+}
+#endif
 
-// Prototipação das funções de tratamento dos botões
-void button_a_handler(uint gpio, uint32_t events);
-void button_b_handler(uint gpio, uint32_t events);
+// Relógio da lógica do laço (inatividade, beacons, LoRa, barramento): na
+// reprodução, o instante gravado do último evento, para que os alertas e os
+// consumidores vejam os mesmos instantes da gravação
+uint64_t loop_time_us(void) {
+#if TRACE_REPLAY
+    if (replay_active) return replay_t_us;
+    return time_us_64() + replay_clock_offset;
+#else
+    return time_us_64();
+#endif
+}
+
+absolute_time_t loop_time(void) {
+    return from_us_since_boot(loop_time_us());
+}
 
 int main() {
     stdio_init_all();
+
+    // Partida rápida: primeiro o que deixa o crachá operacional (emergência
+    // retomada, primeira amostra e primeiro quadro). O MPU6050 é acordado
+    // antes do display e estabiliza enquanto o display é configurado.
+    retain_state_t saved;
+    uint32_t warm_resets = 0;
+    bool warm = retain_load(&saved, &warm_resets);
+#if TRACE_REPLAY
+    warm = false; // A reprodução sempre parte do mesmo estado
+#endif
+    bool crc_sniffer = crc_init(); // CRC dos quadros LoRa e do estado pelo sniffer do DMA
+    
+    // Inicializa a UART para o módulo LoRa
+    uart_init(LORA_UART, LORA_BAUD);
+    gpio_set_function(LORA_TX_PIN, GPIO_FUNC_UART);
+    gpio_set_function(LORA_RX_PIN, GPIO_FUNC_UART);
+    lora_init(LORA_UART);
+    emergency_init(LORA_UART); // Botão B -> quadro de emergência direto da interrupção
+    lora_rx_init(LORA_UART);   // Beacons dos vizinhos, guardados pela interrupção
+    uint32_t self_id = badge_id();
+    neighbors_init(&neighbors, self_id);
     
     // Configuração dos LEDs e Buzzer
     gpio_init(LED_BLUE);   gpio_set_dir(LED_BLUE, GPIO_OUT);   gpio_put(LED_BLUE, 0);
@@ -61,95 +253,192 @@ int main() {
     gpio_init(LED_GREEN);  gpio_set_dir(LED_GREEN, GPIO_OUT);  gpio_put(LED_GREEN, 0);
     gpio_init(BUZZER_PIN); gpio_set_dir(BUZZER_PIN, GPIO_OUT); gpio_put(BUZZER_PIN, 0);
     
-    // Configuração dos botões (com pull-up)
-    gpio_init(BUTTON_A);   gpio_set_dir(BUTTON_A, GPIO_IN);   gpio_pull_up(BUTTON_A);
-    gpio_init(BUTTON_B);   gpio_set_dir(BUTTON_B, GPIO_IN);   gpio_pull_up(BUTTON_B);
+    if (warm) {
+        // Partida a quente: retoma a emergência, o buzzer e o tempo parado
+        idle_carry_ms = saved.idle;
+        if (saved.flags & RETAIN_FLAG_FIX_VALID) emergency_set_fix(saved.fix);
+        if (saved.flags & RETAIN_FLAG_EMERGENCY) emergency_trigger(time_us_32());
+        if (saved.alert_level) {
+            buzzer_active = true;
+            gpio_put(BUZZER_PIN, 1);
+        }
+    }
     
-    // Habilita interrupção para o Botão A (usando callback)
-    gpio_set_irq_enabled_with_callback(BUTTON_A, GPIO_IRQ_EDGE_FALL, true, &button_a_handler);
-    // Para o Botão B usaremos polling neste exemplo (poderia ser via IRQ também)
+    // Configuração dos botões (pull-up, debounce em PIO e gestos via callback)
+    const uint button_pins[] = {BUTTON_A, BUTTON_B};
+    const buttons_config_t button_cfg = BUTTONS_CONFIG_DEFAULT;
+#if TRACE_REPLAY
+    buttons_init(button_pins, 2, &button_cfg, live_button_handler);
+#else
+    buttons_init(button_pins, 2, &button_cfg, button_handler);
+#endif
     
     // Inicialização do I2C (para SSD1306 e MPU6050)
-    i2c_init(i2c0, 100 * 1000);
+    i2c_init(i2c0, I2C_HZ);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
     
-    // Inicializa o display OLED
-    ssd1306_t display;
-    ssd1306_init(&display, i2c0, 0x3C, 128, 64);
-    ssd1306_clear(&display);
-    ssd1306_show(&display);
-    
-    // Inicializa o MPU6050
+    // Acorda o MPU6050
     mpu6050_t mpu;
     if (!mpu6050_init(&mpu, i2c0, 0x68)) {
         printf("Erro ao inicializar MPU6050!\n");
     }
     
+    // Inicializa o display OLED (sequência numa única transação)
+    ssd1306_t display;
+    ssd1306_init(&display, i2c0, 0x3C, 128, 64);
+    
+    // Primeira amostra do acelerômetro (descartada; só mede a partida)
+    int16_t first_raw[3];
+    mpu6050_read_raw(&mpu, first_raw);
+    uint32_t first_sample_us = time_us_32();
+    PROF_RECORD_SINCE(PROF_BOOT_SAMPLE, 0);
+    
+    // Primeiro quadro
+    ssd1306_clear(&display);
+    if (emergency_is_active()) ssd1306_draw_string(&display, 0, 0, "EMERGENCIA");
+    ssd1306_show(&display);
+    uint32_t first_frame_us = time_us_32();
+    PROF_RECORD_SINCE(PROF_BOOT_FRAME, 0);
+    
     // Inicializa a UART para o módulo GPS
     uart_init(GPS_UART, GPS_BAUD);
     gpio_set_function(GPS_TX_PIN, GPIO_FUNC_UART);
     gpio_set_function(GPS_RX_PIN, GPIO_FUNC_UART);
     
-    // Inicializa a UART para o módulo LoRa
-    uart_init(LORA_UART, LORA_BAUD);
-    gpio_set_function(LORA_TX_PIN, GPIO_FUNC_UART);
-    gpio_set_function(LORA_RX_PIN, GPIO_FUNC_UART);
-    
     // Inicializa variáveis de tempo
-    last_movement_time = get_absolute_time();
-    last_lora_tx_time = get_absolute_time();
+    last_movement_time = loop_time();
+    last_lora_tx_time = loop_time();
+    absolute_time_t last_stats_time = loop_time();
+    absolute_time_t last_beacon_time = loop_time();
+    
+    // Cada consumidor lê as amostras pelo seu cursor, sem novas leituras
+    bus_subscribe(&sub_motion, BUS_ACCEL);
+    bus_subscribe(&sub_fix, BUS_GPS);
+    bus_subscribe(&sub_report, BUS_GPS);
+    
+    // A stdio USB ainda não está conectada nesta altura: o resumo da partida
+    // sai quando o terminal conectar
+    bool boot_reported = false;
+    
+    // Um travamento reinicia o crachá pelo caminho de partida a quente
+    watchdog_enable(WATCHDOG_MS, true);
     
-    char gps_data[100] = {0};
     char lora_message[150] = {0};
+    char lora_rx[LORA_LINE_MAX];
     
+#if TRACE_REPLAY
+    trace_reader_init(&replay, trace_replay_data, trace_replay_size);
+#endif
+
+    absolute_time_t next_loop = get_absolute_time();
     while (true) {
-        // --- Leitura do módulo GPS ---
-        if(gps_read(GPS_UART, gps_data, sizeof(gps_data))) {
-            // gps_data contém dados recebidos (pode ser uma sentença NMEA)
+        PROF_SCOPE(PROF_MAIN_LOOP);
+        PROF_POLL();
+        watchdog_update();
+        if (!boot_reported && stdio_usb_connected()) {
+            boot_reported = true;
+            if (warm) printf("Partida a quente %lu (emergencia %d)\n", (unsigned long)warm_resets,
+                             emergency_is_active());
+            printf("Partida: 1a amostra em %lu us, 1o quadro em %lu us\n", (unsigned long)first_sample_us,
+                   (unsigned long)first_frame_us);
+            printf("CRC: %s\n", crc_sniffer ? "sniffer do DMA" : "tabela");
+        }
+        TRACE_DRAIN(); // Entradas gravadas desde a última volta (quadros na USB)
+        MIRROR_DRAIN(); // Quadros novos do display (tools/mirror_view.py)
+#if TRACE_REPLAY
+        replay_inputs();
+#endif
+
+        // --- Leitura do módulo GPS (produtor do tópico BUS_GPS) ---
+        char gps_line[BUS_GPS_MAX];
+        bool gps_ok;
+#if TRACE_REPLAY
+        if (replay_active) {
+            gps_ok = replay_gps_ready;
+            if (gps_ok) snprintf(gps_line, sizeof(gps_line), "%s", replay_gps);
+            replay_gps_ready = false;
+        } else
+#endif
+        gps_ok = gps_read(GPS_UART, gps_line, sizeof(gps_line));
+        if (gps_ok) {
+            // gps_line contém dados recebidos (pode ser uma sentença NMEA)
+            TRACE_BYTES(TRACE_CH_GPS, gps_line, strlen(gps_line));
+            bus_gps_t *g = bus_claim(BUS_GPS);
+            memcpy(g->sentence, gps_line, sizeof(g->sentence));
+            bus_publish(BUS_GPS, loop_time_us());
+        }
+        
+        // Posição usada pelos quadros de emergência
+        const bus_gps_t *fix;
+        while ((fix = bus_peek(&sub_fix, NULL))) {
+            emergency_set_fix(fix->sentence);
+            bus_release(&sub_fix);
         }
         
         // --- Leitura do acelerômetro (MPU6050) ---
-        float ax, ay, az;
-        if (mpu6050_read_accel(&mpu, &ax, &ay, &az)) {
+        // Os registros crus são gravados; a conversão para g é refeita na
+        // reprodução, com o mesmo resultado
+        int16_t raw[3];
+        bool accel_ok;
+#if TRACE_REPLAY
+        if (replay_active) {
+            accel_ok = replay_accel_ok;
+            memcpy(raw, replay_accel, sizeof(raw));
+        } else
+#endif
+        accel_ok = mpu6050_read_raw(&mpu, raw);
+        if (accel_ok) {
+            TRACE_SAMPLE(TRACE_CH_ACCEL, raw[0], raw[1], raw[2]);
+            // Publicada já em g: os consumidores não repetem a conversão
+            bus_accel_t *a = bus_claim(BUS_ACCEL);
+            memcpy(a->raw, raw, sizeof(a->raw));
+            mpu6050_accel_to_g(raw, &a->g[0], &a->g[1], &a->g[2]);
+            bus_publish(BUS_ACCEL, loop_time_us());
+        } else {
+            TRACE_SAMPLE(TRACE_CH_ACCEL, TRACE_ACCEL_FAILED, 0, 0);
+        }
+        
+        // Detector de movimento: todas as amostras desde a última volta
+        bool movement_detected = false;
+        const bus_accel_t *accel;
+        while ((accel = bus_peek(&sub_motion, NULL))) {
             // Considera movimento se qualquer aceleração ultrapassar um limiar
             float movement_threshold = 0.1f; // ajuste conforme necessário
-            bool movement_detected = (fabs(ax) > movement_threshold || fabs(ay) > movement_threshold || fabs(az) > movement_threshold);
-            if (movement_detected) {
-                last_movement_time = get_absolute_time();
-                // Desliga alertas visuais e sonoros
-                gpio_put(LED_BLUE, 0);
-                gpio_put(LED_RED, 0);
-                gpio_put(BUZZER_PIN, 0);
-                buzzer_active = false;
-                // Limpa mensagem de alerta no display
-                ssd1306_clear(&display);
-                ssd1306_show(&display);
-            }
+            bool moved = (fabs(accel->g[0]) > movement_threshold || fabs(accel->g[1]) > movement_threshold || fabs(accel->g[2]) > movement_threshold);
+            if (bus_release(&sub_motion) && moved) movement_detected = true;
         }
-        
-        // --- Verificação do tempo de inatividade ---
-        int64_t elapsed = absolute_time_diff_us(last_movement_time, get_absolute_time()) / 1000; // em ms
-        
-        // Se inativo por 5 minutos, pisca LED azul por 30 s
-        if (elapsed >= NO_MOVEMENT_5_MIN && elapsed < NO_MOVEMENT_5_MIN + 30000) {
-            gpio_put(LED_BLUE, 1);
-            sleep_ms(500);
+        if (movement_detected) {
+            last_movement_time = loop_time();
+            idle_carry_ms = 0;
+            // Desliga alertas visuais e sonoros
             gpio_put(LED_BLUE, 0);
-            sleep_ms(500);
+            gpio_put(LED_RED, 0);
+            gpio_put(BUZZER_PIN, 0);
+            buzzer_active = false;
+            // Limpa mensagem de alerta no display
+            ssd1306_clear(&display);
+            ssd1306_show(&display);
         }
         
-        // Se inativo por 10 minutos, pisca LED vermelho e exibe "ATENCAO" por 30 s
+        // --- Verificação do tempo de inatividade ---
+        int64_t elapsed = absolute_time_diff_us(last_movement_time, loop_time()) / 1000 + idle_carry_ms; // em ms
+        
+        // Se inativo por 5 minutos, pisca LED azul por 30 s; por 10 minutos,
+        // pisca LED vermelho e exibe "ATENCAO" por 30 s
+        int blink = -1;
+        if (elapsed >= NO_MOVEMENT_5_MIN && elapsed < NO_MOVEMENT_5_MIN + 30000) blink = LED_BLUE;
         if (elapsed >= NO_MOVEMENT_10_MIN && elapsed < NO_MOVEMENT_10_MIN + 30000) {
-            gpio_put(LED_RED, 1);
-            ssd1306_draw_string(&display, 0, 0, "ATENCAO");
-            ssd1306_show(&display);
-            sleep_ms(500);
-            gpio_put(LED_RED, 0);
-            sleep_ms(500);
+            if (blink_pin != LED_RED) {
+                ssd1306_draw_string(&display, 0, 0, "ATENCAO");
+                ssd1306_show(&display);
+            }
+            blink = LED_RED;
         }
+        blink_set(blink);
+        blink_service();
         
         // Se inativo por 15 minutos, ativa buzzer até o Botão A ser pressionado
         if (elapsed >= NO_MOVEMENT_15_MIN && !buzzer_active) {
@@ -157,36 +446,97 @@ int main() {
             gpio_put(BUZZER_PIN, 1);
         }
         
-        // --- Transmissão via LoRa a cada 2 minutos ---
-        int64_t lora_elapsed = absolute_time_diff_us(last_lora_tx_time, get_absolute_time()) / 1000;
+        // Sentença mais recente do GPS (NULL se nenhuma chegou ainda). O
+        // produtor está neste mesmo laço: a amostra não muda até o release
+        const bus_gps_t *gps = bus_latest(&sub_report, NULL);
+        const char *gps_data = gps ? gps->sentence : "";
+        
+        // --- Crachás vizinhos: beacons recebidos desde a última volta ---
+        uint32_t now_ms = to_ms_since_boot(loop_time());
+        while (lora_read_line(lora_rx, sizeof(lora_rx))) neighbors_line(&neighbors, lora_rx, now_ms);
+        neighbors_age(&neighbors, now_ms);
+        if (absolute_time_diff_us(last_beacon_time, loop_time()) / 1000 >= BEACON_INTERVAL) {
+            neighbors_beacon(self_id, lora_message, sizeof(lora_message));
+            lora_send(LORA_UART, lora_message);
+            last_beacon_time = loop_time();
+        }
+        
+        // --- Transmissão via LoRa a cada 2 minutos (posição e resumo dos vizinhos) ---
+        int64_t lora_elapsed = absolute_time_diff_us(last_lora_tx_time, loop_time()) / 1000;
         if (lora_elapsed >= LORA_TX_INTERVAL) {
             snprintf(lora_message, sizeof(lora_message), "GPS: %s", gps_data);
             lora_send(LORA_UART, lora_message);
-            last_lora_tx_time = get_absolute_time();
+            if (neighbors_summary(&neighbors, now_ms, lora_message, sizeof(lora_message)))
+                lora_send(LORA_UART, lora_message);
+            last_lora_tx_time = loop_time();
         }
         
-        // --- Verificação do Botão B para EMERGENCIA ---
-        if (!gpio_get(BUTTON_B)) {
-            sleep_ms(50); // debounce
-            if (!gpio_get(BUTTON_B)) {
-                printf("EMERGENCIA: %s\n", gps_data);
-                snprintf(lora_message, sizeof(lora_message), "EMERGENCIA: %s", gps_data);
-                lora_send(LORA_UART, lora_message);
-                // Aguarda liberação do botão para evitar múltiplos disparos
-                while (!gpio_get(BUTTON_B)) { sleep_ms(50); }
-            }
+        if (!button_a_reported) {
+            button_a_reported = true;
+            printf("Botao A pressionado: alertas reiniciados.\n");
+        }
+        
+        // --- EMERGENCIA: o quadro já saiu pela interrupção do Botão B ---
+        emergency_stats_t em;
+        if (emergency_poll_report(&em)) {
+            printf("EMERGENCIA: %s\n", gps_data);
+            printf("EMERGENCIA enviada em %lu us (pressao: %lu us, pior caso: %lu us)\n",
+                   (unsigned long)em.last_us, (unsigned long)em.press_us, (unsigned long)em.max_us);
+            ssd1306_clear(&display);
+            ssd1306_draw_string(&display, 0, 0, "EMERGENCIA");
+            ssd1306_show(&display);
         }
         
-        sleep_ms(200); // Delay do loop principal
+        save_state(gps ? gps_data : NULL, elapsed);
+        if (gps) bus_release(&sub_report);
+        
+        if (absolute_time_diff_us(last_stats_time, loop_time()) / 1000 >= BUS_STATS_MS) {
+            print_bus_stats();
+#if MIRROR_ENABLED
+            mirror_stats_t ms;
+            mirror_get_stats(&ms);
+            if (ms.frames)
+                printf("Espelho do display: %lu quadros (%lu chave), %lu bytes\n", (unsigned long)ms.frames,
+                       (unsigned long)ms.keys, (unsigned long)ms.bytes);
+#endif
+            printf("Vizinhos: %u na tabela, %lu beacons, %lu recusados, %lu expirados, %lu bytes perdidos na UART, "
+                   "%lu linhas com CRC errado\n",
+                   neighbors.count, (unsigned long)neighbors.heard, (unsigned long)neighbors.rejected,
+                   (unsigned long)neighbors.expired, (unsigned long)lora_rx_dropped(),
+                   (unsigned long)lora_rx_crc_errors());
+            last_stats_time = loop_time();
+        }
+        // Próxima volta num prazo fixo, acordando antes para as piscadas
+        next_loop = delayed_by_ms(next_loop, LOOP_PERIOD_MS);
+        if (time_reached(next_loop)) next_loop = get_absolute_time(); // Volta longa: não tenta recuperar
+        while (!time_reached(next_loop)) {
+            absolute_time_t wake = next_loop;
+            if (blink_pin >= 0 && absolute_time_diff_us(blink_next, wake) > 0) wake = blink_next;
+            sleep_until(wake);
+            blink_service();
+        }
     }
     
     return 0;
 }
 
-void button_a_handler(uint gpio, uint32_t events) {
-    // Ao pressionar o Botão A, desativa o buzzer e reseta os alertas
-    gpio_put(BUZZER_PIN, 0);
-    buzzer_active = false;
-    last_movement_time = get_absolute_time();
-    printf("Botao A pressionado: alertas reiniciados.\n");
+void RAM_HOT_FUNC(button_handler)(const button_event_t *ev) {
+    TRACE_SAMPLE(TRACE_CH_BUTTON, ev->gpio, ev->gesture, ev->duration_us);
+    if (ev->gpio == BUTTON_A && ev->gesture != BUTTON_PRESS) {
+        // Ao pressionar o Botão A, desativa o buzzer e reseta os alertas
+        gpio_put(BUZZER_PIN, 0);
+        buzzer_active = false;
+        last_movement_time = loop_time();
+        idle_carry_ms = 0;
+        emergency_cancel();
+        save_state(NULL, -1);
+        button_a_reported = false; // printf aqui, na interrupção da PIO, cortaria os quadros do espelho e da gravação
+    } else if (ev->gpio == BUTTON_B) {
+        // Cada pressão do Botão B dispara a emergência, sem esperar o botão
+        // ser solto: o quadro sai daqui mesmo, sem passar pelo laço
+        if (ev->gesture == BUTTON_PRESS) {
+            emergency_trigger(ev->t_us);
+            save_state(NULL, -1);
+        }
+    }
 }
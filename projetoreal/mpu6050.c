@@ -1,5 +1,7 @@
 #include "mpu6050.h"
+#include "prof.h"
 #include "pico/stdlib.h"
+#include "ram_hot.h"
 #include <stdint.h>
 
 #define MPU6050_REG_PWR_MGMT_1   0x6B
@@ -15,7 +17,8 @@ bool mpu6050_init(mpu6050_t *mpu, i2c_inst_t *i2c, uint8_t addr) {
     return (ret == 2);
 }
 
-bool mpu6050_read_accel(mpu6050_t *mpu, float *ax, float *ay, float *az) {
+bool RAM_HOT_FUNC(mpu6050_read_raw)(mpu6050_t *mpu, int16_t raw[3]) {
+    PROF_SCOPE(PROF_MPU6050_READ);
     uint8_t reg = MPU6050_REG_ACCEL_XOUT_H;
     uint8_t data[6];
     int ret = i2c_write_blocking(mpu->i2c, mpu->addr, &reg, 1, true);
@@ -23,13 +26,22 @@ bool mpu6050_read_accel(mpu6050_t *mpu, float *ax, float *ay, float *az) {
     ret = i2c_read_blocking(mpu->i2c, mpu->addr, data, 6, false);
     if (ret != 6) return false;
     
-    int16_t raw_ax = (data[0] << 8) | data[1];
-    int16_t raw_ay = (data[2] << 8) | data[3];
-    int16_t raw_az = (data[4] << 8) | data[5];
-    
+    raw[0] = (int16_t)((data[0] << 8) | data[1]);
+    raw[1] = (int16_t)((data[2] << 8) | data[3]);
+    raw[2] = (int16_t)((data[4] << 8) | data[5]);
+    return true;
+}
+
+void RAM_HOT_FUNC(mpu6050_accel_to_g)(const int16_t raw[3], float *ax, float *ay, float *az) {
     // Sensibilidade típica: 16384 LSB/g para ±2g
-    *ax = raw_ax / 16384.0f;
-    *ay = raw_ay / 16384.0f;
-    *az = raw_az / 16384.0f;
+    *ax = raw[0] / 16384.0f;
+    *ay = raw[1] / 16384.0f;
+    *az = raw[2] / 16384.0f;
+}
+
+bool mpu6050_read_accel(mpu6050_t *mpu, float *ax, float *ay, float *az) {
+    int16_t raw[3];
+    if (!mpu6050_read_raw(mpu, raw)) return false;
+    mpu6050_accel_to_g(raw, ax, ay, az);
     return true;
 }
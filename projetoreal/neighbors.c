@@ -0,0 +1,171 @@
+#include "neighbors.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NEIGHBORS_MASK (NEIGHBORS_SLOTS - 1)
+
+// Hash multiplicativo: IDs próximos (sequenciais) caem longe uns dos outros
+static inline uint32_t neighbors_home(uint32_t id) {
+    return ((id * 2654435761u) >> 16) & NEIGHBORS_MASK;
+}
+
+static inline bool neighbors_changed(const neighbors_t *nb, uint32_t i) {
+    return nb->changed[i / 32] & (1u << (i % 32));
+}
+
+static inline void neighbors_mark(neighbors_t *nb, uint32_t i, bool on) {
+    if (on)
+        nb->changed[i / 32] |= 1u << (i % 32);
+    else
+        nb->changed[i / 32] &= ~(1u << (i % 32));
+}
+
+// Posição da entrada 'id' ou, se ela não existe, a posição livre onde
+// entraria. Termina porque sempre há posições livres (NEIGHBORS_MAX <
+// NEIGHBORS_SLOTS).
+static uint32_t neighbors_probe(const neighbors_t *nb, uint32_t id) {
+    uint32_t i = neighbors_home(id);
+    while (nb->slots[i].id != 0 && nb->slots[i].id != id) i = (i + 1) & NEIGHBORS_MASK;
+    return i;
+}
+
+// Remove a entrada 'i' trazendo para trás as seguintes do mesmo bloco que
+// podem ocupar a posição liberada (sondagem linear sem lápides)
+static void neighbors_remove(neighbors_t *nb, uint32_t i) {
+    uint32_t j = i;
+    for (;;) {
+        j = (j + 1) & NEIGHBORS_MASK;
+        if (nb->slots[j].id == 0) break;
+        uint32_t home = neighbors_home(nb->slots[j].id);
+        if (((j - home) & NEIGHBORS_MASK) >= ((j - i) & NEIGHBORS_MASK)) {
+            nb->slots[i] = nb->slots[j];
+            neighbors_mark(nb, i, neighbors_changed(nb, j));
+            i = j;
+        }
+    }
+    nb->slots[i].id = 0;
+    neighbors_mark(nb, i, false);
+    nb->count--;
+}
+
+void neighbors_init(neighbors_t *nb, uint32_t self_id) {
+    memset(nb, 0, sizeof(*nb));
+    nb->self_id = self_id;
+}
+
+uint32_t neighbors_beacon(uint32_t self_id, char *out, uint32_t size) {
+    int n = snprintf(out, size, "B:%08lX", (unsigned long)self_id);
+    return n < 0 ? 0 : (uint32_t)n;
+}
+
+bool neighbors_parse(const char *line, uint32_t *id, int8_t *rssi) {
+    if (line[0] != 'B' || line[1] != ':') return false;
+    const char *p = line + 2;
+    uint32_t v = 0;
+    int digits = 0;
+    for (; digits < 9; p++, digits++) {
+        char c = *p;
+        uint32_t d;
+        if (c >= '0' && c <= '9')
+            d = (uint32_t)(c - '0');
+        else if (c >= 'A' && c <= 'F')
+            d = (uint32_t)(c - 'A' + 10);
+        else if (c >= 'a' && c <= 'f')
+            d = (uint32_t)(c - 'a' + 10);
+        else
+            break;
+        v = (v << 4) | d;
+    }
+    if (digits == 0 || digits > 8 || v == 0) return false;
+
+    int32_t r = NEIGHBORS_RSSI_UNKNOWN;
+    if (*p == ',') {
+        p++;
+        bool neg = *p == '-';
+        if (neg) p++;
+        if (*p < '0' || *p > '9') return false;
+        r = 0;
+        while (*p >= '0' && *p <= '9' && r < 1000) r = r * 10 + (*p++ - '0');
+        if (neg) r = -r;
+        if (r < INT8_MIN) r = INT8_MIN;
+        if (r > INT8_MAX) r = INT8_MAX;
+    }
+    if (*p != '\0') return false;
+    *id = v;
+    *rssi = (int8_t)r;
+    return true;
+}
+
+bool neighbors_heard(neighbors_t *nb, uint32_t id, int8_t rssi, uint32_t now_ms) {
+    if (id == 0 || id == nb->self_id) return false;
+    uint32_t i = neighbors_probe(nb, id);
+    neighbor_t *n = &nb->slots[i];
+    if (n->id != id) {
+        if (nb->count >= NEIGHBORS_MAX) {
+            nb->rejected++;
+            return false;
+        }
+        memset(n, 0, sizeof(*n));
+        n->id = id;
+        n->first_ms = now_ms;
+        n->encounters = 1;
+        nb->count++;
+    } else if (now_ms - n->last_ms > NEIGHBORS_GAP_MS) {
+        n->first_ms = now_ms;
+        if (n->encounters < UINT8_MAX) n->encounters++;
+    }
+    n->last_ms = now_ms;
+    n->rssi = rssi;
+    if (n->beacons < UINT16_MAX) n->beacons++;
+    neighbors_mark(nb, i, true);
+    nb->heard++;
+    return true;
+}
+
+bool neighbors_line(neighbors_t *nb, const char *line, uint32_t now_ms) {
+    uint32_t id;
+    int8_t rssi;
+    return neighbors_parse(line, &id, &rssi) && neighbors_heard(nb, id, rssi, now_ms);
+}
+
+void neighbors_age(neighbors_t *nb, uint32_t now_ms) {
+    for (uint32_t k = 0; k < NEIGHBORS_SWEEP_SLOTS && nb->count; k++) {
+        uint32_t i = nb->sweep;
+        nb->sweep = (uint16_t)((i + 1) & NEIGHBORS_MASK);
+        const neighbor_t *n = &nb->slots[i];
+        if (n->id != 0 && now_ms - n->last_ms > NEIGHBORS_TIMEOUT_MS) {
+            // Uma entrada trazida para 'i' só é examinada na próxima passada
+            neighbors_remove(nb, i);
+            nb->expired++;
+        }
+    }
+}
+
+const neighbor_t *neighbors_find(const neighbors_t *nb, uint32_t id) {
+    if (id == 0) return NULL;
+    const neighbor_t *n = &nb->slots[neighbors_probe(nb, id)];
+    return n->id == id ? n : NULL;
+}
+
+uint32_t neighbors_summary(neighbors_t *nb, uint32_t now_ms, char *out, uint32_t size) {
+    uint32_t used = 2, entries = 0;
+    if (size < 3) return 0;
+    memcpy(out, "V:", 3);
+    for (uint32_t scanned = 0; scanned < NEIGHBORS_SLOTS; scanned++) {
+        uint32_t i = nb->report;
+        if (neighbors_changed(nb, i)) {
+            const neighbor_t *n = &nb->slots[i];
+            char item[40];
+            int len = snprintf(item, sizeof(item), "%s%08lX,%d,%u,%lu", entries ? ";" : "", (unsigned long)n->id,
+                               n->rssi, n->encounters, (unsigned long)((now_ms - n->last_ms) / 1000));
+            if (len < 0 || used + (uint32_t)len >= size) break; // Fica para o próximo resumo
+            memcpy(&out[used], item, (uint32_t)len + 1);
+            used += (uint32_t)len;
+            neighbors_mark(nb, i, false);
+            entries++;
+        }
+        nb->report = (uint16_t)((i + 1) & NEIGHBORS_MASK);
+    }
+    if (entries == 0) out[0] = '\0';
+    return entries;
+}
@@ -2,13 +2,33 @@
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "fonte.h"
+#include "prof.h"
+#include "mirror.h"
+#include "ram_hot.h"
 #include <string.h>
 
-// Função auxiliar para enviar comandos
-static void ssd1306_write_command(ssd1306_t *dev, uint8_t command) {
-    uint8_t data[2] = {0x00, command};
-    i2c_write_blocking(dev->i2c, dev->addr, data, 2, false);
-}
+// Sequência de inicialização simplificada. Depois do byte de controle 0x00,
+// todos os bytes da transação são comandos: vai tudo numa escrita I2C.
+static const uint8_t ssd1306_init_seq[] = {
+    0x00,       // Controle: comandos
+    0xAE,       // Display off
+    0xD5, 0x80, // Clock divide ratio/oscillator frequency
+    0xA8, 0x3F, // Multiplex ratio (altura - 1, ajustada em ssd1306_init)
+    0xD3, 0x00, // Display offset
+    0x40,       // Start line address
+    0x8D, 0x14, // Charge pump
+    0x20, 0x00, // Memory addressing mode
+    0xA1,       // Segment re-map
+    0xC8,       // COM output scan direction
+    0xDA, 0x12, // COM pins hardware configuration
+    0x81, 0xCF, // Contrast control
+    0xD9, 0xF1, // Pre-charge period
+    0xDB, 0x40, // VCOMH deselect level
+    0xA4,       // Entire display on
+    0xA6,       // Normal display
+    0xAF,       // Display on
+};
+#define SSD1306_INIT_MUX 5 // Posição do parâmetro do multiplex na sequência
 
 void ssd1306_init(ssd1306_t *dev, i2c_inst_t *i2c, uint8_t addr, uint8_t width, uint8_t height) {
     dev->i2c = i2c;
@@ -16,33 +36,11 @@ void ssd1306_init(ssd1306_t *dev, i2c_inst_t *i2c, uint8_t addr, uint8_t width,
     dev->width = width;
     dev->height = height;
     memset(dev->buffer, 0, sizeof(dev->buffer));
-    
-    // Sequência de inicialização simplificada
-    ssd1306_write_command(dev, 0xAE); // Display off
-    ssd1306_write_command(dev, 0xD5); // Clock divide ratio/oscillator frequency
-    ssd1306_write_command(dev, 0x80);
-    ssd1306_write_command(dev, 0xA8); // Multiplex ratio
-    ssd1306_write_command(dev, height - 1);
-    ssd1306_write_command(dev, 0xD3); // Display offset
-    ssd1306_write_command(dev, 0x00);
-    ssd1306_write_command(dev, 0x40); // Start line address
-    ssd1306_write_command(dev, 0x8D); // Charge pump
-    ssd1306_write_command(dev, 0x14);
-    ssd1306_write_command(dev, 0x20); // Memory addressing mode
-    ssd1306_write_command(dev, 0x00);
-    ssd1306_write_command(dev, 0xA1); // Segment re-map
-    ssd1306_write_command(dev, 0xC8); // COM output scan direction
-    ssd1306_write_command(dev, 0xDA); // COM pins hardware configuration
-    ssd1306_write_command(dev, 0x12);
-    ssd1306_write_command(dev, 0x81); // Contrast control
-    ssd1306_write_command(dev, 0xCF);
-    ssd1306_write_command(dev, 0xD9); // Pre-charge period
-    ssd1306_write_command(dev, 0xF1);
-    ssd1306_write_command(dev, 0xDB); // VCOMH deselect level
-    ssd1306_write_command(dev, 0x40);
-    ssd1306_write_command(dev, 0xA4); // Entire display on
-    ssd1306_write_command(dev, 0xA6); // Normal display
-    ssd1306_write_command(dev, 0xAF); // Display on
+
+    uint8_t seq[sizeof(ssd1306_init_seq)];
+    memcpy(seq, ssd1306_init_seq, sizeof(seq));
+    seq[SSD1306_INIT_MUX] = height - 1;
+    i2c_write_blocking(dev->i2c, dev->addr, seq, sizeof(seq), false);
 }
 
 void ssd1306_clear(ssd1306_t *dev) {
@@ -50,13 +48,14 @@ void ssd1306_clear(ssd1306_t *dev) {
 }
 
 void ssd1306_show(ssd1306_t *dev) {
-    ssd1306_write_command(dev, 0x21); // Set column address
-    ssd1306_write_command(dev, 0);
-    ssd1306_write_command(dev, dev->width - 1);
-    
-    ssd1306_write_command(dev, 0x22); // Set page address
-    ssd1306_write_command(dev, 0);
-    ssd1306_write_command(dev, (dev->height / 8) - 1);
+    PROF_SCOPE(PROF_SSD1306_SHOW);
+    // Janela de colunas e de páginas numa só transação de comandos
+    uint8_t window[] = {
+        0x00,
+        0x21, 0, dev->width - 1,        // Set column address
+        0x22, 0, (dev->height / 8) - 1, // Set page address
+    };
+    i2c_write_blocking(dev->i2c, dev->addr, window, sizeof(window), false);
     
     uint8_t data[17];
     data[0] = 0x40; // Modo de dados
@@ -67,6 +66,7 @@ void ssd1306_show(ssd1306_t *dev) {
         i2c_write_blocking(dev->i2c, dev->addr, data, chunk + 1, false);
         i += chunk;
     }
+    MIRROR_FRAME(dev->buffer, dev->width, dev->height); // O que acabou de ir pela I2C
 }
 
 void ssd1306_draw_string(ssd1306_t *dev, uint8_t x, uint8_t y, const char *str) {
@@ -77,7 +77,7 @@ void ssd1306_draw_string(ssd1306_t *dev, uint8_t x, uint8_t y, const char *str)
     (void)dev; (void)x; (void)y; (void)str;
 }
 
-void ssd1306_draw_border(ssd1306_t *dev, int thickness) {
+void RAM_HOT_FUNC(ssd1306_draw_border)(ssd1306_t *dev, int thickness) {
     // Desenha uma borda simples no buffer
     for (int t = 0; t < thickness; t++) {
         // Linhas superior e inferior
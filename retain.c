@@ -0,0 +1,74 @@
+#include "retain.h"
+#include "crc.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t magic;
+    uint32_t resets;       // Partidas a quente seguidas
+    retain_state_t state;
+    uint32_t crc;          // Cobre todos os campos anteriores
+} retain_block_t;
+
+// retain_save calcula o CRC em duas partes (até 'state' e a cópia de 'state')
+_Static_assert(offsetof(retain_block_t, crc) == offsetof(retain_block_t, state) + sizeof(retain_state_t),
+               "retain_block_t: espaço entre 'state' e 'crc'");
+
+// O tamanho entra no número mágico: um bloco gravado por outra versão do
+// firmware (outro layout) é descartado
+#define RETAIN_MAGIC (0x52544E00u ^ (uint32_t)sizeof(retain_block_t))
+
+static retain_block_t __uninitialized_ram(retain_block);
+static volatile uint32_t retain_gen; // Gravações desde a partida
+
+static bool retain_valid(void) {
+    return retain_block.magic == RETAIN_MAGIC &&
+           retain_block.crc == crc32(&retain_block, offsetof(retain_block_t, crc));
+}
+
+bool retain_load(retain_state_t *out, uint32_t *resets) {
+    if (!retain_valid()) {
+        memset(&retain_block, 0, sizeof(retain_block));
+        return false;
+    }
+    retain_block.resets++;
+    retain_block.state.fix[RETAIN_FIX_MAX - 1] = '\0';
+    retain_block.crc = crc32(&retain_block, offsetof(retain_block_t, crc));
+    *out = retain_block.state;
+    if (resets) *resets = retain_block.resets;
+    return true;
+}
+
+uint32_t retain_snapshot(retain_state_t *out) {
+    uint32_t gen = retain_gen;
+    // Sem máscara: se uma interrupção gravar no meio, a geração muda e a
+    // gravação feita a partir desta cópia é recusada
+    *out = retain_block.state;
+    return gen;
+}
+
+bool retain_save(const retain_state_t *state, uint32_t gen) {
+    retain_block_t block;
+    block.magic = RETAIN_MAGIC;
+    block.resets = retain_block.resets; // Só muda em retain_load, na partida
+    // O CRC do estado sai da própria cópia (sniffer do DMA, crc.h)
+    uint32_t crc = crc32_update(CRC32_INIT, &block, offsetof(retain_block_t, state));
+    block.crc = ~crc32_copy(&block.state, state, sizeof(*state), crc);
+
+    uint32_t irq = save_and_disable_interrupts();
+    bool current = retain_gen == gen;
+    if (current) {
+        retain_block = block;
+        retain_gen = gen + 1;
+    }
+    restore_interrupts(irq);
+    return current;
+}
+
+void retain_clear(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    retain_block.magic = 0;
+    restore_interrupts(irq);
+}
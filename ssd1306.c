@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include "fonte.h"
+#include "prof.h"
+#include "mirror.h"
+#include "ram_hot.h"
 
 #define SSD1306_CMD  0x00
 #define SSD1306_DATA 0x40
@@ -10,10 +13,28 @@
 // Define a margem interna para a borda
 #define BORDER_MARGIN 2
 
-static void ssd1306_send_command(ssd1306_t *dev, uint8_t cmd) {
-    uint8_t data[2] = { SSD1306_CMD, cmd };
-    i2c_write_blocking(dev->i2c, dev->address, data, 2, false);
-}
+// Sequência de inicialização. Depois do byte de controle 0x00, o SSD1306
+// trata todos os bytes da transação como comandos: a sequência inteira vai
+// numa única escrita I2C em vez de uma por comando.
+static const uint8_t ssd1306_init_seq[] = {
+    SSD1306_CMD,
+    0xAE,       // Display off
+    0xD5, 0x80, // Set display clock divide ratio/oscillator frequency
+    0xA8, 0x3F, // Set multiplex ratio (altura - 1, ajustada em ssd1306_init)
+    0xD3, 0x00, // Set display offset
+    0x40,       // Set start line address
+    0x8D, 0x14, // Charge pump setting
+    0xA1,       // Set segment re-map
+    0xC8,       // Set COM output scan direction
+    0xDA, 0x12, // Set COM pins hardware configuration
+    0x81, 0xCF, // Set contrast control
+    0xD9, 0xF1, // Set pre-charge period
+    0xDB, 0x40, // Set VCOMH deselect level
+    0xA4,       // Entire display on from RAM
+    0xA6,       // Normal display
+    0xAF,       // Display on
+};
+#define SSD1306_INIT_MUX 5 // Posição do parâmetro do multiplex em ssd1306_init_seq
 
 void ssd1306_init(ssd1306_t *dev, i2c_inst_t *i2c, uint8_t address, uint8_t width, uint8_t height) {
     dev->i2c = i2c;
@@ -22,43 +43,27 @@ void ssd1306_init(ssd1306_t *dev, i2c_inst_t *i2c, uint8_t address, uint8_t widt
     dev->height = height;
     memset(dev->buffer, 0, sizeof(dev->buffer));
 
-    ssd1306_send_command(dev, 0xAE);       // Display off
-    ssd1306_send_command(dev, 0xD5);       // Set display clock divide ratio/oscillator frequency
-    ssd1306_send_command(dev, 0x80);
-    ssd1306_send_command(dev, 0xA8);       // Set multiplex ratio
-    ssd1306_send_command(dev, height - 1);
-    ssd1306_send_command(dev, 0xD3);       // Set display offset
-    ssd1306_send_command(dev, 0x00);
-    ssd1306_send_command(dev, 0x40);       // Set start line address
-    ssd1306_send_command(dev, 0x8D);       // Charge pump setting
-    ssd1306_send_command(dev, 0x14);
-    ssd1306_send_command(dev, 0xA1);       // Set segment re-map
-    ssd1306_send_command(dev, 0xC8);       // Set COM output scan direction
-    ssd1306_send_command(dev, 0xDA);       // Set COM pins hardware configuration
-    ssd1306_send_command(dev, 0x12);
-    ssd1306_send_command(dev, 0x81);       // Set contrast control
-    ssd1306_send_command(dev, 0xCF);
-    ssd1306_send_command(dev, 0xD9);       // Set pre-charge period
-    ssd1306_send_command(dev, 0xF1);
-    ssd1306_send_command(dev, 0xDB);       // Set VCOMH deselect level
-    ssd1306_send_command(dev, 0x40);
-    ssd1306_send_command(dev, 0xA4);       // Entire display on from RAM
-    ssd1306_send_command(dev, 0xA6);       // Normal display
-    ssd1306_send_command(dev, 0xAF);       // Display on
+    uint8_t seq[sizeof(ssd1306_init_seq)];
+    memcpy(seq, ssd1306_init_seq, sizeof(seq));
+    seq[SSD1306_INIT_MUX] = height - 1;
+    i2c_write_blocking(dev->i2c, dev->address, seq, sizeof(seq), false);
 }
 
 void ssd1306_show(ssd1306_t *dev) {
-    ssd1306_send_command(dev, 0x21);  // Set column address
-    ssd1306_send_command(dev, 0);
-    ssd1306_send_command(dev, dev->width - 1);
-    ssd1306_send_command(dev, 0x22);  // Set page address
-    ssd1306_send_command(dev, 0);
-    ssd1306_send_command(dev, (dev->height / 8) - 1);
-    
+    PROF_SCOPE(PROF_SSD1306_SHOW);
+    // Janela de colunas e páginas numa só transação de comandos
+    uint8_t window[] = {
+        SSD1306_CMD,
+        0x21, 0, dev->width - 1,          // Set column address
+        0x22, 0, (dev->height / 8) - 1,   // Set page address
+    };
+    i2c_write_blocking(dev->i2c, dev->address, window, sizeof(window), false);
+
     uint8_t data[1 + sizeof(dev->buffer)];
     data[0] = SSD1306_DATA;
     memcpy(&data[1], dev->buffer, sizeof(dev->buffer));
     i2c_write_blocking(dev->i2c, dev->address, data, sizeof(data), false);
+    MIRROR_FRAME(&data[1], dev->width, dev->height); // Mesmo buffer da escrita I2C
 }
 
 void ssd1306_clear(ssd1306_t *dev) {
@@ -66,7 +71,7 @@ void ssd1306_clear(ssd1306_t *dev) {
     ssd1306_show(dev);
 }
 
-void ssd1306_draw_pixel(ssd1306_t *dev, int x, int y, uint8_t color) {
+void RAM_HOT_FUNC(ssd1306_draw_pixel)(ssd1306_t *dev, int x, int y, uint8_t color) {
     if (x < 0 || x >= dev->width || y < 0 || y >= dev->height) return;
     
     int index = x + (y / 8) * dev->width;
@@ -78,7 +83,7 @@ void ssd1306_draw_pixel(ssd1306_t *dev, int x, int y, uint8_t color) {
         dev->buffer[index] &= ~mask;
 }
 
-static void ssd1306_draw_char(ssd1306_t *dev, int x, int y, char c) {
+static void RAM_HOT_FUNC(ssd1306_draw_char)(ssd1306_t *dev, int x, int y, char c) {
     const uint8_t *font = NULL;
     if (c >= 'A' && c <= 'Z')
         font = font_uppercase[c - 'A'];
@@ -89,15 +94,28 @@ static void ssd1306_draw_char(ssd1306_t *dev, int x, int y, char c) {
     else
         return; // Ignora caractere não suportado
     
+    // Cada coluna do caractere cobre no máximo duas páginas do buffer: os 8
+    // pixels vão de uma vez, com os bits das linhas vizinhas preservados
+    int page = y >> 3;
+    int shift = y & 7;
+    int pages = dev->height / 8;
+    uint8_t keep_lo = (uint8_t)~(0xFF << shift);
+    uint8_t keep_hi = (uint8_t)~(0xFF >> (8 - shift));
     for (int i = 0; i < 5; i++) {
-        for (int j = 0; j < 8; j++) {
-            uint8_t pixel = font[i] & (1 << j);
-            ssd1306_draw_pixel(dev, x + i, y + j, pixel ? 1 : 0);
+        int col = x + i;
+        if (col < 0 || col >= dev->width) continue;
+        if (page >= 0 && page < pages) {
+            uint8_t *b = &dev->buffer[page * dev->width + col];
+            *b = (uint8_t)((*b & keep_lo) | (font[i] << shift));
+        }
+        if (shift && page + 1 >= 0 && page + 1 < pages) {
+            uint8_t *b = &dev->buffer[(page + 1) * dev->width + col];
+            *b = (uint8_t)((*b & keep_hi) | (font[i] >> (8 - shift)));
         }
     }
 }
 
-void ssd1306_draw_string(ssd1306_t *dev, int x, int y, const char *str) {
+void RAM_HOT_FUNC(ssd1306_draw_string)(ssd1306_t *dev, int x, int y, const char *str) {
     while (*str) {
         ssd1306_draw_char(dev, x, y, *str);
         x += 6;  // 5 pixels de largura + 1 pixel de espaço
@@ -0,0 +1,103 @@
+#include "tlog.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+#if TLOG_TEXT
+
+#define TLOG_FORMAT(name, nargs, fmt) fmt,
+const char *const tlog_formats[TLOG_MSG_COUNT] = {
+    TLOG_MESSAGES(TLOG_FORMAT)
+};
+
+void tlog_write(tlog_id_t id, uint32_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3) {
+    (void)id; (void)nargs; (void)a0; (void)a1; (void)a2; (void)a3;
+}
+
+uint32_t tlog_drain(uint32_t max_records) {
+    (void)max_records;
+    return 0;
+}
+
+#else
+
+typedef struct {
+    uint32_t timestamp_us;
+    uint8_t id;
+    uint8_t nargs;
+    volatile uint8_t ready; // Escrito por último pelo produtor
+    int32_t args[TLOG_MAX_ARGS];
+} tlog_record_t;
+
+static tlog_record_t tlog_ring[TLOG_RING_SIZE];
+static volatile uint32_t tlog_head = 0; // Próxima posição a reservar (produtores)
+static volatile uint32_t tlog_tail = 0; // Próxima posição a enviar (tlog_drain)
+static volatile uint32_t tlog_dropped = 0;
+
+void tlog_write(tlog_id_t id, uint32_t nargs, int32_t a0, int32_t a1, int32_t a2, int32_t a3) {
+    uint32_t timestamp = time_us_32();
+
+    // Reserva da posição: única seção com interrupções mascaradas
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t head = tlog_head;
+    if (head - tlog_tail >= TLOG_RING_SIZE) {
+        tlog_dropped++;
+        restore_interrupts(irq);
+        return;
+    }
+    tlog_head = head + 1;
+    restore_interrupts(irq);
+
+    tlog_record_t *r = &tlog_ring[head & (TLOG_RING_SIZE - 1)];
+    r->timestamp_us = timestamp;
+    r->id = (uint8_t)id;
+    r->nargs = (uint8_t)nargs;
+    r->args[0] = a0;
+    r->args[1] = a1;
+    r->args[2] = a2;
+    r->args[3] = a3;
+    __dmb();
+    r->ready = 1;
+}
+
+static void tlog_put_u32(uint32_t v) {
+    putchar_raw(v & 0xFF);
+    putchar_raw((v >> 8) & 0xFF);
+    putchar_raw((v >> 16) & 0xFF);
+    putchar_raw((v >> 24) & 0xFF);
+}
+
+static void tlog_send(uint8_t id, uint8_t nargs, uint32_t timestamp, const int32_t *args) {
+    putchar_raw(TLOG_SYNC0);
+    putchar_raw(TLOG_SYNC1);
+    putchar_raw(id);
+    putchar_raw(nargs);
+    tlog_put_u32(timestamp);
+    for (uint32_t i = 0; i < nargs; i++) tlog_put_u32((uint32_t)args[i]);
+}
+
+uint32_t tlog_drain(uint32_t max_records) {
+    uint32_t sent = 0;
+
+    if (tlog_dropped) {
+        uint32_t irq = save_and_disable_interrupts();
+        int32_t dropped = (int32_t)tlog_dropped;
+        tlog_dropped = 0;
+        restore_interrupts(irq);
+        tlog_send(TLOG_DROPPED, 1, time_us_32(), &dropped);
+    }
+
+    // Os registros saem em ordem de reserva; se um produtor interrompido ainda
+    // não terminou de preencher o próximo, para aqui e continua na próxima chamada.
+    while (tlog_tail != tlog_head && (max_records == 0 || sent < max_records)) {
+        tlog_record_t *r = &tlog_ring[tlog_tail & (TLOG_RING_SIZE - 1)];
+        if (!r->ready) break;
+        __dmb();
+        tlog_send(r->id, r->nargs, r->timestamp_us, r->args);
+        r->ready = 0;
+        tlog_tail = tlog_tail + 1;
+        sent++;
+    }
+    return sent;
+}
+
+#endif // TLOG_TEXT
@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Compara dois resultados JSON do bench (host/) e aponta regressões.
+
+uso: bench_compare.py base.json novo.json [--limite 10]
+
+Sai com código 1 se algum caso ficou mais lento que o limite (em %) ou se o
+tráfego de barramento/alocações por operação aumentou.
+"""
+import argparse
+import json
+import sys
+
+METRICAS_EXATAS = (
+    "i2c_bytes_per_op",
+    "i2c_transactions_per_op",
+    "uart_tx_bytes_per_op",
+    "allocs_per_op",
+)
+
+
+def carregar(caminho):
+    with open(caminho, encoding="utf-8") as f:
+        dados = json.load(f)
+    return dados, {r["name"]: r for r in dados["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("base")
+    parser.add_argument("novo")
+    parser.add_argument("--limite", type=float, default=10.0,
+                        help="piora máxima aceita em ns/op, em %% (padrão 10)")
+    args = parser.parse_args()
+
+    base_meta, base = carregar(args.base)
+    novo_meta, novo = carregar(args.novo)
+    print(f"{base_meta['suite']}: {base_meta['git_rev']} -> {novo_meta['git_rev']}")
+
+    regressoes = 0
+    for nome, r in novo.items():
+        b = base.get(nome)
+        if b is None:
+            print(f"  {nome:36s} (novo) {r['ns_per_op']:10.1f} ns/op")
+            continue
+        delta = (r["ns_per_op"] - b["ns_per_op"]) / b["ns_per_op"] * 100 if b["ns_per_op"] else 0.0
+        marca = ""
+        if delta > args.limite:
+            marca = "  <-- mais lento"
+            regressoes += 1
+        for m in METRICAS_EXATAS:
+            if r.get(m, 0) > b.get(m, 0) + 1e-9:
+                marca += f"  <-- {m} {b.get(m, 0):.1f} -> {r[m]:.1f}"
+                regressoes += 1
+        print(f"  {nome:36s} {b['ns_per_op']:10.1f} -> {r['ns_per_op']:10.1f} ns/op ({delta:+6.1f}%){marca}")
+
+    for nome in base.keys() - novo.keys():
+        print(f"  {nome:36s} (removido)")
+
+    return 1 if regressoes else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Gera a base de impressões digitais de RSSI (fingerprint_db.c) a partir de um JSON.
+
+uso:
+  gen_fingerprints.py fingerprints.json fingerprint_db.c
+  gen_fingerprints.py --sintetico 4096 --aps 32 --simbolo base_bench saida.c
+
+O JSON traz os beacons (BSSIDs) e os pontos de referência da pesquisa de
+campo, com o RSSI medido (dBm) de cada beacon ouvido. Uma lista de medidas
+é reduzida à média:
+  {
+    "aps": ["02:00:00:00:00:01", "02:00:00:00:00:02", "02:00:00:00:00:03"],
+    "pontos": [
+      {"x": 512, "y": 512, "rssi": {"02:00:00:00:00:01": -48, "02:00:00:00:00:02": [-71, -69]}}
+    ]
+  }
+
+Os valores são quantizados para int8 em [-100, -20] dBm (beacons não
+ouvidos ficam em -100) e os pontos são agrupados pelo beacon mais forte,
+que é o índice grosso usado pelo firmware.
+"""
+import argparse
+import json
+import math
+import random
+import sys
+
+MAX_APS = 64            # FP_MAX_APS
+RSSI_FLOOR = -100       # FP_RSSI_FLOOR
+RSSI_CEIL = -20         # FP_RSSI_CEIL
+INT16 = (-32768, 32767)
+
+
+def bssid_bytes(texto):
+    partes = texto.split(":")
+    if len(partes) != 6:
+        sys.exit(f"BSSID inválido: {texto}")
+    return bytes(int(p, 16) for p in partes)
+
+
+def quantizar(v):
+    if isinstance(v, list):
+        v = sum(v) / len(v)
+    return max(RSSI_FLOOR, min(RSSI_CEIL, int(round(v))))
+
+
+def validar(cfg):
+    aps = cfg["aps"]
+    if not 1 <= len(aps) <= MAX_APS:
+        sys.exit(f"a base deve ter de 1 a {MAX_APS} beacons")
+    if len(set(aps)) != len(aps):
+        sys.exit("beacons repetidos")
+    if not 1 <= len(cfg["pontos"]) <= 65535:
+        sys.exit("a base deve ter de 1 a 65535 pontos")
+    conhecidos = set(aps)
+    for i, p in enumerate(cfg["pontos"]):
+        if not (INT16[0] <= p["x"] <= INT16[1] and INT16[0] <= p["y"] <= INT16[1]):
+            sys.exit(f"ponto {i}: posição fora de int16")
+        for b in p["rssi"]:
+            if b not in conhecidos:
+                sys.exit(f"ponto {i}: beacon {b} não está em 'aps'")
+
+
+def gerar_c(cfg, origem, simbolo):
+    aps = sorted(cfg["aps"], key=bssid_bytes)
+    pontos = []
+    for p in cfg["pontos"]:
+        linha = [quantizar(p["rssi"][b]) if b in p["rssi"] else RSSI_FLOOR for b in aps]
+        grupo = max(range(len(aps)), key=lambda a: linha[a])
+        pontos.append((grupo, p["x"], p["y"], linha))
+    pontos.sort(key=lambda p: p[0])  # Estável: mantém a ordem da pesquisa dentro do grupo
+
+    inicio = [0] * (len(aps) + 1)
+    for g, _, _, _ in pontos:
+        inicio[g + 1] += 1
+    for g in range(len(aps)):
+        inicio[g + 1] += inicio[g]
+
+    linhas = [
+        f"// Gerado por tools/gen_fingerprints.py a partir de {origem}. Não editar à mão.",
+        '#include "fingerprint.h"',
+        "",
+        "static const fp_ap_id_t aps[] = {",
+    ]
+    for b in aps:
+        linhas.append("    {{" + ", ".join(f"0x{v:02x}" for v in bssid_bytes(b)) + f"}}}}, // {b}")
+    linhas += ["};", "", "static const int8_t rssi[] = {"]
+    for _, _, _, linha in pontos:
+        linhas.append("    " + ", ".join(str(v) for v in linha) + ",")
+    linhas += ["};", "", "static const int16_t pos[] = {"]
+    for k in range(0, len(pontos), 8):
+        linhas.append("    " + " ".join(f"{x}, {y}," for _, x, y, _ in pontos[k:k + 8]))
+    linhas += ["};", "", "static const uint16_t group_start[] = {"]
+    for k in range(0, len(inicio), 16):
+        linhas.append("    " + ", ".join(str(v) for v in inicio[k:k + 16]) + ",")
+    linhas += [
+        "};",
+        "",
+        f"const fp_db_t {simbolo} = {{",
+        "    .aps = aps,",
+        "    .rssi = rssi,",
+        "    .pos = pos,",
+        "    .group_start = group_start,",
+        f"    .ap_count = {len(aps)},",
+        f"    .point_count = {len(pontos)},",
+        "};",
+        "",
+    ]
+    return "\n".join(linhas)
+
+
+def modelo_rssi(ap, x, y, rnd):
+    """Perda log-distância (expoente 2,7; 4096 unidades = 80 m) com sombreamento de 4 dB."""
+    metros = max(1.0, math.hypot(ap[0] - x, ap[1] - y) * 80 / 4096)
+    return -40 - 27 * math.log10(metros) + rnd.gauss(0, 4)
+
+
+def base_sintetica(n, n_aps, semente):
+    """Local sintético de 4096 x 4096 com n_aps beacons e n pontos numa grade regular."""
+    rnd = random.Random(semente)
+    aps = [(rnd.randrange(0, 4096), rnd.randrange(0, 4096)) for _ in range(n_aps)]
+    nomes = [f"02:00:00:00:{i >> 8:02x}:{i & 0xFF:02x}" for i in range(n_aps)]
+    lado = max(1, int(math.ceil(math.sqrt(n))))
+    passo = 4096 / lado
+    pontos = []
+    for k in range(n):
+        x = int((k % lado + 0.5) * passo)
+        y = int((k // lado + 0.5) * passo)
+        rssi = {}
+        for nome, ap in zip(nomes, aps):
+            v = modelo_rssi(ap, x, y, rnd)
+            if v > -95:
+                rssi[nome] = round(v)
+        pontos.append({"x": x, "y": y, "rssi": rssi})
+    return {"aps": nomes, "pontos": pontos}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("entrada", nargs="?", help="fingerprints.json")
+    parser.add_argument("saida", help="arquivo .c gerado")
+    parser.add_argument("--sintetico", type=int, metavar="N", help="gera N pontos sintéticos")
+    parser.add_argument("--aps", type=int, default=32, help="beacons da base sintética")
+    parser.add_argument("--semente", type=int, default=1)
+    parser.add_argument("--simbolo", default="fingerprint_db", help="nome da base gerada")
+    args = parser.parse_args()
+
+    if args.sintetico:
+        cfg = base_sintetica(args.sintetico, args.aps, args.semente)
+        origem = f"--sintetico {args.sintetico} --aps {args.aps} --semente {args.semente}"
+    else:
+        if not args.entrada:
+            parser.error("informe fingerprints.json ou --sintetico N")
+        with open(args.entrada, encoding="utf-8") as f:
+            cfg = json.load(f)
+        origem = args.entrada
+    validar(cfg)
+    with open(args.saida, "w", encoding="utf-8") as f:
+        f.write(gerar_c(cfg, origem, args.simbolo))
+
+
+if __name__ == "__main__":
+    main()
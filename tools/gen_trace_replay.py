@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Converte uma gravação de entradas (inc/trace.h) em trace_replay_data.c.
+
+uso:
+  tlog_decode.py /dev/ttyACM0 --trace captura.trc
+  gen_trace_replay.py captura.trc trace_replay_data.c
+
+O arquivo gerado é compilado nos builds com TRACE_REPLAY = 1
+(-DBADGE_TRACE_REPLAY=captura.trc no CMake), que alimentam o firmware com as
+entradas gravadas em vez dos sensores.
+
+Antes de gerar, o CRC de cada bloco (uma chave e os registros até a próxima,
+fechado pelo CRC-16/CCITT na chave seguinte) é conferido como em trace_next.
+Uma gravação com blocos que não conferem é recusada, a menos que
+--aceitar-corrompida seja usado (o firmware descarta esses blocos).
+"""
+import argparse
+import sys
+
+TAG_KEY = b"\xf0TRC"
+MAX_BYTES = 512 * 1024  # Cabe com folga na flash junto com o programa
+TAM_CHAVE_MIN = 4 + 4 + 2 + 1  # Marca, instante, CRC do bloco anterior, perdidos
+BYTES_MAX = 128  # TRACE_BYTES_MAX
+VALORES = [2, 3, 3, 0]  # Valores por amostra de cada canal (TRACE_CHANNELS; 0 = bytes)
+
+
+def _tabela_crc16():
+    tabela = []
+    for b in range(256):
+        crc = b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+        tabela.append(crc)
+    return tabela
+
+
+TABELA_CRC16 = _tabela_crc16()
+
+
+def crc16_ccitt(dados, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, o mesmo de crc.h."""
+    for b in dados:
+        crc = ((crc << 8) & 0xFFFF) ^ TABELA_CRC16[(crc >> 8) ^ b]
+    return crc
+
+
+def varint(dados, i):
+    """(valor, próxima posição) ou None se cortado."""
+    v = 0
+    for desloc in range(0, 35, 7):
+        if i >= len(dados):
+            return None
+        b = dados[i]
+        i += 1
+        v |= (b & 0x7F) << desloc
+        if not b & 0x80:
+            return v, i
+    return None
+
+
+def eh_chave(dados, i):
+    return len(dados) - i >= TAM_CHAVE_MIN and dados[i:i + 4] == TAG_KEY
+
+
+def pular_registro(dados, i):
+    """Posição do registro seguinte, ou None se inválido ou cortado."""
+    canal = dados[i]
+    if canal >= len(VALORES):
+        return None
+    r = varint(dados, i + 1)
+    if r is None:
+        return None
+    i = r[1]
+    if VALORES[canal] == 0:
+        r = varint(dados, i)
+        if r is None or r[0] > BYTES_MAX or r[0] > len(dados) - r[1]:
+            return None
+        return r[1] + r[0]
+    for _ in range(VALORES[canal]):
+        r = varint(dados, i)
+        if r is None:
+            return None
+        i = r[1]
+    return i
+
+
+def conferir_blocos(dados):
+    """Confere os blocos como trace_next. Retorna (conferidos, ruins,
+    último bloco sem a chave seguinte)."""
+    conferidos = ruins = 0
+    aberto = False
+    i = dados.find(TAG_KEY)
+    while 0 <= i < len(dados):
+        if not eh_chave(dados, i):
+            i = dados.find(TAG_KEY, i + 1)
+            continue
+        r = varint(dados, i + 10)
+        if r is None:
+            break
+        p = r[1]
+        while p is not None and p < len(dados) and dados[p] != 0xFF and not eh_chave(dados, p):
+            p = pular_registro(dados, p)
+        if p is None:
+            # Registro inválido: corrupção se houver chave mais à frente
+            if dados.find(TAG_KEY, r[1]) < 0:
+                aberto = True
+                break
+            ruins += 1
+            i = dados.find(TAG_KEY, i + 1)
+            continue
+        fim = p
+        while p < len(dados) and dados[p] == 0xFF:
+            p += 1
+        if p == len(dados):
+            aberto = fim > r[1]  # Só conta se o último bloco tem registros
+            break
+        if eh_chave(dados, p) and crc16_ccitt(dados[i:fim]) == dados[p + 8] | dados[p + 9] << 8:
+            conferidos += 1
+            i = p
+        else:
+            # Como em trace_next: recomeça logo depois da marca do bloco ruim
+            ruins += 1
+            i = dados.find(TAG_KEY, i + 1)
+    return conferidos, ruins, aberto
+
+
+def validar(dados):
+    if not dados:
+        sys.exit("gravação vazia")
+    if len(dados) > MAX_BYTES:
+        sys.exit(f"gravação maior que {MAX_BYTES} bytes")
+    if TAG_KEY not in dados:
+        sys.exit("nenhum registro-chave: não é uma gravação de trace.h")
+
+
+def gerar_c(dados, origem, simbolo):
+    linhas = [
+        f"// Gerado por tools/gen_trace_replay.py a partir de {origem}. Não editar à mão.",
+        '#include "trace.h"',
+        "",
+        f"const uint8_t {simbolo}_data[] = {{",
+    ]
+    for k in range(0, len(dados), 16):
+        linhas.append("    " + ", ".join(f"0x{b:02x}" for b in dados[k:k + 16]) + ",")
+    linhas += [
+        "};",
+        "",
+        f"const uint32_t {simbolo}_size = sizeof({simbolo}_data);",
+        "",
+    ]
+    return "\n".join(linhas)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("entrada", help="gravação (.trc)")
+    parser.add_argument("saida", help="arquivo .c gerado")
+    parser.add_argument("--simbolo", default="trace_replay", help="prefixo dos símbolos gerados")
+    parser.add_argument("--aceitar-corrompida", action="store_true",
+                        help="gera mesmo com blocos cujo CRC não confere")
+    args = parser.parse_args()
+
+    with open(args.entrada, "rb") as f:
+        dados = f.read()
+    validar(dados)
+    conferidos, ruins, aberto = conferir_blocos(dados)
+    print(f"{conferidos} blocos conferidos, {ruins} com CRC errado"
+          f"{', último bloco sem conferência' if aberto else ''}", file=sys.stderr)
+    if ruins and not args.aceitar_corrompida:
+        sys.exit("gravação corrompida (use --aceitar-corrompida para gerar assim mesmo)")
+    with open(args.saida, "w", encoding="utf-8") as f:
+        f.write(gerar_c(dados, args.entrada, args.simbolo))
+
+
+if __name__ == "__main__":
+    main()
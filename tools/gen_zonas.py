@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Gera a tabela de zonas do geofence (geofence_zonas.c) a partir de um JSON.
+
+uso:
+  gen_zonas.py zonas.json geofence_zonas.c
+  gen_zonas.py --aleatorio 300 --simbolo mapa_bench saida.c   # mapa sintético
+
+O JSON define a grade e as zonas:
+  {
+    "grade": {"x0": 0, "y0": 0, "celula_bits": 8, "largura": 16, "altura": 16},
+    "histerese": 50,
+    "zonas": [
+      {"nome": "deposito", "prioridade": 2, "acao": "alert",
+       "poligono": [[100, 100], [400, 100], [400, 300]]}
+    ]
+  }
+
+Cada célula da grade recebe a lista das zonas que a tocam (ordenadas por
+prioridade), de modo que o firmware só testa essas zonas por amostra.
+"""
+import argparse
+import json
+import random
+import sys
+
+MAX_VERTICES = 32            # GEOFENCE_MAX_VERTICES
+MAX_ZONES_PER_CELL = 16      # GEOFENCE_MAX_ZONES_PER_CELL
+ACOES = {"log": "GEOFENCE_ACTION_LOG", "warn": "GEOFENCE_ACTION_WARN", "alert": "GEOFENCE_ACTION_ALERT"}
+INT16 = (-32768, 32767)
+
+
+def ponto_no_poligono(x, y, poli):
+    dentro = False
+    j = len(poli) - 1
+    for i in range(len(poli)):
+        xi, yi = poli[i]
+        xj, yj = poli[j]
+        if (yi > y) != (yj > y) and x < xi + (y - yi) * (xj - xi) / (yj - yi):
+            dentro = not dentro
+        j = i
+    return dentro
+
+
+def segmentos_cruzam(a, b, c, d):
+    def orient(p, q, r):
+        v = (q[0] - p[0]) * (r[1] - p[1]) - (q[1] - p[1]) * (r[0] - p[0])
+        return (v > 0) - (v < 0)
+
+    def no_segmento(p, q, r):
+        return min(p[0], q[0]) <= r[0] <= max(p[0], q[0]) and min(p[1], q[1]) <= r[1] <= max(p[1], q[1])
+
+    o1, o2, o3, o4 = orient(a, b, c), orient(a, b, d), orient(c, d, a), orient(c, d, b)
+    if o1 != o2 and o3 != o4:
+        return True
+    return ((o1 == 0 and no_segmento(a, b, c)) or (o2 == 0 and no_segmento(a, b, d)) or
+            (o3 == 0 and no_segmento(c, d, a)) or (o4 == 0 and no_segmento(c, d, b)))
+
+
+def poligono_toca_retangulo(poli, x0, y0, x1, y1):
+    """Interseção entre o polígono e o retângulo [x0, x1] x [y0, y1]."""
+    if any(x0 <= x <= x1 and y0 <= y <= y1 for x, y in poli):
+        return True
+    cantos = [(x0, y0), (x1, y0), (x1, y1), (x0, y1)]
+    if any(ponto_no_poligono(x, y, poli) for x, y in cantos):
+        return True
+    for i in range(len(poli)):
+        a, b = poli[i], poli[(i + 1) % len(poli)]
+        for k in range(4):
+            if segmentos_cruzam(a, b, cantos[k], cantos[(k + 1) % 4]):
+                return True
+    return False
+
+
+def validar(cfg):
+    for z in cfg["zonas"]:
+        nome = z.get("nome", "?")
+        poli = z["poligono"]
+        if not 3 <= len(poli) <= MAX_VERTICES:
+            sys.exit(f"zona {nome}: o polígono deve ter de 3 a {MAX_VERTICES} vértices")
+        for x, y in poli:
+            if not (INT16[0] <= x <= INT16[1] and INT16[0] <= y <= INT16[1]):
+                sys.exit(f"zona {nome}: vértice ({x}, {y}) fora de int16")
+        if z["acao"] not in ACOES:
+            sys.exit(f"zona {nome}: ação '{z['acao']}' inválida ({', '.join(ACOES)})")
+        if not 0 <= z["prioridade"] <= 255:
+            sys.exit(f"zona {nome}: prioridade deve estar entre 0 e 255")
+
+
+def montar_grade(cfg):
+    g = cfg["grade"]
+    passo = 1 << g["celula_bits"]
+    celulas = []
+    for cy in range(g["altura"]):
+        for cx in range(g["largura"]):
+            x0 = g["x0"] + cx * passo
+            y0 = g["y0"] + cy * passo
+            # Célula semiaberta [x0, x0 + passo): o retângulo fechado vai até passo - 1
+            tocam = [i for i, z in enumerate(cfg["zonas"])
+                     if poligono_toca_retangulo(z["poligono"], x0, y0, x0 + passo - 1, y0 + passo - 1)]
+            tocam.sort(key=lambda i: -cfg["zonas"][i]["prioridade"])
+            if len(tocam) > MAX_ZONES_PER_CELL:
+                sys.exit(f"célula ({cx}, {cy}) com {len(tocam)} zonas; máximo {MAX_ZONES_PER_CELL}. "
+                         "Reduza celula_bits ou as sobreposições.")
+            celulas.append(tocam)
+    return celulas
+
+
+def gerar_c(cfg, origem, simbolo):
+    g = cfg["grade"]
+    celulas = montar_grade(cfg)
+    linhas = [
+        f"// Gerado por tools/gen_zonas.py a partir de {origem}. Não editar à mão.",
+        '#include "geofence.h"',
+        "",
+    ]
+
+    linhas.append("static const geofence_point_t vertices[] = {")
+    primeiro = []
+    total = 0
+    for z in cfg["zonas"]:
+        primeiro.append(total)
+        pts = ", ".join(f"{{{x}, {y}}}" for x, y in z["poligono"])
+        linhas.append(f"    {pts}, // {z.get('nome', '')}")
+        total += len(z["poligono"])
+    linhas.append("};")
+    linhas.append("")
+
+    linhas.append("static const geofence_zone_t zones[] = {")
+    for i, z in enumerate(cfg["zonas"]):
+        xs = [p[0] for p in z["poligono"]]
+        ys = [p[1] for p in z["poligono"]]
+        linhas.append(f"    {{{primeiro[i]}, {len(z['poligono'])}, {z['prioridade']}, {ACOES[z['acao']]}, "
+                      f"{min(xs)}, {min(ys)}, {max(xs)}, {max(ys)}}}, // {i}: {z.get('nome', '')}")
+    linhas.append("};")
+    linhas.append("")
+
+    inicio = [0]
+    for c in celulas:
+        inicio.append(inicio[-1] + len(c))
+    linhas.append("static const uint16_t cell_start[] = {")
+    for k in range(0, len(inicio), 16):
+        linhas.append("    " + ", ".join(str(v) for v in inicio[k:k + 16]) + ",")
+    linhas.append("};")
+    linhas.append("")
+
+    todas = [i for c in celulas for i in c] or [0]
+    linhas.append("static const uint16_t cell_zones[] = {")
+    for k in range(0, len(todas), 16):
+        linhas.append("    " + ", ".join(str(v) for v in todas[k:k + 16]) + ",")
+    linhas.append("};")
+    linhas.append("")
+
+    linhas += [
+        f"const geofence_map_t {simbolo} = {{",
+        "    .vertices = vertices,",
+        "    .zones = zones,",
+        f"    .zone_count = {len(cfg['zonas'])},",
+        "    .cell_start = cell_start,",
+        "    .cell_zones = cell_zones,",
+        f"    .x0 = {g['x0']},",
+        f"    .y0 = {g['y0']},",
+        f"    .cell_shift = {g['celula_bits']},",
+        f"    .grid_w = {g['largura']},",
+        f"    .grid_h = {g['altura']},",
+        f"    .hysteresis = {cfg.get('histerese', 0)},",
+        "};",
+        "",
+    ]
+    return "\n".join(linhas)
+
+
+def mapa_aleatorio(n, semente):
+    """Mapa sintético de n zonas (polígonos de 4 a 8 vértices) numa área de 4096 x 4096."""
+    rnd = random.Random(semente)
+    import math
+    zonas = []
+    for i in range(n):
+        cx, cy = rnd.randrange(100, 3996), rnd.randrange(100, 3996)
+        raio = rnd.randrange(30, 90)
+        lados = rnd.randrange(4, 9)
+        poli = []
+        for k in range(lados):
+            ang = 2 * math.pi * k / lados
+            r = raio * rnd.uniform(0.6, 1.0)
+            poli.append([int(cx + r * math.cos(ang)), int(cy + r * math.sin(ang))])
+        zonas.append({"nome": f"z{i}", "prioridade": rnd.randrange(0, 4),
+                      "acao": rnd.choice(list(ACOES)), "poligono": poli})
+    return {"grade": {"x0": 0, "y0": 0, "celula_bits": 7, "largura": 32, "altura": 32},
+            "histerese": 20, "zonas": zonas}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("entrada", nargs="?", help="zonas.json")
+    parser.add_argument("saida", help="arquivo .c gerado")
+    parser.add_argument("--aleatorio", type=int, metavar="N", help="gera N zonas sintéticas")
+    parser.add_argument("--semente", type=int, default=1)
+    parser.add_argument("--simbolo", default="geofence_map", help="nome do mapa gerado")
+    args = parser.parse_args()
+
+    if args.aleatorio:
+        cfg = mapa_aleatorio(args.aleatorio, args.semente)
+        origem = f"--aleatorio {args.aleatorio} --semente {args.semente}"
+    else:
+        if not args.entrada:
+            parser.error("informe zonas.json ou --aleatorio N")
+        with open(args.entrada, encoding="utf-8") as f:
+            cfg = json.load(f)
+        origem = args.entrada
+    validar(cfg)
+    with open(args.saida, "w", encoding="utf-8") as f:
+        f.write(gerar_c(cfg, origem, args.simbolo))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Mostra no terminal o espelho do display enviado pela USB (inc/mirror.h).
+
+uso:
+  mirror_view.py /dev/ttyACM0                 # porta serial (requer pyserial)
+  mirror_view.py captura.bin                  # arquivo gravado da USB
+  mirror_view.py /dev/ttyACM0 --log quadros.csv --sem-tela
+
+A cada quadro completo a tela é redesenhada (dois pixels por caractere) e o
+instante do quadro no crachá, o intervalo para o anterior e os bytes gastos
+vão para --log (CSV). Os quadros do log tokenizado, da gravação de entradas
+e o texto comum no mesmo fluxo são ignorados.
+"""
+import argparse
+import sys
+import time
+
+SYNC0 = 0xFE
+TLOG_SYNC1 = 0xED
+TRACE_SYNC1 = 0xEE
+MIRROR_SYNC1 = 0xEF
+
+OP_XOR = 0x80
+OP_RUN = 0xC0
+OP_END = 0xF0
+OP_KEY = 0xF1
+RUN_MIN = 3
+
+BLOCOS = {(0, 0): " ", (1, 0): "▀", (0, 1): "▄", (1, 1): "█"}
+
+
+class Espelho:
+    def __init__(self):
+        self.largura, self.altura = 128, 64
+        self.tela = bytearray(self.largura * self.altura // 8)
+        self.cursor = 0
+        self.sincronizado = False  # Só depois do primeiro quadro-chave
+        self.chave = False         # O quadro em andamento começou com um quadro-chave
+
+    def aplicar(self, ops):
+        """Aplica as operações de um pacote. Retorna os quadros completados
+        como (número, instante us, quadro-chave)."""
+        quadros = []
+        i = 0
+        while i < len(ops):
+            op = ops[i]
+            i += 1
+            if op == OP_KEY:
+                self.largura, self.altura = ops[i], ops[i + 1]
+                self.tela = bytearray(self.largura * self.altura // 8)
+                self.cursor = 0
+                self.sincronizado = True
+                self.chave = True
+                i += 2
+            elif op == OP_END:
+                numero = ops[i] | ops[i + 1] << 8
+                instante = int.from_bytes(ops[i + 2:i + 6], "little")
+                i += 6
+                self.cursor = 0
+                if self.sincronizado:
+                    quadros.append((numero, instante, self.chave))
+                self.chave = False
+            elif op >= OP_RUN:
+                n = op - OP_RUN + RUN_MIN
+                self._xor(bytes([ops[i]]) * n)
+                i += 1
+            elif op >= OP_XOR:
+                n = op - OP_XOR + 1
+                self._xor(ops[i:i + n])
+                i += n
+            else:
+                self.cursor += op + 1
+        return quadros
+
+    def _xor(self, dados):
+        for b in dados:
+            if self.cursor < len(self.tela):
+                self.tela[self.cursor] ^= b
+            self.cursor += 1
+
+    def pixel(self, x, y):
+        return (self.tela[(y // 8) * self.largura + x] >> (y % 8)) & 1
+
+    def desenhar(self):
+        linhas = []
+        for y in range(0, self.altura, 2):
+            linhas.append("".join(BLOCOS[(self.pixel(x, y), self.pixel(x, y + 1))]
+                                  for x in range(self.largura)))
+        borda = "+" + "-" * self.largura + "+"
+        return "\n".join([borda] + ["|" + l + "|" for l in linhas] + [borda])
+
+
+def abrir_entrada(origem):
+    if origem == "-":
+        return sys.stdin.buffer
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(origem, 115200, timeout=0.1)
+    return open(origem, "rb")
+
+
+def pacotes(entrada):
+    """Gera o conteúdo dos pacotes do espelho, pulando o resto do fluxo."""
+    buf = bytearray()
+    while True:
+        bloco = entrada.read(256)
+        if not bloco:
+            if hasattr(entrada, "in_waiting"):  # serial: timeout sem dados
+                continue
+            return
+        buf += bloco
+        while buf:
+            if buf[0] != SYNC0:
+                del buf[0]
+                continue
+            if len(buf) < 3:
+                break
+            if buf[1] in (MIRROR_SYNC1, TRACE_SYNC1):
+                tamanho = 3 + buf[2]
+                if len(buf) < tamanho:
+                    break
+                if buf[1] == MIRROR_SYNC1:
+                    yield bytes(buf[3:tamanho])
+                del buf[:tamanho]
+            elif buf[1] == TLOG_SYNC1:
+                if len(buf) < 4:
+                    break
+                tamanho = 8 + 4 * min(buf[3], 4)
+                if len(buf) < tamanho:
+                    break
+                del buf[:tamanho]
+            else:
+                del buf[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("origem", help="porta serial, arquivo ou '-'")
+    parser.add_argument("--log", metavar="ARQUIVO", help="instantes e tamanhos dos quadros (CSV)")
+    parser.add_argument("--sem-tela", action="store_true", help="não redesenha a tela")
+    args = parser.parse_args()
+
+    espelho = Espelho()
+    log = open(args.log, "w") if args.log else None
+    if log:
+        log.write("quadro,instante_us,intervalo_ms,bytes,chave,chegada_s\n")
+    anterior = None
+    bytes_quadro = 0
+    total_quadros = total_bytes = 0
+    inicio = time.monotonic()
+    try:
+        for ops in pacotes(abrir_entrada(args.origem)):
+            bytes_quadro += 3 + len(ops)
+            for numero, instante, chave in espelho.aplicar(ops):
+                intervalo = (instante - anterior) % (1 << 32) / 1000 if anterior is not None else 0.0
+                anterior = instante
+                total_quadros += 1
+                total_bytes += bytes_quadro
+                if log:
+                    log.write(f"{numero},{instante},{intervalo:.3f},{bytes_quadro},{int(chave)},"
+                              f"{time.monotonic() - inicio:.3f}\n")
+                    log.flush()
+                if not args.sem_tela:
+                    sys.stdout.write("\x1b[H\x1b[J" + espelho.desenhar() + "\n")
+                    sys.stdout.write(f"quadro {numero}  t={instante / 1000:.1f} ms  "
+                                     f"intervalo={intervalo:.1f} ms  {bytes_quadro} B{'  (chave)' if chave else ''}\n")
+                    sys.stdout.flush()
+                bytes_quadro = 0
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if log:
+            log.close()
+    if total_quadros:
+        print(f"{total_quadros} quadros, {total_bytes / total_quadros:.1f} bytes/quadro", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
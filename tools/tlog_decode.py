@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Decodifica o log tokenizado do firmware (inc/tlog.h).
+
+uso:
+  tlog_decode.py /dev/ttyACM0          # porta serial (requer pyserial)
+  tlog_decode.py captura.bin           # arquivo gravado da USB
+  cat /dev/ttyACM0 | tlog_decode.py -  # entrada padrão
+  tlog_decode.py /dev/ttyACM0 --trace captura.trc  # salva as entradas gravadas (inc/trace.h)
+
+A tabela de mensagens é lida de inc/tlog_msgs.h (ou --msgs). Bytes fora de
+quadros tlog (printf comuns, relatório do prof.h) são repassados como texto.
+Os quadros da gravação de entradas (0xFE 0xEE) nunca viram texto; com
+--trace o conteúdo deles é salvo em arquivo para host/trace_replay. Os do
+espelho do display (0xFE 0xEF, inc/mirror.h) são pulados: ver
+tools/mirror_view.py.
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = b"\xfe\xed"
+TRACE_SYNC = b"\xfe\xee"
+MIRROR_SYNC = b"\xfe\xef"
+MAX_ARGS = 4
+PADRAO_MSG = re.compile(r'X\(\s*(\w+)\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+
+
+def carregar_tabela(caminho):
+    with open(caminho, encoding="utf-8") as f:
+        texto = f.read()
+    tabela = []
+    for nome, nargs, fmt in PADRAO_MSG.findall(texto):
+        fmt = bytes(fmt, "utf-8").decode("unicode_escape")
+        tabela.append((nome, int(nargs), fmt))
+    if not tabela:
+        sys.exit(f"nenhuma mensagem encontrada em {caminho}")
+    return tabela
+
+
+def abrir_entrada(origem):
+    if origem == "-":
+        return sys.stdin.buffer
+    if origem.startswith("/dev/") or origem.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(origem, 115200, timeout=0.1)
+    return open(origem, "rb")
+
+
+def decodificar(entrada, tabela, saida, trace=None):
+    buf = bytearray()
+    texto = bytearray()
+
+    def despeja_texto():
+        if texto:
+            saida.write(texto.decode("utf-8", errors="replace"))
+            texto.clear()
+
+    while True:
+        bloco = entrada.read(256)
+        if not bloco:
+            if hasattr(entrada, "in_waiting"):  # serial: timeout sem dados
+                despeja_texto()
+                saida.flush()
+                continue
+            break
+        buf += bloco
+        while buf:
+            if buf[0] != SYNC[0]:
+                texto.append(buf.pop(0))
+                if texto.endswith(b"\n"):
+                    despeja_texto()
+                continue
+            if len(buf) >= 3 and buf[1] in (TRACE_SYNC[1], MIRROR_SYNC[1]):
+                tamanho = 3 + buf[2]
+                if len(buf) < tamanho:
+                    break
+                if trace and buf[1] == TRACE_SYNC[1]:
+                    trace.write(buf[3:tamanho])
+                del buf[:tamanho]
+                continue
+            if len(buf) < 8:
+                break
+            if buf[1] != SYNC[1] or buf[2] >= len(tabela) or buf[3] > MAX_ARGS:
+                texto.append(buf.pop(0))
+                continue
+            msg_id, nargs = buf[2], buf[3]
+            tamanho = 8 + 4 * nargs
+            if len(buf) < tamanho:
+                break
+            instante, = struct.unpack_from("<I", buf, 4)
+            args = struct.unpack_from(f"<{nargs}i", buf, 8)
+            del buf[:tamanho]
+            despeja_texto()
+            nome, esperado, fmt = tabela[msg_id]
+            try:
+                linha = fmt % args[:esperado]
+            except (TypeError, ValueError):
+                linha = f"{nome} {args}"
+            saida.write(f"[{instante / 1000:10.3f} ms] {linha}\n")
+        saida.flush()
+    despeja_texto()
+
+
+def main():
+    raiz = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("origem", help="porta serial, arquivo ou '-'")
+    parser.add_argument("--msgs", default=os.path.join(raiz, "inc", "tlog_msgs.h"),
+                        help="tabela de mensagens (padrão: inc/tlog_msgs.h)")
+    parser.add_argument("--trace", metavar="ARQUIVO", help="salva a gravação de entradas (trace.h)")
+    args = parser.parse_args()
+    tabela = carregar_tabela(args.msgs)
+    trace = open(args.trace, "wb") if args.trace else None
+    try:
+        decodificar(abrir_entrada(args.origem), tabela, sys.stdout, trace)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if trace:
+            trace.close()
+
+
+if __name__ == "__main__":
+    main()
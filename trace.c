@@ -0,0 +1,379 @@
+#include "trace.h"
+#include "crc.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "ram_hot.h"
+#include <string.h>
+
+#define TRACE_ENUM_NVALUES(name, nvalues) nvalues,
+static const uint8_t trace_nvalues[TRACE_CH_COUNT] = {
+    TRACE_CHANNELS(TRACE_ENUM_NVALUES)
+};
+
+static const uint8_t trace_key_magic[4] = {TRACE_TAG_KEY, 'T', 'R', 'C'};
+
+// Maior registro: bloco de bytes com tag, dt e tamanho (ou uma chave seguida
+// de uma amostra)
+#define TRACE_RECORD_MAX (1 + 5 + 5 + TRACE_BYTES_MAX)
+#define TRACE_KEY_MIN (4 + 4 + 2 + 1)
+#define TRACE_KEY_MAX (4 + 4 + 2 + 5)
+
+static uint8_t trace_ring[TRACE_RING_SIZE];
+static volatile uint32_t trace_head = 0; // Próximo byte a gravar
+static volatile uint32_t trace_tail = 0; // Próximo byte a enviar (trace_drain)
+
+// Estado do codificador (protegido pela máscara de interrupções)
+static bool trace_need_key = true;
+static uint32_t trace_last_t;
+static uint32_t trace_key_t;
+static int32_t trace_prev[TRACE_CH_COUNT][TRACE_MAX_VALUES];
+static uint32_t trace_dropped_since_key;
+static uint16_t trace_block_crc = CRC16_CCITT_INIT; // Bytes desde a última chave, inclusive ela
+static trace_stats_t trace_stats;
+
+static uint32_t RAM_HOT_FUNC(trace_put_varint)(uint8_t *p, uint32_t v) {
+    uint32_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline uint32_t trace_zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t trace_unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static uint32_t RAM_HOT_FUNC(trace_encode_key)(uint8_t *p, uint32_t t) {
+    uint32_t n = 0;
+    memcpy(p, trace_key_magic, sizeof(trace_key_magic));
+    n += sizeof(trace_key_magic);
+    p[n++] = (uint8_t)t;
+    p[n++] = (uint8_t)(t >> 8);
+    p[n++] = (uint8_t)(t >> 16);
+    p[n++] = (uint8_t)(t >> 24);
+    p[n++] = (uint8_t)trace_block_crc; // Fecha o bloco anterior
+    p[n++] = (uint8_t)(trace_block_crc >> 8);
+    n += trace_put_varint(&p[n], trace_dropped_since_key);
+    return n;
+}
+
+// Copia 'len' bytes para o anel; o chamador já verificou o espaço.
+static void RAM_HOT_FUNC(trace_ring_put)(const uint8_t *src, uint32_t len) {
+    uint32_t head = trace_head;
+    uint32_t pos = head & (TRACE_RING_SIZE - 1);
+    uint32_t first = TRACE_RING_SIZE - pos;
+    if (first > len) first = len;
+    memcpy(&trace_ring[pos], src, first);
+    memcpy(trace_ring, src + first, len - first);
+    trace_head = head + len;
+}
+
+// Grava o registro (já codificado contra os preditores) precedido de uma
+// chave quando necessário. Chamada com as interrupções mascaradas.
+static void RAM_HOT_FUNC(trace_commit)(const uint8_t *rec, uint32_t len, uint32_t t) {
+    uint8_t key[TRACE_KEY_MAX];
+    uint32_t key_len = 0;
+    if (trace_need_key) key_len = trace_encode_key(key, t);
+
+    uint32_t space = TRACE_RING_SIZE - (trace_head - trace_tail);
+    if (key_len + len > space) {
+        trace_dropped_since_key++;
+        trace_stats.dropped++;
+        trace_need_key = true;
+        return;
+    }
+    if (key_len) {
+        trace_ring_put(key, key_len);
+        trace_need_key = false;
+        trace_dropped_since_key = 0;
+        trace_key_t = t;
+        trace_block_crc = crc16_ccitt_update(CRC16_CCITT_INIT, key, key_len);
+        trace_stats.records++;
+    }
+    trace_ring_put(rec, len);
+    trace_block_crc = crc16_ccitt_update(trace_block_crc, rec, len);
+    trace_last_t = t;
+    trace_stats.records++;
+    trace_stats.bytes += key_len + len;
+}
+
+// Prepara o estado para um novo registro no instante 't'. Se uma chave vai
+// ser emitida, os preditores partem de zero e o dt do registro é 0.
+static uint32_t RAM_HOT_FUNC(trace_begin)(uint32_t t) {
+    if (!trace_need_key && t - trace_key_t >= TRACE_KEY_INTERVAL_US) trace_need_key = true;
+    if (trace_need_key) {
+        memset(trace_prev, 0, sizeof(trace_prev));
+        return 0;
+    }
+    return t - trace_last_t;
+}
+
+void RAM_HOT_FUNC(trace_sample)(trace_channel_t ch, int32_t a0, int32_t a1, int32_t a2) {
+    const int32_t v[TRACE_MAX_VALUES] = {a0, a1, a2};
+    uint8_t rec[1 + 5 + 5 * TRACE_MAX_VALUES];
+    int32_t saved[TRACE_MAX_VALUES];
+
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t t = time_us_32();
+    bool keyed = trace_need_key;
+    memcpy(saved, trace_prev[ch], sizeof(saved));
+    uint32_t n = 0;
+    rec[n++] = (uint8_t)ch;
+    n += trace_put_varint(&rec[n], trace_begin(t));
+    for (uint32_t i = 0; i < trace_nvalues[ch]; i++) {
+        n += trace_put_varint(&rec[n], trace_zigzag((int32_t)((uint32_t)v[i] - (uint32_t)trace_prev[ch][i])));
+        trace_prev[ch][i] = v[i];
+    }
+    uint32_t dropped = trace_stats.dropped;
+    trace_commit(rec, n, t);
+    // Registro perdido: o preditor volta ao último valor gravado (a próxima
+    // chave zera tudo de qualquer forma)
+    if (trace_stats.dropped != dropped && !keyed) memcpy(trace_prev[ch], saved, sizeof(saved));
+    restore_interrupts(irq);
+}
+
+void trace_bytes(trace_channel_t ch, const void *data, uint32_t len) {
+    uint8_t rec[TRACE_RECORD_MAX];
+    if (len > TRACE_BYTES_MAX) len = TRACE_BYTES_MAX;
+
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t t = time_us_32();
+    uint32_t n = 0;
+    rec[n++] = (uint8_t)ch;
+    n += trace_put_varint(&rec[n], trace_begin(t));
+    n += trace_put_varint(&rec[n], len);
+    memcpy(&rec[n], data, len);
+    trace_commit(rec, n + len, t);
+    restore_interrupts(irq);
+}
+
+uint32_t trace_drain(const trace_sink_t *sink, uint32_t max_bytes) {
+    uint32_t sent = 0;
+    uint32_t head = trace_head;
+    while (trace_tail != head && (max_bytes == 0 || sent < max_bytes)) {
+        uint32_t pos = trace_tail & (TRACE_RING_SIZE - 1);
+        uint32_t len = head - trace_tail;
+        if (len > TRACE_RING_SIZE - pos) len = TRACE_RING_SIZE - pos;
+        if (max_bytes && len > max_bytes - sent) len = max_bytes - sent;
+        uint32_t accepted = sink->write(sink->ctx, &trace_ring[pos], len);
+        trace_tail = trace_tail + accepted;
+        sent += accepted;
+        if (accepted < len) break; // Destino cheio
+    }
+    return sent;
+}
+
+void trace_get_stats(trace_stats_t *stats) {
+    uint32_t irq = save_and_disable_interrupts();
+    *stats = trace_stats;
+    restore_interrupts(irq);
+}
+
+void trace_force_key(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    trace_need_key = true;
+    restore_interrupts(irq);
+}
+
+bool trace_seal(void) {
+    uint8_t key[TRACE_KEY_MAX];
+    uint32_t irq = save_and_disable_interrupts();
+    uint32_t t = time_us_32();
+    uint32_t key_len = trace_encode_key(key, t);
+    bool ok = key_len <= TRACE_RING_SIZE - (trace_head - trace_tail);
+    if (ok) {
+        trace_ring_put(key, key_len);
+        memset(trace_prev, 0, sizeof(trace_prev));
+        trace_need_key = false;
+        trace_dropped_since_key = 0;
+        trace_key_t = t;
+        trace_last_t = t;
+        trace_block_crc = crc16_ccitt_update(CRC16_CCITT_INIT, key, key_len);
+        trace_stats.records++;
+        trace_stats.bytes += key_len;
+    } else {
+        trace_need_key = true;
+    }
+    restore_interrupts(irq);
+    return ok;
+}
+
+// =====================
+// Destinos
+// =====================
+
+static uint32_t trace_usb_write(void *ctx, const uint8_t *data, uint32_t len) {
+    (void)ctx;
+    uint32_t sent = 0;
+    while (sent < len) {
+        uint32_t n = len - sent > 255 ? 255 : len - sent;
+        putchar_raw(TRACE_SYNC0);
+        putchar_raw(TRACE_SYNC1);
+        putchar_raw((int)n);
+        for (uint32_t i = 0; i < n; i++) putchar_raw(data[sent + i]);
+        sent += n;
+    }
+    return sent;
+}
+
+const trace_sink_t trace_sink_usb = {trace_usb_write, NULL};
+
+static uint32_t trace_ram_write(void *ctx, const uint8_t *data, uint32_t len) {
+    trace_ram_t *ram = ctx;
+    uint32_t n = ram->size - ram->used;
+    if (n > len) n = len;
+    memcpy(&ram->buf[ram->used], data, n);
+    ram->used += n;
+    return n;
+}
+
+void trace_sink_ram(trace_sink_t *sink, trace_ram_t *ram, uint8_t *buf, uint32_t size) {
+    ram->buf = buf;
+    ram->size = size;
+    ram->used = 0;
+    sink->write = trace_ram_write;
+    sink->ctx = ram;
+}
+
+// =====================
+// Leitura
+// =====================
+
+void trace_reader_init(trace_reader_t *r, const void *data, size_t len) {
+    memset(r, 0, sizeof(*r));
+    r->p = data;
+    r->end = r->p + len;
+}
+
+static bool trace_get_varint(trace_reader_t *r, uint32_t *out) {
+    uint32_t v = 0;
+    for (uint32_t shift = 0; shift < 35 && r->p < r->end; shift += 7) {
+        uint8_t b = *r->p++;
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool trace_is_key_at(const trace_reader_t *r, const uint8_t *p) {
+    return r->end - p >= TRACE_KEY_MIN && memcmp(p, trace_key_magic, sizeof(trace_key_magic)) == 0;
+}
+
+// Pula um registro comum sem decodificá-lo. NULL se ele é inválido ou
+// cortado pelo fim do fluxo.
+static const uint8_t *trace_skip_record(const trace_reader_t *r, const uint8_t *p) {
+    trace_reader_t s = {.p = p, .end = r->end};
+    uint8_t ch = *s.p++;
+    uint32_t v;
+    if (ch >= TRACE_CH_COUNT || !trace_get_varint(&s, &v)) return NULL;
+    if (trace_nvalues[ch] == 0) {
+        if (!trace_get_varint(&s, &v) || v > TRACE_BYTES_MAX || v > (uint32_t)(s.end - s.p)) return NULL;
+        return s.p + v;
+    }
+    for (uint32_t i = 0; i < trace_nvalues[ch]; i++)
+        if (!trace_get_varint(&s, &v)) return NULL;
+    return s.p;
+}
+
+// Confere o bloco que começa na chave em 'key': percorre os registros até a
+// chave seguinte (depois de um eventual 0xFF de página completada), cujo
+// CRC fecha o bloco. Sem chave seguinte no fluxo, o bloco é o último da
+// gravação e é entregue sem conferência (r->block_end fica NULL). Um
+// registro inválido com uma chave mais à frente é corrupção: não confere.
+static bool trace_check_block(trace_reader_t *r, const uint8_t *key) {
+    trace_reader_t s = {.p = key + 8 + 2, .end = r->end};
+    uint32_t dropped;
+    r->block_end = NULL;
+    if (!trace_get_varint(&s, &dropped)) return true; // Chave cortada: trace_next para nela
+    const uint8_t *p = s.p;
+    while (p && p < r->end && *p != 0xFF && !trace_is_key_at(r, p)) p = trace_skip_record(r, p);
+
+    const uint8_t *block_end = p;
+    if (!p) {
+        for (p = s.p; p < r->end && !trace_is_key_at(r, p); p++) {
+        }
+        return p == r->end;
+    }
+    while (p < r->end && *p == 0xFF) p++;
+    if (p == r->end) return true;
+    if (!trace_is_key_at(r, p)) return false; // Lixo depois do 0xFF
+    uint16_t crc = (uint16_t)(p[8] | (p[9] << 8));
+    r->block_end = block_end;
+    return crc16_ccitt_update(CRC16_CCITT_INIT, key, (size_t)(block_end - key)) == crc;
+}
+
+bool trace_next(trace_reader_t *r, trace_event_t *ev) {
+    while (r->p < r->end) {
+        if (trace_is_key_at(r, r->p)) {
+            const uint8_t *key = r->p;
+            if (!trace_check_block(r, key)) {
+                // Bloco que não confere: descartado inteiro. A busca recomeça
+                // logo depois da marca, e não no fim calculado, que pode ter
+                // passado por cima da chave seguinte num registro corrompido
+                r->crc_errors++;
+                r->synced = false;
+                r->block_end = NULL;
+                r->p = key + 1;
+                continue;
+            }
+            const uint8_t *k = key + sizeof(trace_key_magic);
+            r->p = key + 8 + 2;
+            uint32_t dropped;
+            if (!trace_get_varint(r, &dropped)) return false;
+            r->t_us = k[0] | (k[1] << 8) | (k[2] << 16) | ((uint32_t)k[3] << 24);
+            r->dropped += dropped;
+            memset(r->prev, 0, sizeof(r->prev));
+            r->synced = true;
+            continue;
+        }
+        if (!r->synced || *r->p == 0xFF) {
+            // Procura a próxima chave (0xFF: fim de página completado na flash)
+            r->synced = false;
+            r->p++;
+            continue;
+        }
+
+        const uint8_t *start = r->p;
+        uint8_t ch = *r->p++;
+        uint32_t dt, len;
+        if (ch >= TRACE_CH_COUNT || !trace_get_varint(r, &dt)) goto invalid;
+        ev->ch = (trace_channel_t)ch;
+        ev->t_us = r->t_us + dt;
+        memset(ev->v, 0, sizeof(ev->v));
+        ev->data = NULL;
+        ev->len = 0;
+        if (trace_nvalues[ch] == 0) {
+            if (!trace_get_varint(r, &len) || len > TRACE_BYTES_MAX || len > (uint32_t)(r->end - r->p))
+                goto invalid;
+            ev->data = r->p;
+            ev->len = len;
+            r->p += len;
+        } else {
+            for (uint32_t i = 0; i < trace_nvalues[ch]; i++) {
+                uint32_t z;
+                if (!trace_get_varint(r, &z)) goto invalid;
+                ev->v[i] = (int32_t)((uint32_t)r->prev[ch][i] + (uint32_t)trace_unzigzag(z));
+            }
+            memcpy(r->prev[ch], ev->v, sizeof(ev->v));
+        }
+        r->t_us = ev->t_us;
+        if (!r->block_end) r->unverified++;
+        return true;
+
+    invalid:
+        // Fluxo cortado ou corrompido: descarta até a próxima chave
+        r->errors++;
+        r->synced = false;
+        r->p = start + 1;
+    }
+    return false;
+}
@@ -0,0 +1,44 @@
+#include "trace_flash.h"
+#include <string.h>
+
+static bool trace_flash_program(trace_flash_t *f) {
+    if (f->offset % TRACK_SECTOR_SIZE == 0 && !f->flash->erase(f->offset)) return false;
+    if (!f->flash->program(f->offset, f->page)) return false;
+    f->offset += TRACK_PAGE_SIZE;
+    f->fill = 0;
+    return true;
+}
+
+static uint32_t trace_flash_write(void *ctx, const uint8_t *data, uint32_t len) {
+    trace_flash_t *f = ctx;
+    uint32_t done = 0;
+    while (done < len && f->offset < f->flash->size) {
+        uint32_t n = TRACK_PAGE_SIZE - f->fill;
+        if (n > len - done) n = len - done;
+        memcpy(&f->page[f->fill], data + done, n);
+        f->fill += n;
+        done += n;
+        if (f->fill == TRACK_PAGE_SIZE && !trace_flash_program(f)) {
+            // Falha da flash: os bytes da página são perdidos
+            f->fill = 0;
+            trace_force_key();
+            break;
+        }
+    }
+    return done;
+}
+
+void trace_sink_flash(trace_sink_t *sink, trace_flash_t *f, const track_flash_t *flash) {
+    f->flash = flash;
+    f->offset = 0;
+    f->fill = 0;
+    sink->write = trace_flash_write;
+    sink->ctx = f;
+}
+
+bool trace_flash_flush(trace_flash_t *f) {
+    if (f->fill == 0 || f->offset >= f->flash->size) return true;
+    memset(&f->page[f->fill], 0xFF, TRACK_PAGE_SIZE - f->fill);
+    trace_force_key();
+    return trace_flash_program(f);
+}
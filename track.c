@@ -0,0 +1,215 @@
+#include "track.h"
+#include "crc.h"
+#include <string.h>
+
+#define TRACK_MAGIC 0x4B435254u // "TRCK"
+#define TRACK_NO_PAGE 0xFFFFFFFFu
+#define TRACK_MOUNT_ATTEMPTS 4  // Páginas cortadas toleradas no topo do log
+
+// O CRC cobre o cabeçalho até o campo crc e os registros usados.
+static uint32_t track_page_crc(const track_page_t *page) {
+    uint32_t count = page->header.count;
+    if (count > TRACK_RECORDS_PER_PAGE) count = TRACK_RECORDS_PER_PAGE;
+    uint32_t crc = crc32_update(CRC32_INIT, &page->header, offsetof(track_page_header_t, crc));
+    crc = crc32_update(crc, page->records, count * sizeof(track_record_t));
+    return ~crc;
+}
+
+static bool track_header_plausible(const track_page_header_t *h) {
+    return h->magic == TRACK_MAGIC && h->count > 0 && h->count <= TRACK_RECORDS_PER_PAGE &&
+           h->t_first <= h->t_last;
+}
+
+static void track_read_header(const track_t *t, uint32_t page, track_page_header_t *h) {
+    t->flash->read(page * TRACK_PAGE_SIZE, h, sizeof(*h));
+}
+
+static bool track_read_page(const track_t *t, uint32_t page, track_page_t *out) {
+    t->flash->read(page * TRACK_PAGE_SIZE, out, sizeof(*out));
+    return track_header_plausible(&out->header) && track_page_crc(out) == out->header.crc;
+}
+
+static bool track_page_blank(const track_t *t, uint32_t page) {
+    uint32_t words[TRACK_PAGE_SIZE / 4];
+    t->flash->read(page * TRACK_PAGE_SIZE, words, sizeof(words));
+    for (uint32_t i = 0; i < TRACK_PAGE_SIZE / 4; i++) {
+        if (words[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+static void track_reset_pending(track_t *t) {
+    memset(&t->pending, 0xFF, sizeof(t->pending));
+    t->pending.header.count = 0;
+}
+
+bool track_mount(track_t *t, const track_flash_t *flash, uint32_t uptime_ms) {
+    memset(t, 0, sizeof(*t));
+    t->flash = flash;
+    t->page_count = flash->size / TRACK_PAGE_SIZE;
+    if (t->page_count < 2 * TRACK_PAGES_PER_SECTOR) return false;
+
+    // Procura a página de maior sequência com CRC válido. Uma página com
+    // cabeçalho aparentemente válido mas CRC errado (gravação interrompida)
+    // é descartada e a busca recomeça abaixo da sequência dela.
+    uint32_t best = TRACK_NO_PAGE;
+    uint32_t seq_limit = 0xFFFFFFFFu;
+    uint32_t max_seq = 0; // Maior sequência vista, inclusive em páginas cortadas
+    for (int attempt = 0; attempt < TRACK_MOUNT_ATTEMPTS && best == TRACK_NO_PAGE; attempt++) {
+        uint32_t candidate = TRACK_NO_PAGE;
+        uint32_t candidate_seq = 0;
+        for (uint32_t p = 0; p < t->page_count; p++) {
+            track_page_header_t h;
+            track_read_header(t, p, &h);
+            if (!track_header_plausible(&h)) continue;
+            if (h.seq > max_seq) max_seq = h.seq;
+            if (h.seq >= seq_limit) continue;
+            if (candidate == TRACK_NO_PAGE || h.seq > candidate_seq) {
+                candidate = p;
+                candidate_seq = h.seq;
+            }
+        }
+        if (candidate == TRACK_NO_PAGE) break;
+
+        if (track_read_page(t, candidate, &t->pending)) {
+            best = candidate;
+        } else {
+            seq_limit = candidate_seq;
+        }
+    }
+
+    // A sequência continua acima de qualquer página já gravada, para que uma
+    // página cortada nunca empate com uma válida numa montagem futura.
+    t->next_seq = max_seq + 1;
+    if (best == TRACK_NO_PAGE) {
+        // Log vazio (ou irrecuperável): começa do início da região
+        t->write_page = 0;
+        t->last_t = 0;
+    } else {
+        t->write_page = (best + 1) % t->page_count;
+        t->last_t = t->pending.header.t_last;
+    }
+    t->time_base = t->last_t + 1 - uptime_ms;
+
+    // Páginas já sujas no meio do setor (gravação cortada) não podem ser
+    // regravadas sem apagar o setor: pula até uma página limpa ou até o
+    // próximo setor, que será apagado na próxima gravação.
+    while (t->write_page % TRACK_PAGES_PER_SECTOR != 0 && !track_page_blank(t, t->write_page)) {
+        t->write_page = (t->write_page + 1) % t->page_count;
+    }
+
+    track_reset_pending(t);
+    return true;
+}
+
+bool track_flush(track_t *t) {
+    track_page_t *page = &t->pending;
+    if (page->header.count == 0) return true;
+
+    page->header.magic = TRACK_MAGIC;
+    page->header.seq = t->next_seq;
+    page->header.t_first = page->records[0].t_ms;
+    page->header.t_last = page->records[page->header.count - 1].t_ms;
+    page->header.reserved = 0xFFFF;
+    page->header.crc = track_page_crc(page);
+
+    uint32_t offset = t->write_page * TRACK_PAGE_SIZE;
+    bool ok = true;
+    if (t->write_page % TRACK_PAGES_PER_SECTOR == 0) {
+        // Entrando num setor novo: apaga o mais antigo (rodízio entre setores)
+        ok = t->flash->erase(offset);
+        t->sectors_erased++;
+    }
+    if (ok) ok = t->flash->program(offset, page);
+
+    // Avança mesmo em caso de falha: a página pode ter ficado parcialmente gravada
+    t->next_seq++;
+    t->write_page = (t->write_page + 1) % t->page_count;
+    t->pages_written++;
+    track_reset_pending(t);
+    return ok;
+}
+
+bool track_append(track_t *t, uint32_t uptime_ms, int16_t x, int16_t y, uint8_t flags) {
+    uint32_t now = track_time(t, uptime_ms);
+    if (now < t->last_t) now = t->last_t; // Mantém o tempo de log monotônico
+
+    track_record_t *r = &t->pending.records[t->pending.header.count++];
+    r->t_ms = now;
+    r->x = x;
+    r->y = y;
+    r->flags = flags;
+    memset(r->reserved, 0xFF, sizeof(r->reserved));
+    t->last_t = now;
+
+    if (t->pending.header.count == TRACK_RECORDS_PER_PAGE) return track_flush(t);
+    return true;
+}
+
+// ---------- Leitura por intervalo de tempo ----------
+// Ordem lógica do log: começa no setor seguinte ao setor em gravação (o mais
+// antigo) e termina na página anterior a write_page. Se write_page está no
+// início de um setor, esse setor ainda guarda os dados mais antigos.
+static uint32_t track_logical_start(const track_t *t, uint32_t *length) {
+    uint32_t start;
+    if (t->write_page % TRACK_PAGES_PER_SECTOR == 0) {
+        start = t->write_page;
+        *length = t->page_count;
+    } else {
+        start = (t->write_page / TRACK_PAGES_PER_SECTOR + 1) * TRACK_PAGES_PER_SECTOR % t->page_count;
+        *length = (t->write_page + t->page_count - start) % t->page_count;
+    }
+    return start;
+}
+
+static bool track_logical_header(const track_t *t, uint32_t start, uint32_t i, track_page_header_t *h) {
+    track_read_header(t, (start + i) % t->page_count, h);
+    return track_header_plausible(h) && h->seq < t->next_seq;
+}
+
+uint32_t track_query(track_t *t, uint32_t t_from, uint32_t t_to, track_visit_t cb, void *ctx) {
+    uint32_t length;
+    uint32_t start = track_logical_start(t, &length);
+    uint32_t delivered = 0;
+    track_page_header_t h;
+
+    // Busca binária pela primeira página com t_last >= t_from. Páginas
+    // inválidas (limpas ou cortadas) são puladas à frente do ponto médio.
+    uint32_t lo = 0, hi = length;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t j = mid;
+        while (j < hi && !track_logical_header(t, start, j, &h)) j++;
+        if (j == hi) {
+            hi = mid;
+        } else if (h.t_last < t_from) {
+            lo = j + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    track_page_t page;
+    for (uint32_t i = lo; i < length; i++) {
+        if (!track_logical_header(t, start, i, &h)) continue;
+        if (h.t_first > t_to) return delivered;
+        if (!track_read_page(t, (start + i) % t->page_count, &page)) continue;
+        for (uint32_t r = 0; r < page.header.count; r++) {
+            const track_record_t *rec = &page.records[r];
+            if (rec->t_ms < t_from) continue;
+            if (rec->t_ms > t_to) return delivered;
+            delivered++;
+            if (!cb(rec, ctx)) return delivered;
+        }
+    }
+
+    // Pontos ainda na página em RAM
+    for (uint32_t r = 0; r < t->pending.header.count; r++) {
+        const track_record_t *rec = &t->pending.records[r];
+        if (rec->t_ms < t_from) continue;
+        if (rec->t_ms > t_to) break;
+        delivered++;
+        if (!cb(rec, ctx)) break;
+    }
+    return delivered;
+}
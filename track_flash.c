@@ -0,0 +1,101 @@
+#include "track.h"
+#include "trace_flash.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/regs/addressmap.h"
+
+// Região reservada para o trajeto: últimos TRACK_REGION_SIZE bytes da flash.
+// O programa (finalv3.uf2) ocupa o início da flash e fica bem longe dela.
+#ifndef TRACK_REGION_SIZE
+#define TRACK_REGION_SIZE (64 * TRACK_SECTOR_SIZE) // 256 KB
+#endif
+#define TRACK_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - TRACK_REGION_SIZE)
+
+#if TRACE_FLASH
+// Gravação de entradas (trace_flash.h): logo abaixo da região do trajeto
+#ifndef TRACE_REGION_SIZE
+#define TRACE_REGION_SIZE (32 * TRACK_SECTOR_SIZE) // 128 KB
+#endif
+#define TRACE_FLASH_OFFSET (TRACK_FLASH_OFFSET - TRACE_REGION_SIZE)
+#endif
+
+typedef struct {
+    uint32_t offset; // Absoluto na flash
+    const void *data;
+} track_flash_op_t;
+
+// Executadas com o XIP desligado (flash_safe_execute): o buffer da página
+// está em RAM (track_t.pending).
+static void track_do_program(void *param) {
+    const track_flash_op_t *op = param;
+    flash_range_program(op->offset, op->data, TRACK_PAGE_SIZE);
+}
+
+static void track_do_erase(void *param) {
+    const track_flash_op_t *op = param;
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+}
+
+static void flash_read_at(uint32_t offset, void *dst, size_t len) {
+    memcpy(dst, (const void *)(uintptr_t)(XIP_BASE + offset), len);
+}
+
+static bool flash_program_at(uint32_t offset, const void *page) {
+    track_flash_op_t op = { offset, page };
+    return flash_safe_execute(track_do_program, &op, UINT32_MAX) == PICO_OK;
+}
+
+static bool flash_erase_at(uint32_t offset) {
+    track_flash_op_t op = { offset, NULL };
+    return flash_safe_execute(track_do_erase, &op, UINT32_MAX) == PICO_OK;
+}
+
+static void track_pico_read(uint32_t offset, void *dst, size_t len) {
+    flash_read_at(TRACK_FLASH_OFFSET + offset, dst, len);
+}
+
+static bool track_pico_program(uint32_t offset, const void *page) {
+    return flash_program_at(TRACK_FLASH_OFFSET + offset, page);
+}
+
+static bool track_pico_erase(uint32_t offset) {
+    return flash_erase_at(TRACK_FLASH_OFFSET + offset);
+}
+
+static const track_flash_t track_pico = {
+    .size = TRACK_REGION_SIZE,
+    .read = track_pico_read,
+    .program = track_pico_program,
+    .erase = track_pico_erase,
+};
+
+const track_flash_t *track_flash_pico(void) {
+    return &track_pico;
+}
+
+#if TRACE_FLASH
+static void trace_pico_read(uint32_t offset, void *dst, size_t len) {
+    flash_read_at(TRACE_FLASH_OFFSET + offset, dst, len);
+}
+
+static bool trace_pico_program(uint32_t offset, const void *page) {
+    return flash_program_at(TRACE_FLASH_OFFSET + offset, page);
+}
+
+static bool trace_pico_erase(uint32_t offset) {
+    return flash_erase_at(TRACE_FLASH_OFFSET + offset);
+}
+
+static const track_flash_t trace_pico = {
+    .size = TRACE_REGION_SIZE,
+    .read = trace_pico_read,
+    .program = trace_pico_program,
+    .erase = trace_pico_erase,
+};
+
+const track_flash_t *trace_flash_pico(void) {
+    return &trace_pico;
+}
+#endif // TRACE_FLASH
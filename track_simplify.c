@@ -0,0 +1,77 @@
+#include "track_simplify.h"
+#include <string.h>
+
+void track_simplify_init(track_simplify_t *s, uint16_t tolerance, uint8_t window) {
+    memset(s, 0, sizeof(*s));
+    s->tolerance = tolerance;
+    if (window < 1) window = 1;
+    if (window > TRACK_SIMPLIFY_WINDOW_MAX) window = TRACK_SIMPLIFY_WINDOW_MAX;
+    s->window = window;
+}
+
+// true se 'p' está a no máximo 'tol' do segmento a -> b, em inteiros de 64
+// bits (o M0+ não tem FPU).
+static bool track_simplify_within(const track_record_t *a, const track_record_t *b, const track_record_t *p,
+                                  uint32_t tol) {
+    int32_t dx = b->x - a->x, dy = b->y - a->y;
+    int32_t vx = p->x - a->x, vy = p->y - a->y;
+    int64_t tol2 = (int64_t)tol * tol;
+    int64_t len2 = (int64_t)dx * dx + (int64_t)dy * dy;
+    int64_t dot = (int64_t)vx * dx + (int64_t)vy * dy;
+    if (len2 == 0 || dot <= 0) return (int64_t)vx * vx + (int64_t)vy * vy <= tol2; // Antes de 'a'
+    if (dot >= len2) {
+        int32_t wx = p->x - b->x, wy = p->y - b->y;
+        return (int64_t)wx * wx + (int64_t)wy * wy <= tol2; // Depois de 'b'
+    }
+    // Distância à reta ao quadrado = cross^2 / len2
+    int64_t cross = (int64_t)vx * dy - (int64_t)vy * dx;
+    uint64_t c = (uint64_t)(cross < 0 ? -cross : cross);
+    if ((c >> 31) || ((uint64_t)len2 >> 31)) // Só com coordenadas bem fora de 0..4095
+        return (double)c * (double)c <= (double)tol2 * (double)len2;
+    return c * c <= (uint64_t)tol2 * (uint64_t)len2;
+}
+
+// Mantém o último pendente: ele vira a âncora
+static uint32_t track_simplify_keep_pending(track_simplify_t *s, track_record_t *out) {
+    if (s->count == 0) return 0;
+    s->anchor = s->pending[s->count - 1];
+    s->count = 0;
+    *out = s->anchor;
+    s->points_out++;
+    return 1;
+}
+
+uint32_t track_simplify_push(track_simplify_t *s, uint32_t t_ms, int16_t x, int16_t y, uint8_t flags,
+                             track_record_t out[TRACK_SIMPLIFY_MAX_OUT]) {
+    track_record_t p;
+    memset(&p, 0xFF, sizeof(p));
+    p.t_ms = t_ms;
+    p.x = x;
+    p.y = y;
+    p.flags = flags;
+    s->points_in++;
+
+    uint32_t n = 0;
+    bool forced = flags != 0 || flags != s->last_flags;
+    s->last_flags = flags;
+    if (!s->has_anchor || forced) {
+        // Primeiro ponto, alerta ou mudança de flags: mantém o pendente e este
+        n += track_simplify_keep_pending(s, &out[n]);
+        s->anchor = p;
+        s->has_anchor = true;
+        out[n++] = p;
+        s->points_out++;
+        return n;
+    }
+
+    bool fits = s->count < s->window;
+    for (uint32_t i = 0; fits && i < s->count; i++)
+        fits = track_simplify_within(&s->anchor, &p, &s->pending[i], s->tolerance);
+    if (!fits) n += track_simplify_keep_pending(s, &out[n]);
+    s->pending[s->count++] = p;
+    return n;
+}
+
+uint32_t track_simplify_flush(track_simplify_t *s, track_record_t out[1]) {
+    return track_simplify_keep_pending(s, out);
+}